@@ -8,6 +8,7 @@
 #include <string>
 #include <memory>
 #include <cstring>
+#include <algorithm>
 
 #include "util.hpp"
 #include "keyboard_input.hpp"
@@ -27,6 +28,11 @@
 #include "fake_swapchain.hpp"
 #include "renderpass.hpp"
 #include "format.hpp"
+#include "texture_cache.hpp"
+#include "object_cache.hpp"
+#include "descriptor_heap.hpp"
+#include "depth_tracker.hpp"
+#include "damage.hpp"
 #include "logger.hpp"
 
 #include "effect.hpp"
@@ -38,6 +44,13 @@
 #include "effect_lut.hpp"
 #include "effect_reshade.hpp"
 #include "effect_transfer.hpp"
+#include "effect_border.hpp"
+#include "effect_copy.hpp"
+#include "effect_upscale.hpp"
+#include "effect_scaled.hpp"
+#include "letterbox.hpp"
+#include "frame_compare.hpp"
+#include "shading_rate.hpp"
 
 #define VKBASALT_NAME "VK_LAYER_VKBASALT_post_processing"
 
@@ -145,6 +158,180 @@ namespace vkBasalt
         instanceMap.erase(GetKey(instance));
     }
 
+    // returns the struct of type sType in the pNext chain or nullptr
+    static const VkBaseInStructure* findInChain(const void* pNext, VkStructureType sType)
+    {
+        const VkBaseInStructure* pStruct = static_cast<const VkBaseInStructure*>(pNext);
+        while (pStruct && pStruct->sType != sType)
+        {
+            pStruct = pStruct->pNext;
+        }
+        return pStruct;
+    }
+
+    // puts the feature struct into the chain of the device create info
+    // if the application already has one of the same type in the chain, that one decides if the features get enabled
+    template<typename Features, typename... Enabled>
+    static bool chainFeatures(VkDeviceCreateInfo& createInfo, Features& features, Enabled... enabled)
+    {
+        auto pAppFeatures = reinterpret_cast<const Features*>(findInChain(createInfo.pNext, features.sType));
+        if (pAppFeatures)
+        {
+            return ((pAppFeatures->*enabled) && ...);
+        }
+        features.pNext   = const_cast<void*>(createInfo.pNext);
+        createInfo.pNext = &features;
+        return true;
+    }
+
+    // the size of the structs that can come before the one the layer changes in the pNext chain of the device create info,
+    // 0 for unknown structs
+    static size_t getDeviceCreateInfoStructSize(VkStructureType sType)
+    {
+        switch (sType)
+        {
+            case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2: return sizeof(VkPhysicalDeviceFeatures2);
+            case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES: return sizeof(VkPhysicalDeviceVulkan11Features);
+            case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES: return sizeof(VkPhysicalDeviceVulkan12Features);
+            case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES: return sizeof(VkPhysicalDeviceVulkan13Features);
+            case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT:
+                return sizeof(VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT);
+            case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR: return sizeof(VkPhysicalDeviceDynamicRenderingFeaturesKHR);
+            case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES: return sizeof(VkPhysicalDeviceDescriptorIndexingFeatures);
+            case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_CONDITIONAL_RENDERING_FEATURES_EXT:
+                return sizeof(VkPhysicalDeviceConditionalRenderingFeaturesEXT);
+            case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_SHADING_RATE_FEATURES_KHR:
+                return sizeof(VkPhysicalDeviceFragmentShadingRateFeaturesKHR);
+            case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_16BIT_STORAGE_FEATURES: return sizeof(VkPhysicalDevice16BitStorageFeatures);
+            case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_8BIT_STORAGE_FEATURES: return sizeof(VkPhysicalDevice8BitStorageFeatures);
+            case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_FLOAT16_INT8_FEATURES: return sizeof(VkPhysicalDeviceShaderFloat16Int8Features);
+            case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_FEATURES: return sizeof(VkPhysicalDeviceMultiviewFeatures);
+            case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES: return sizeof(VkPhysicalDeviceTimelineSemaphoreFeatures);
+            case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES: return sizeof(VkPhysicalDeviceBufferDeviceAddressFeatures);
+            case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SCALAR_BLOCK_LAYOUT_FEATURES: return sizeof(VkPhysicalDeviceScalarBlockLayoutFeatures);
+            case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_QUERY_RESET_FEATURES: return sizeof(VkPhysicalDeviceHostQueryResetFeatures);
+            case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ROBUSTNESS_2_FEATURES_EXT: return sizeof(VkPhysicalDeviceRobustness2FeaturesEXT);
+            case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TRANSFORM_FEEDBACK_FEATURES_EXT: return sizeof(VkPhysicalDeviceTransformFeedbackFeaturesEXT);
+            case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DEPTH_CLIP_ENABLE_FEATURES_EXT: return sizeof(VkPhysicalDeviceDepthClipEnableFeaturesEXT);
+            case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_CUSTOM_BORDER_COLOR_FEATURES_EXT: return sizeof(VkPhysicalDeviceCustomBorderColorFeaturesEXT);
+            case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VERTEX_ATTRIBUTE_DIVISOR_FEATURES_EXT:
+                return sizeof(VkPhysicalDeviceVertexAttributeDivisorFeaturesEXT);
+            case VK_STRUCTURE_TYPE_DEVICE_GROUP_DEVICE_CREATE_INFO: return sizeof(VkDeviceGroupDeviceCreateInfo);
+            default: return 0;
+        }
+    }
+
+    // the size of the structs that can come before the present regions in the pNext chain of the present info, 0 for unknown structs
+    static size_t getPresentInfoStructSize(VkStructureType sType)
+    {
+        switch (sType)
+        {
+            case VK_STRUCTURE_TYPE_DISPLAY_PRESENT_INFO_KHR: return sizeof(VkDisplayPresentInfoKHR);
+            case VK_STRUCTURE_TYPE_DEVICE_GROUP_PRESENT_INFO_KHR: return sizeof(VkDeviceGroupPresentInfoKHR);
+            case VK_STRUCTURE_TYPE_PRESENT_TIMES_INFO_GOOGLE: return sizeof(VkPresentTimesInfoGOOGLE);
+            case VK_STRUCTURE_TYPE_PRESENT_REGIONS_KHR: return sizeof(VkPresentRegionsKHR);
+            default: return 0;
+        }
+    }
+
+    // copies the pNext chain up to the struct of type sType into storage of the layer and lets pNext point to the copy,
+    // so that the copy of that struct can be changed without writing into the structs of the application,
+    // returns the copy or nullptr if a struct before it has an unknown size
+    static VkBaseOutStructure* copyChainUntil(const void*&                       pNext,
+                                              VkStructureType                    sType,
+                                              size_t                             (*getStructSize)(VkStructureType),
+                                              std::vector<std::vector<uint8_t>>& storage)
+    {
+        const VkBaseInStructure* pTarget = findInChain(pNext, sType);
+        if (!pTarget)
+        {
+            return nullptr;
+        }
+        for (auto pStruct = static_cast<const VkBaseInStructure*>(pNext); pStruct != pTarget->pNext; pStruct = pStruct->pNext)
+        {
+            if (!getStructSize(pStruct->sType))
+            {
+                return nullptr;
+            }
+        }
+
+        VkBaseOutStructure* pPreviousCopy = nullptr;
+        for (auto pStruct = static_cast<const VkBaseInStructure*>(pNext); pStruct != pTarget->pNext; pStruct = pStruct->pNext)
+        {
+            size_t size = getStructSize(pStruct->sType);
+            storage.emplace_back(size);
+            std::memcpy(storage.back().data(), pStruct, size);
+            auto pCopy = reinterpret_cast<VkBaseOutStructure*>(storage.back().data());
+            if (pPreviousCopy)
+            {
+                pPreviousCopy->pNext = pCopy;
+            }
+            else
+            {
+                pNext = pCopy;
+            }
+            pPreviousCopy = pCopy;
+        }
+        // the copy of the target still points to the rest of the chain of the application
+        return pPreviousCopy;
+    }
+
+    // the share of the swapchain size the application renders at, the rest gets upscaled
+    static float getRenderScale()
+    {
+        float renderScale = pConfig->getOption<float>("renderScale", 1.0f);
+        return (renderScale > 0.0f && renderScale < 1.0f) ? renderScale : 1.0f;
+    }
+
+    static VkExtent2D scaleExtent(VkExtent2D extent, float scale)
+    {
+        return {std::max(1u, (uint32_t) (extent.width * scale + 0.5f)), std::max(1u, (uint32_t) (extent.height * scale + 0.5f))};
+    }
+
+    // with a render scale the application has to see a smaller surface, so that it creates a smaller swapchain
+    static void scaleSurfaceCapabilities(VkSurfaceCapabilitiesKHR* pSurfaceCapabilities)
+    {
+        float renderScale = getRenderScale();
+        if (renderScale == 1.0f)
+        {
+            return;
+        }
+        // 0xFFFFFFFF means that the swapchain decides the size of the surface, there is no size to upscale to
+        if (pSurfaceCapabilities->currentExtent.width == 0xFFFFFFFF)
+        {
+            return;
+        }
+        pSurfaceCapabilities->currentExtent  = scaleExtent(pSurfaceCapabilities->currentExtent, renderScale);
+        pSurfaceCapabilities->minImageExtent = scaleExtent(pSurfaceCapabilities->minImageExtent, renderScale);
+        pSurfaceCapabilities->maxImageExtent = scaleExtent(pSurfaceCapabilities->maxImageExtent, renderScale);
+    }
+
+    VK_LAYER_EXPORT VkResult VKAPI_CALL vkBasalt_GetPhysicalDeviceSurfaceCapabilitiesKHR(VkPhysicalDevice          physicalDevice,
+                                                                                         VkSurfaceKHR              surface,
+                                                                                         VkSurfaceCapabilitiesKHR* pSurfaceCapabilities)
+    {
+        scoped_lock l(globalLock);
+        Logger::trace("vkGetPhysicalDeviceSurfaceCapabilitiesKHR");
+
+        VkResult result =
+            instanceDispatchMap[GetKey(physicalDevice)].GetPhysicalDeviceSurfaceCapabilitiesKHR(physicalDevice, surface, pSurfaceCapabilities);
+        scaleSurfaceCapabilities(pSurfaceCapabilities);
+        return result;
+    }
+
+    VK_LAYER_EXPORT VkResult VKAPI_CALL vkBasalt_GetPhysicalDeviceSurfaceCapabilities2KHR(VkPhysicalDevice                       physicalDevice,
+                                                                                          const VkPhysicalDeviceSurfaceInfo2KHR* pSurfaceInfo,
+                                                                                          VkSurfaceCapabilities2KHR* pSurfaceCapabilities)
+    {
+        scoped_lock l(globalLock);
+        Logger::trace("vkGetPhysicalDeviceSurfaceCapabilities2KHR");
+
+        VkResult result =
+            instanceDispatchMap[GetKey(physicalDevice)].GetPhysicalDeviceSurfaceCapabilities2KHR(physicalDevice, pSurfaceInfo, pSurfaceCapabilities);
+        scaleSurfaceCapabilities(&pSurfaceCapabilities->surfaceCapabilities);
+        return result;
+    }
+
     VK_LAYER_EXPORT VkResult VKAPI_CALL vkBasalt_CreateDevice(VkPhysicalDevice             physicalDevice,
                                                               const VkDeviceCreateInfo*    pCreateInfo,
                                                               const VkAllocationCallbacks* pAllocator,
@@ -192,8 +379,105 @@ namespace vkBasalt
             }
         }
 
+        auto hasExtension = [&extensionProperties](const char* name) {
+            return std::any_of(extensionProperties.begin(), extensionProperties.end(), [name](const VkExtensionProperties& properties) {
+                return properties.extensionName == std::string(name);
+            });
+        };
+
+        VkPhysicalDeviceFeatures2 features2 = {};
+        features2.sType                     = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+
+        // pipeline libraries let the effects share everything but their fragment stage
+        VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT pipelineLibraryFeatures = {};
+        pipelineLibraryFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+        if (hasExtension(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME) && hasExtension(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME))
+        {
+            pipelineLibraryFeatures.pNext = features2.pNext;
+            features2.pNext               = &pipelineLibraryFeatures;
+        }
+
+        // dynamic rendering saves the render pass and framebuffer objects
+        VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures = {};
+        dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+        if (hasExtension(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME))
+        {
+            dynamicRenderingFeatures.pNext = features2.pNext;
+            features2.pNext                = &dynamicRenderingFeatures;
+        }
+
+        // descriptor indexing lets the reshade effects share one array of image descriptors that the passes index
+        VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptorIndexingFeatures = {};
+        descriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+        if (hasExtension(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME) && hasExtension(VK_KHR_MAINTENANCE3_EXTENSION_NAME))
+        {
+            descriptorIndexingFeatures.pNext = features2.pNext;
+            features2.pNext                  = &descriptorIndexingFeatures;
+        }
+
+        // conditional rendering lets single effects be switched off without recording the command buffers again
+        VkPhysicalDeviceConditionalRenderingFeaturesEXT conditionalRenderingFeatures = {};
+        conditionalRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_CONDITIONAL_RENDERING_FEATURES_EXT;
+        if (hasExtension(VK_EXT_CONDITIONAL_RENDERING_EXTENSION_NAME))
+        {
+            conditionalRenderingFeatures.pNext = features2.pNext;
+            features2.pNext                    = &conditionalRenderingFeatures;
+        }
+
+        // shading rate images let the effects shade flat parts of the image at a coarser rate
+        VkPhysicalDeviceFragmentShadingRateFeaturesKHR shadingRateFeatures = {};
+        shadingRateFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_SHADING_RATE_FEATURES_KHR;
+        VkPhysicalDeviceFragmentShadingRatePropertiesKHR shadingRateProperties = {};
+        shadingRateProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_SHADING_RATE_PROPERTIES_KHR;
+        if (hasExtension(VK_KHR_FRAGMENT_SHADING_RATE_EXTENSION_NAME))
+        {
+            shadingRateFeatures.pNext = features2.pNext;
+            features2.pNext           = &shadingRateFeatures;
+
+            VkPhysicalDeviceProperties2 properties2 = {};
+            properties2.sType                       = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+            properties2.pNext                       = &shadingRateProperties;
+            instanceDispatchMap[GetKey(physicalDevice)].GetPhysicalDeviceProperties2(physicalDevice, &properties2);
+        }
+
+        if (features2.pNext)
+        {
+            instanceDispatchMap[GetKey(physicalDevice)].GetPhysicalDeviceFeatures2(physicalDevice, &features2);
+        }
+        bool supportsPipelineLibrary      = pipelineLibraryFeatures.graphicsPipelineLibrary;
+        bool supportsDynamicRendering     = dynamicRenderingFeatures.dynamicRendering;
+        bool supportsDescriptorIndexing   = features2.features.shaderSampledImageArrayDynamicIndexing
+                                            && descriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind
+                                            && descriptorIndexingFeatures.descriptorBindingUpdateUnusedWhilePending
+                                            && descriptorIndexingFeatures.descriptorBindingPartiallyBound;
+        bool supportsConditionalRendering = conditionalRenderingFeatures.conditionalRendering;
+
+        // the shading rate image gets written by a compute shader without a format in the shader,
+        // the pipelines take the minimum of their own rate and the one of the image
+        VkFormatProperties shadingRateFormatProperties;
+        instanceDispatchMap[GetKey(physicalDevice)].GetPhysicalDeviceFormatProperties(
+            physicalDevice, VK_FORMAT_R8_UINT, &shadingRateFormatProperties);
+        VkFormatFeatureFlags shadingRateFormatFeatures =
+            VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT | VK_FORMAT_FEATURE_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR;
+        bool supportsShadingRate = supportsDynamicRendering && shadingRateFeatures.pipelineFragmentShadingRate
+                                   && shadingRateFeatures.attachmentFragmentShadingRate
+                                   && shadingRateProperties.fragmentShadingRateNonTrivialCombinerOps
+                                   && features2.features.shaderStorageImageWriteWithoutFormat
+                                   && (shadingRateFormatProperties.optimalTilingFeatures & shadingRateFormatFeatures) == shadingRateFormatFeatures;
+
+        // the depth tracker only hooks the BindImageMemory2 functions that the application can call,
+        // the core one exists because the instance is at least 1.1, if the device is as well
+        VkPhysicalDeviceProperties physicalDeviceProperties;
+        instanceDispatchMap[GetKey(physicalDevice)].GetPhysicalDeviceProperties(physicalDevice, &physicalDeviceProperties);
+        bool supportsBindMemory2    = physicalDeviceProperties.apiVersion >= VK_API_VERSION_1_1;
+        bool supportsBindMemory2KHR = std::any_of(pCreateInfo->ppEnabledExtensionNames,
+                                                  pCreateInfo->ppEnabledExtensionNames + pCreateInfo->enabledExtensionCount,
+                                                  [](const char* name) { return name == std::string(VK_KHR_BIND_MEMORY_2_EXTENSION_NAME); });
+
         VkDeviceCreateInfo       modifiedCreateInfo = *pCreateInfo;
         std::vector<const char*> enabledExtensionNames;
+        // the structs of the application that the layer changes get copied into here
+        std::vector<std::vector<uint8_t>> chainStorage;
         if (modifiedCreateInfo.enabledExtensionCount)
         {
             enabledExtensionNames = std::vector<const char*>(modifiedCreateInfo.ppEnabledExtensionNames,
@@ -206,6 +490,120 @@ namespace vkBasalt
             addUniqueCString(enabledExtensionNames, "VK_KHR_swapchain_mutable_format");
         }
         addUniqueCString(enabledExtensionNames, "VK_KHR_image_format_list");
+
+        if (supportsPipelineLibrary)
+        {
+            Logger::debug("activating graphics_pipeline_library");
+            addUniqueCString(enabledExtensionNames, VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+            addUniqueCString(enabledExtensionNames, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+            supportsPipelineLibrary = chainFeatures(
+                modifiedCreateInfo, pipelineLibraryFeatures, &VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT::graphicsPipelineLibrary);
+        }
+
+        if (supportsDynamicRendering)
+        {
+            Logger::debug("activating dynamic_rendering");
+            // the extensions that dynamic rendering depends on, they are core since vulkan 1.2
+            for (const char* dependency :
+                 {"VK_KHR_multiview", "VK_KHR_maintenance2", "VK_KHR_create_renderpass2", "VK_KHR_depth_stencil_resolve"})
+            {
+                if (hasExtension(dependency))
+                {
+                    addUniqueCString(enabledExtensionNames, dependency);
+                }
+            }
+            addUniqueCString(enabledExtensionNames, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+            // the vulkan 1.3 features must not be chained together with the extension struct,
+            // dynamic rendering is required by vulkan 1.3, so it gets switched on in a copy of the struct of the application
+            auto pVulkan13Features = reinterpret_cast<const VkPhysicalDeviceVulkan13Features*>(
+                findInChain(modifiedCreateInfo.pNext, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES));
+            if (pVulkan13Features)
+            {
+                if (!pVulkan13Features->dynamicRendering)
+                {
+                    auto pVulkan13FeaturesCopy = reinterpret_cast<VkPhysicalDeviceVulkan13Features*>(
+                        copyChainUntil(modifiedCreateInfo.pNext,
+                                       VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
+                                       getDeviceCreateInfoStructSize,
+                                       chainStorage));
+                    if (pVulkan13FeaturesCopy)
+                    {
+                        pVulkan13FeaturesCopy->dynamicRendering = VK_TRUE;
+                    }
+                    else
+                    {
+                        Logger::err("unknown struct in the pNext chain of the device create info, not activating dynamic_rendering");
+                        supportsDynamicRendering = false;
+                    }
+                }
+            }
+            else
+            {
+                supportsDynamicRendering = chainFeatures(
+                    modifiedCreateInfo, dynamicRenderingFeatures, &VkPhysicalDeviceDynamicRenderingFeaturesKHR::dynamicRendering);
+            }
+        }
+
+        if (supportsDescriptorIndexing)
+        {
+            Logger::debug("activating descriptor_indexing");
+            addUniqueCString(enabledExtensionNames, VK_KHR_MAINTENANCE3_EXTENSION_NAME);
+            addUniqueCString(enabledExtensionNames, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+            // only the features the shared descriptor array needs
+            descriptorIndexingFeatures                                               = {descriptorIndexingFeatures.sType};
+            descriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+            descriptorIndexingFeatures.descriptorBindingUpdateUnusedWhilePending     = VK_TRUE;
+            descriptorIndexingFeatures.descriptorBindingPartiallyBound               = VK_TRUE;
+            // the vulkan 1.2 features must not be chained together with the extension struct
+            auto pVulkan12Features = reinterpret_cast<const VkPhysicalDeviceVulkan12Features*>(
+                findInChain(modifiedCreateInfo.pNext, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES));
+            if (pVulkan12Features)
+            {
+                supportsDescriptorIndexing = pVulkan12Features->descriptorBindingSampledImageUpdateAfterBind
+                                             && pVulkan12Features->descriptorBindingUpdateUnusedWhilePending
+                                             && pVulkan12Features->descriptorBindingPartiallyBound;
+            }
+            else
+            {
+                supportsDescriptorIndexing =
+                    chainFeatures(modifiedCreateInfo,
+                                  descriptorIndexingFeatures,
+                                  &VkPhysicalDeviceDescriptorIndexingFeaturesEXT::descriptorBindingSampledImageUpdateAfterBind,
+                                  &VkPhysicalDeviceDescriptorIndexingFeaturesEXT::descriptorBindingUpdateUnusedWhilePending,
+                                  &VkPhysicalDeviceDescriptorIndexingFeaturesEXT::descriptorBindingPartiallyBound);
+            }
+        }
+
+        if (supportsConditionalRendering)
+        {
+            Logger::debug("activating conditional_rendering");
+            addUniqueCString(enabledExtensionNames, VK_EXT_CONDITIONAL_RENDERING_EXTENSION_NAME);
+            // only the predicate of the primary command buffers is needed
+            conditionalRenderingFeatures                      = {conditionalRenderingFeatures.sType};
+            conditionalRenderingFeatures.conditionalRendering = VK_TRUE;
+
+            supportsConditionalRendering = chainFeatures(
+                modifiedCreateInfo, conditionalRenderingFeatures, &VkPhysicalDeviceConditionalRenderingFeaturesEXT::conditionalRendering);
+        }
+
+        if (supportsShadingRate && supportsDynamicRendering)
+        {
+            Logger::debug("activating fragment_shading_rate");
+            addUniqueCString(enabledExtensionNames, VK_KHR_FRAGMENT_SHADING_RATE_EXTENSION_NAME);
+            // only the rates of the pipelines and of the attachment are needed
+            shadingRateFeatures                               = {shadingRateFeatures.sType};
+            shadingRateFeatures.pipelineFragmentShadingRate   = VK_TRUE;
+            shadingRateFeatures.attachmentFragmentShadingRate = VK_TRUE;
+
+            supportsShadingRate = chainFeatures(modifiedCreateInfo,
+                                                shadingRateFeatures,
+                                                &VkPhysicalDeviceFragmentShadingRateFeaturesKHR::pipelineFragmentShadingRate,
+                                                &VkPhysicalDeviceFragmentShadingRateFeaturesKHR::attachmentFragmentShadingRate);
+        }
+        else
+        {
+            supportsShadingRate = false;
+        }
         modifiedCreateInfo.ppEnabledExtensionNames = enabledExtensionNames.data();
         modifiedCreateInfo.enabledExtensionCount   = enabledExtensionNames.size();
 
@@ -216,7 +614,19 @@ namespace vkBasalt
             deviceFeatures = *(modifiedCreateInfo.pEnabledFeatures);
         }
         deviceFeatures.shaderImageGatherExtended = VK_TRUE;
-        modifiedCreateInfo.pEnabledFeatures      = &deviceFeatures;
+        if (supportsDescriptorIndexing)
+        {
+            deviceFeatures.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+        }
+
+        // needed to write mip levels of any format from the mip map compute shader
+        VkPhysicalDeviceFeatures supportedFeatures;
+        instanceDispatchMap[GetKey(physicalDevice)].GetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+        if (supportedFeatures.shaderStorageImageWriteWithoutFormat)
+        {
+            deviceFeatures.shaderStorageImageWriteWithoutFormat = VK_TRUE;
+        }
+        modifiedCreateInfo.pEnabledFeatures = &deviceFeatures;
 
         VkResult ret = createFunc(physicalDevice, &modifiedCreateInfo, pAllocator, pDevice);
 
@@ -235,6 +645,30 @@ namespace vkBasalt
         pLogicalDevice->commandPool           = VK_NULL_HANDLE;
         pLogicalDevice->supportsMutableFormat = supportsMutableFormat;
 
+        pLogicalDevice->supportsPipelineLibrary = supportsPipelineLibrary;
+
+        pLogicalDevice->supportsBindMemory2    = supportsBindMemory2;
+        pLogicalDevice->supportsBindMemory2KHR = supportsBindMemory2KHR;
+
+        pLogicalDevice->CmdBeginRenderingKHR     = (PFN_vkCmdBeginRenderingKHR) gdpa(*pDevice, "vkCmdBeginRenderingKHR");
+        pLogicalDevice->CmdEndRenderingKHR       = (PFN_vkCmdEndRenderingKHR) gdpa(*pDevice, "vkCmdEndRenderingKHR");
+        pLogicalDevice->supportsDynamicRendering = supportsDynamicRendering && pLogicalDevice->CmdBeginRenderingKHR && pLogicalDevice->CmdEndRenderingKHR;
+
+        pLogicalDevice->supportsDescriptorIndexing = supportsDescriptorIndexing;
+
+        pLogicalDevice->supportsConditionalRendering = supportsConditionalRendering;
+
+        pLogicalDevice->supportsShadingRate = supportsShadingRate && pLogicalDevice->supportsDynamicRendering;
+
+        // a texel of 16x16 pixels keeps the pass that writes the image cheap, if the device allows it
+        VkExtent2D minTexelSize              = shadingRateProperties.minFragmentShadingRateAttachmentTexelSize;
+        VkExtent2D maxTexelSize              = shadingRateProperties.maxFragmentShadingRateAttachmentTexelSize;
+        pLogicalDevice->shadingRateTexelSize = {std::clamp(16u, minTexelSize.width, maxTexelSize.width),
+                                                std::clamp(16u, minTexelSize.height, maxTexelSize.height)};
+
+        // the queue gets checked for compute support once we know it
+        pLogicalDevice->supportsComputeMipMaps = supportedFeatures.shaderStorageImageWriteWithoutFormat;
+
         // store the table by key
         {
             scoped_lock l(globalLock);
@@ -251,6 +685,9 @@ namespace vkBasalt
         Logger::trace("vkDestroyDevice");
 
         LogicalDevice* pLogicalDevice = deviceMap[GetKey(device)].get();
+        pLogicalDevice->textureCache.clear();
+        clearObjectCache(pLogicalDevice);
+        destroyDescriptorHeap(pLogicalDevice);
         if (pLogicalDevice->commandPool != VK_NULL_HANDLE)
         {
             Logger::debug("DestroyCommandPool");
@@ -262,6 +699,174 @@ namespace vkBasalt
         deviceMap.erase(GetKey(device));
     }
 
+    // picks the depth image that suits the swapchain best, the images switch to it the next time they get presented
+    static void chooseSwapchainDepthImage(LogicalDevice* pLogicalDevice, LogicalSwapchain* pLogicalSwapchain)
+    {
+        const DepthImage* pDepthImage      = chooseDepthImage(pLogicalDevice, pLogicalSwapchain->imageExtent);
+        pLogicalSwapchain->depthSerial     = pDepthImage ? pDepthImage->serial : 0;
+        pLogicalSwapchain->depthGeneration = getDepthGeneration(pLogicalDevice);
+    }
+
+    // points the effects of one image at the depth image the swapchain chose, the last submission of the image has finished
+    static void useDepthImage(LogicalDevice* pLogicalDevice, LogicalSwapchain* pLogicalSwapchain, uint32_t index)
+    {
+        const DepthImage* pDepthImage = retainDepthImage(pLogicalDevice, pLogicalSwapchain->depthSerial);
+        releaseDepthImage(pLogicalDevice, pLogicalSwapchain->depthSerials[index]);
+
+        pLogicalSwapchain->depthSerials[index]                = pDepthImage ? pDepthImage->serial : 0;
+        pLogicalSwapchain->commandBuffersDepth[index * 2]     = pDepthImage ? pDepthImage->commandBuffers[0] : VK_NULL_HANDLE;
+        pLogicalSwapchain->commandBuffersDepth[index * 2 + 1] = pDepthImage ? pDepthImage->commandBuffers[1] : VK_NULL_HANDLE;
+
+        for (auto& effect : pLogicalSwapchain->effects)
+        {
+            effect->useDepthImage(index, pDepthImage ? pDepthImage->imageView : VK_NULL_HANDLE);
+            if (!effect->rebindsDepthImageInPlace())
+            {
+                pLogicalSwapchain->staleCommandBuffers[index] = true;
+            }
+        }
+    }
+
+    // the output of the effects changed as a whole, every image has to be processed completely the next time it gets presented
+    static void resetDamage(LogicalSwapchain* pLogicalSwapchain)
+    {
+        pLogicalSwapchain->damageRects.assign(pLogicalSwapchain->imageCount, {{0, 0}, pLogicalSwapchain->imageExtent});
+        pLogicalSwapchain->damageReset = true;
+        if (pLogicalSwapchain->frameComparer)
+        {
+            pLogicalSwapchain->frameComparer->forceChanges();
+        }
+    }
+
+    // records the effect command buffers of the new swapchain with the depth image that suits it best
+    static void writeEffectCommandBuffers(LogicalDevice* pLogicalDevice, LogicalSwapchain* pLogicalSwapchain)
+    {
+        chooseSwapchainDepthImage(pLogicalDevice, pLogicalSwapchain);
+        pLogicalSwapchain->depthSerials.assign(pLogicalSwapchain->imageCount, 0);
+        pLogicalSwapchain->commandBuffersDepth.assign(pLogicalSwapchain->imageCount * 2, VK_NULL_HANDLE);
+        pLogicalSwapchain->staleCommandBuffers.assign(pLogicalSwapchain->imageCount, false);
+        for (uint32_t i = 0; i < pLogicalSwapchain->imageCount; i++)
+        {
+            useDepthImage(pLogicalDevice, pLogicalSwapchain, i);
+        }
+        // the command buffers do not exist yet
+        pLogicalSwapchain->staleCommandBuffers.assign(pLogicalSwapchain->imageCount, false);
+
+        pLogicalSwapchain->commandBuffersEffect = allocateCommandBuffer(pLogicalDevice, pLogicalSwapchain->imageCount);
+        Logger::debug("allocated CommandBuffers " + std::to_string(pLogicalSwapchain->commandBuffersEffect.size()));
+
+        writeCommandBuffers(pLogicalDevice,
+                            pLogicalSwapchain->effects,
+                            pLogicalSwapchain->commandBuffersEffect,
+                            pLogicalSwapchain->copyEffects,
+                            pLogicalSwapchain->predicateBuffer,
+                            pLogicalSwapchain->effectsEnabled);
+        Logger::debug("wrote CommandBuffers");
+
+        resetDamage(pLogicalSwapchain);
+    }
+
+    // records the effect command buffer of one image again, the last submission of the command buffer has finished,
+    // once the effects wrote the outputs of the image they keep them where the damage rectangles leave them alone
+    // and, with a frame comparer, only run if it found a change
+    static void writeImageCommandBuffer(LogicalDevice* pLogicalDevice, LogicalSwapchain* pLogicalSwapchain, uint32_t index)
+    {
+        // the command pool cannot reset single command buffers
+        pLogicalDevice->vkd.FreeCommandBuffers(
+            pLogicalDevice->device, pLogicalDevice->commandPool, 1, &pLogicalSwapchain->commandBuffersEffect[index]);
+        pLogicalSwapchain->commandBuffersEffect[index] = allocateCommandBuffer(pLogicalDevice, 1)[0];
+
+        bool keepOutput = pLogicalSwapchain->processedImages[index]
+                          && (pLogicalSwapchain->frameComparer || pLogicalSwapchain->damageRadius != UINT32_MAX);
+        bool skippable  = keepOutput && pLogicalSwapchain->frameComparer;
+        for (auto& effect : pLogicalSwapchain->effects)
+        {
+            effect->setKeepOutput(keepOutput);
+        }
+        for (auto& effect : pLogicalSwapchain->copyEffects)
+        {
+            effect->setKeepOutput(keepOutput);
+        }
+
+        writeCommandBuffer(pLogicalDevice,
+                           pLogicalSwapchain->effects,
+                           index,
+                           pLogicalSwapchain->commandBuffersEffect[index],
+                           pLogicalSwapchain->copyEffects,
+                           pLogicalSwapchain->predicateBuffer,
+                           pLogicalSwapchain->effectsEnabled,
+                           skippable ? pLogicalSwapchain->frameComparer->getChangedBuffer() : VK_NULL_HANDLE,
+                           skippable ? pLogicalSwapchain->frameComparer->getChangedOffset(index) : 0);
+        pLogicalSwapchain->staleCommandBuffers[index] = false;
+
+        // the recordings of all images at once come first, before any outputs exist
+        for (auto& effect : pLogicalSwapchain->effects)
+        {
+            effect->setKeepOutput(false);
+        }
+        for (auto& effect : pLogicalSwapchain->copyEffects)
+        {
+            effect->setKeepOutput(false);
+        }
+    }
+
+    // adds the present regions of VK_KHR_incremental_present to the damage of every image of the swapchain
+    // and hands the effects what changed since the presented image was last presented, the fence of the image has signaled,
+    // returns false if the whole output changed, outputRects gets the present regions grown by the damage radius otherwise
+    static bool processDamage(LogicalDevice*               pLogicalDevice,
+                              LogicalSwapchain*            pLogicalSwapchain,
+                              uint32_t                     index,
+                              const VkPresentRegionKHR*    pRegion,
+                              std::vector<VkRectLayerKHR>& outputRects)
+    {
+        VkRect2D fullRect = {{0, 0}, pLogicalSwapchain->imageExtent};
+
+        // no rectangles mean that the whole image changed
+        bool     wholeImage = pLogicalSwapchain->damageRadius == UINT32_MAX || !pRegion || pRegion->rectangleCount == 0;
+        VkRect2D damage     = wholeImage ? fullRect : VkRect2D{{0, 0}, {0, 0}};
+        for (uint32_t i = 0; !wholeImage && i < pRegion->rectangleCount; i++)
+        {
+            const VkRectLayerKHR& rectangle = pRegion->pRectangles[i];
+
+            VkRect2D rect       = intersectRects({rectangle.offset, rectangle.extent}, fullRect);
+            VkRect2D outputRect = dilateRect(rect, pLogicalSwapchain->damageRadius, pLogicalSwapchain->imageExtent);
+            damage              = uniteDamage(damage, rect);
+            outputRects.push_back({outputRect.offset, outputRect.extent, rectangle.layer});
+        }
+
+        for (auto& damageRect : pLogicalSwapchain->damageRects)
+        {
+            damageRect = uniteDamage(damageRect, damage);
+        }
+
+        // a frame without any change processes nothing, but a command buffer that does not keep the outputs has to write all of them
+        VkRect2D damageRect                   = pLogicalSwapchain->processedImages[index] ? pLogicalSwapchain->damageRects[index] : fullRect;
+        pLogicalSwapchain->damageRects[index] = {{0, 0}, {0, 0}};
+
+        // every effect processes the damage grown by its own radius and the radii of the effects before it
+        uint32_t radius = 0;
+        for (size_t j = 0; j < pLogicalSwapchain->effects.size(); j++)
+        {
+            radius += pLogicalSwapchain->effects[j]->getDamageRadius();
+            VkRect2D effectRect = dilateRect(damageRect, radius, pLogicalSwapchain->imageExtent);
+            pLogicalSwapchain->effects[j]->setDamageRect(index, effectRect);
+            if (j < pLogicalSwapchain->copyEffects.size())
+            {
+                pLogicalSwapchain->copyEffects[j]->setDamageRect(index, effectRect);
+            }
+        }
+
+        // the damage is data, the command buffer only gets recorded again if something it depends on changed
+        if (pLogicalSwapchain->staleCommandBuffers[index])
+        {
+            writeImageCommandBuffer(pLogicalDevice, pLogicalSwapchain, index);
+        }
+
+        bool partial                   = !wholeImage && !pLogicalSwapchain->damageReset;
+        pLogicalSwapchain->damageReset = false;
+        return partial;
+    }
+
     static void saveDeviceQueue(LogicalDevice* pLogicalDevice, uint32_t queueFamilyIndex, VkQueue* pQueue)
     {
         if (pLogicalDevice->queue != VK_NULL_HANDLE)
@@ -303,6 +908,11 @@ namespace vkBasalt
             pLogicalDevice->vkd.CreateCommandPool(pLogicalDevice->device, &commandPoolCreateInfo, nullptr, &pLogicalDevice->commandPool);
             pLogicalDevice->queue            = *pQueue;
             pLogicalDevice->queueFamilyIndex = queueFamilyIndex;
+
+            if (count > 0 && (queueProperties[queueFamilyIndex].queueFlags & VK_QUEUE_COMPUTE_BIT) == 0)
+            {
+                pLogicalDevice->supportsComputeMipMaps = false;
+            }
         }
     }
 
@@ -371,11 +981,33 @@ namespace vkBasalt
 
         modifiedCreateInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
 
+        // with a render scale the application gets images of the size it asked for, the real swapchain gets the size of the surface
+        if (getRenderScale() < 1.0f)
+        {
+            VkSurfaceCapabilitiesKHR surfaceCapabilities;
+            pLogicalDevice->vki.GetPhysicalDeviceSurfaceCapabilitiesKHR(pLogicalDevice->physicalDevice, pCreateInfo->surface, &surfaceCapabilities);
+            // if the swapchain decides the size of the surface, a larger swapchain would make the window larger
+            if (surfaceCapabilities.currentExtent.width == 0xFFFFFFFF)
+            {
+                Logger::err("renderScale is not supported on surfaces whose size the swapchain decides, rendering at full size");
+            }
+            else
+            {
+                modifiedCreateInfo.imageExtent = surfaceCapabilities.currentExtent;
+                // the upscaler renders to the swapchain images
+                modifiedCreateInfo.imageUsage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+                Logger::debug("upscaling " + std::to_string(pCreateInfo->imageExtent.width) + "x"
+                              + std::to_string(pCreateInfo->imageExtent.height) + " to " + std::to_string(modifiedCreateInfo.imageExtent.width)
+                              + "x" + std::to_string(modifiedCreateInfo.imageExtent.height));
+            }
+        }
+
         Logger::debug("format " + std::to_string(modifiedCreateInfo.imageFormat));
         std::shared_ptr<LogicalSwapchain> pLogicalSwapchain(new LogicalSwapchain());
         pLogicalSwapchain->pLogicalDevice      = pLogicalDevice;
         pLogicalSwapchain->swapchainCreateInfo = *pCreateInfo;
-        pLogicalSwapchain->imageExtent         = modifiedCreateInfo.imageExtent;
+        pLogicalSwapchain->imageExtent         = pCreateInfo->imageExtent;
+        pLogicalSwapchain->outputExtent        = modifiedCreateInfo.imageExtent;
         pLogicalSwapchain->format              = modifiedCreateInfo.imageFormat;
         pLogicalSwapchain->imageCount          = 0;
 
@@ -386,6 +1018,89 @@ namespace vkBasalt
         return result;
     }
 
+    // contentRect = x:y:width:height, returns false if it is not set or does not fit into the image
+    static bool getConfiguredContentRect(VkExtent2D imageExtent, VkRect2D& contentRect)
+    {
+        std::vector<std::string> values = pConfig->getOption<std::vector<std::string>>("contentRect", {});
+        if (values.empty())
+        {
+            return false;
+        }
+
+        std::vector<int64_t> numbers;
+        try
+        {
+            for (auto& value : values)
+            {
+                numbers.push_back(std::stoll(value));
+            }
+        }
+        catch (...)
+        {
+            numbers.clear();
+        }
+
+        if (numbers.size() != 4 || numbers[0] < 0 || numbers[1] < 0 || numbers[2] <= 0 || numbers[3] <= 0
+            || numbers[0] + numbers[2] > imageExtent.width || numbers[1] + numbers[3] > imageExtent.height)
+        {
+            Logger::err("contentRect does not fit into the " + std::to_string(imageExtent.width) + "x" + std::to_string(imageExtent.height)
+                        + " images, processing all of them");
+            return false;
+        }
+
+        contentRect = {{(int32_t) numbers[0], (int32_t) numbers[1]}, {(uint32_t) numbers[2], (uint32_t) numbers[3]}};
+        return true;
+    }
+
+    static std::shared_ptr<Effect> createEffect(LogicalDevice*       pLogicalDevice,
+                                                LogicalSwapchain*    pLogicalSwapchain,
+                                                const std::string&   effectName,
+                                                VkExtent2D           imageExtent,
+                                                std::vector<VkImage> firstImages,
+                                                std::vector<VkImage> secondImages,
+                                                uint32_t             updateInterval)
+    {
+        VkFormat unormFormat = convertToUNORM(pLogicalSwapchain->format);
+        VkFormat srgbFormat  = convertToSRGB(pLogicalSwapchain->format);
+
+        if (effectName == std::string("fxaa"))
+        {
+            Logger::debug("creating FxaaEffect");
+            return std::shared_ptr<Effect>(new FxaaEffect(pLogicalDevice, srgbFormat, imageExtent, firstImages, secondImages, pConfig.get()));
+        }
+        else if (effectName == std::string("cas"))
+        {
+            Logger::debug("creating CasEffect");
+            return std::shared_ptr<Effect>(new CasEffect(pLogicalDevice, unormFormat, imageExtent, firstImages, secondImages, pConfig.get()));
+        }
+        else if (effectName == std::string("deband"))
+        {
+            Logger::debug("creating DebandEffect");
+            return std::shared_ptr<Effect>(new DebandEffect(pLogicalDevice, unormFormat, imageExtent, firstImages, secondImages, pConfig.get()));
+        }
+        else if (effectName == std::string("smaa"))
+        {
+            Logger::debug("creating SmaaEffect");
+            return std::shared_ptr<Effect>(new SmaaEffect(pLogicalDevice, unormFormat, imageExtent, firstImages, secondImages, pConfig.get()));
+        }
+        else if (effectName == std::string("lut"))
+        {
+            Logger::debug("creating LutEffect");
+            return std::shared_ptr<Effect>(new LutEffect(pLogicalDevice, unormFormat, imageExtent, firstImages, secondImages, pConfig.get()));
+        }
+        else if (effectName == std::string("dls"))
+        {
+            Logger::debug("creating DlsEffect");
+            return std::shared_ptr<Effect>(new DlsEffect(pLogicalDevice, unormFormat, imageExtent, firstImages, secondImages, pConfig.get()));
+        }
+        else
+        {
+            Logger::debug("creating ReshadeEffect");
+            return std::shared_ptr<Effect>(new ReshadeEffect(
+                pLogicalDevice, pLogicalSwapchain->format, imageExtent, firstImages, secondImages, pConfig.get(), effectName, updateInterval));
+        }
+    }
+
     VKAPI_ATTR VkResult VKAPI_CALL vkBasalt_GetSwapchainImagesKHR(VkDevice       device,
                                                                   VkSwapchainKHR swapchain,
                                                                   uint32_t*      pCount,
@@ -415,8 +1130,11 @@ namespace vkBasalt
 
         std::vector<std::string> effectStrings = pConfig->getOption<std::vector<std::string>>("effects", {"cas"});
 
-        // create 1 more set of images when we can't use the swapchain it self
-        uint32_t fakeImageCount = *pCount * (effectStrings.size() + !pLogicalDevice->supportsMutableFormat);
+        bool upscale = pLogicalSwapchain->imageExtent.width != pLogicalSwapchain->outputExtent.width
+                       || pLogicalSwapchain->imageExtent.height != pLogicalSwapchain->outputExtent.height;
+
+        // create 1 more set of images when we can't use the swapchain it self or need to upscale into it
+        uint32_t fakeImageCount = *pCount * (effectStrings.size() + (upscale || !pLogicalDevice->supportsMutableFormat));
 
         pLogicalSwapchain->fakeImages =
             createFakeSwapchainImages(pLogicalDevice, pLogicalSwapchain->swapchainCreateInfo, fakeImageCount, pLogicalSwapchain->fakeImageMemory);
@@ -432,6 +1150,9 @@ namespace vkBasalt
         VkFormat unormFormat = convertToUNORM(pLogicalSwapchain->format);
         VkFormat srgbFormat  = convertToSRGB(pLogicalSwapchain->format);
 
+        // the effects with a toggle key get a copy that takes their place while they are switched off
+        std::vector<std::string> effectToggleKeys = pConfig->getOption<std::vector<std::string>>("effectToggleKeys", {});
+
         for (uint32_t i = 0; i < effectStrings.size(); i++)
         {
             Logger::debug("current effectString " + effectStrings[i]);
@@ -441,7 +1162,7 @@ namespace vkBasalt
             std::vector<VkImage> secondImages;
             if (i == effectStrings.size() - 1)
             {
-                secondImages = pLogicalDevice->supportsMutableFormat
+                secondImages = (pLogicalDevice->supportsMutableFormat && !upscale)
                                    ? pLogicalSwapchain->images
                                    : std::vector<VkImage>(pLogicalSwapchain->fakeImages.end() - pLogicalSwapchain->imageCount,
                                                           pLogicalSwapchain->fakeImages.end());
@@ -454,56 +1175,122 @@ namespace vkBasalt
                 Logger::debug("not using swapchain images as second images");
             }
             Logger::debug(std::to_string(secondImages.size()) + " images in secondImages");
-            if (effectStrings[i] == std::string("fxaa"))
+            // skipping passes needs conditional rendering, which is already in use for effects with a toggle key
+            int32_t updateInterval = std::max(pConfig->getOption<int32_t>(effectStrings[i] + "UpdateInterval", 1), 1);
+            if (updateInterval > 1 && (!pLogicalDevice->supportsConditionalRendering || i < effectToggleKeys.size()))
             {
-                pLogicalSwapchain->effects.push_back(std::shared_ptr<Effect>(
-                    new FxaaEffect(pLogicalDevice, srgbFormat, pLogicalSwapchain->imageExtent, firstImages, secondImages, pConfig.get())));
-                Logger::debug("created FxaaEffect");
+                Logger::err("cannot update " + effectStrings[i] + " every " + std::to_string(updateInterval) + " frames, updating every frame");
+                updateInterval = 1;
             }
-            else if (effectStrings[i] == std::string("cas"))
-            {
-                pLogicalSwapchain->effects.push_back(std::shared_ptr<Effect>(
-                    new CasEffect(pLogicalDevice, unormFormat, pLogicalSwapchain->imageExtent, firstImages, secondImages, pConfig.get())));
-                Logger::debug("created CasEffect");
-            }
-            else if (effectStrings[i] == std::string("deband"))
-            {
-                pLogicalSwapchain->effects.push_back(std::shared_ptr<Effect>(
-                    new DebandEffect(pLogicalDevice, unormFormat, pLogicalSwapchain->imageExtent, firstImages, secondImages, pConfig.get())));
-                Logger::debug("created DebandEffect");
-            }
-            else if (effectStrings[i] == std::string("smaa"))
+
+            // effects with a scale below 1 render between smaller images
+            float scale = pConfig->getOption<float>(effectStrings[i] + "Scale", 1.0f);
+            if (scale > 0.0f && scale < 1.0f)
             {
-                pLogicalSwapchain->effects.push_back(std::shared_ptr<Effect>(
-                    new SmaaEffect(pLogicalDevice, unormFormat, pLogicalSwapchain->imageExtent, firstImages, secondImages, pConfig.get())));
-                Logger::debug("created SmaaEffect");
+                std::shared_ptr<ScaledEffect> pScaledEffect(new ScaledEffect(
+                    pLogicalDevice, pLogicalSwapchain->swapchainCreateInfo, srgbFormat, scale, firstImages, secondImages, pConfig.get()));
+                pScaledEffect->setEffect(createEffect(pLogicalDevice,
+                                                      pLogicalSwapchain,
+                                                      effectStrings[i],
+                                                      pScaledEffect->getScaledExtent(),
+                                                      pScaledEffect->getScaledInputImages(),
+                                                      pScaledEffect->getScaledOutputImages(),
+                                                      updateInterval));
+                pLogicalSwapchain->effects.push_back(pScaledEffect);
             }
-            else if (effectStrings[i] == std::string("lut"))
+            else
             {
-                pLogicalSwapchain->effects.push_back(std::shared_ptr<Effect>(
-                    new LutEffect(pLogicalDevice, unormFormat, pLogicalSwapchain->imageExtent, firstImages, secondImages, pConfig.get())));
-                Logger::debug("created LutEffect");
+                pLogicalSwapchain->effects.push_back(createEffect(
+                    pLogicalDevice, pLogicalSwapchain, effectStrings[i], pLogicalSwapchain->imageExtent, firstImages, secondImages, updateInterval));
             }
-            else if (effectStrings[i] == std::string("dls"))
+
+            // the effects share one shading rate image that gets written from the images of the application
+            int32_t shadingRate = pConfig->getOption<int32_t>(effectStrings[i] + "ShadingRate", 1);
+            if (shadingRate > 1)
             {
-                pLogicalSwapchain->effects.push_back(std::shared_ptr<Effect>(
-                    new DlsEffect(pLogicalDevice, unormFormat, pLogicalSwapchain->imageExtent, firstImages, secondImages, pConfig.get())));
-                Logger::debug("created DlsEffect");
+                uint32_t maxShadingRate = shadingRate >= 4 ? 4 : 2;
+                if (!pLogicalDevice->supportsShadingRate)
+                {
+                    Logger::err("cannot shade " + effectStrings[i] + " coarser, that needs VK_KHR_fragment_shading_rate and dynamic rendering");
+                }
+                else
+                {
+                    if (!pLogicalSwapchain->shadingRateGenerator)
+                    {
+                        pLogicalSwapchain->shadingRateGenerator = std::shared_ptr<ShadingRateGenerator>(new ShadingRateGenerator(
+                            pLogicalDevice,
+                            pLogicalSwapchain->format,
+                            pLogicalSwapchain->imageExtent,
+                            std::vector<VkImage>(pLogicalSwapchain->fakeImages.begin(),
+                                                 pLogicalSwapchain->fakeImages.begin() + pLogicalSwapchain->imageCount),
+                            pConfig.get()));
+                    }
+                    if (!pLogicalSwapchain->effects.back()->useShadingRateImage(
+                            pLogicalSwapchain->shadingRateGenerator->getShadingRateImageView(), maxShadingRate))
+                    {
+                        Logger::err("cannot shade " + effectStrings[i] + " coarser, only the built in effects at full scale can");
+                    }
+                }
             }
-            else
+            if (i < effectToggleKeys.size())
             {
-                pLogicalSwapchain->effects.push_back(std::shared_ptr<Effect>(new ReshadeEffect(pLogicalDevice,
-                                                                                               pLogicalSwapchain->format,
-                                                                                               pLogicalSwapchain->imageExtent,
-                                                                                               firstImages,
-                                                                                               secondImages,
-                                                                                               pConfig.get(),
-                                                                                               effectStrings[i])));
-                Logger::debug("created ReshadeEffect");
+                pLogicalSwapchain->copyEffects.push_back(std::shared_ptr<Effect>(new CopyEffect(
+                    pLogicalDevice, pLogicalSwapchain->format, pLogicalSwapchain->imageExtent, firstImages, secondImages, pConfig.get())));
+                Logger::debug("created CopyEffect");
             }
         }
 
-        if (!pLogicalDevice->supportsMutableFormat)
+        pLogicalSwapchain->effectsEnabled  = std::vector<bool>(pLogicalSwapchain->copyEffects.size(), true);
+        pLogicalSwapchain->predicateBuffer = VK_NULL_HANDLE;
+        pLogicalSwapchain->pPredicates     = nullptr;
+        if (pLogicalDevice->supportsConditionalRendering && !pLogicalSwapchain->copyEffects.empty())
+        {
+            VkDeviceSize predicateCount = pLogicalSwapchain->imageCount * pLogicalSwapchain->copyEffects.size();
+            createBuffer(pLogicalDevice,
+                         predicateCount * sizeof(uint32_t),
+                         VK_BUFFER_USAGE_CONDITIONAL_RENDERING_BIT_EXT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         pLogicalSwapchain->predicateBuffer,
+                         pLogicalSwapchain->predicateMemory);
+
+            void*    data;
+            VkResult result =
+                pLogicalDevice->vkd.MapMemory(pLogicalDevice->device, pLogicalSwapchain->predicateMemory, 0, VK_WHOLE_SIZE, 0, &data);
+            ASSERT_VULKAN(result);
+            pLogicalSwapchain->pPredicates = static_cast<uint32_t*>(data);
+            std::fill(pLogicalSwapchain->pPredicates, pLogicalSwapchain->pPredicates + predicateCount, 1);
+            Logger::debug("created predicate buffer");
+        }
+
+        // the effects only process the content rectangle, the borders of their output get copied from the images of the application
+        bool useContentRect =
+            pConfig->getOption<bool>("letterboxDetection", false) || !pConfig->getOption<std::vector<std::string>>("contentRect", {}).empty();
+        if (useContentRect && !effectStrings.empty())
+        {
+            pLogicalSwapchain->effects.push_back(std::shared_ptr<Effect>(new BorderEffect(
+                pLogicalDevice,
+                pLogicalSwapchain->format,
+                pLogicalSwapchain->imageExtent,
+                std::vector<VkImage>(pLogicalSwapchain->fakeImages.begin(), pLogicalSwapchain->fakeImages.begin() + pLogicalSwapchain->imageCount),
+                (pLogicalDevice->supportsMutableFormat && !upscale)
+                    ? pLogicalSwapchain->images
+                    : std::vector<VkImage>(pLogicalSwapchain->fakeImages.end() - pLogicalSwapchain->imageCount, pLogicalSwapchain->fakeImages.end()),
+                pConfig.get())));
+        }
+
+        // without mutable format support the swapchain images can only be written in their own format
+        VkFormat upscaleFormat = pLogicalDevice->supportsMutableFormat ? unormFormat : pLogicalSwapchain->format;
+        if (upscale)
+        {
+            pLogicalSwapchain->effects.push_back(std::shared_ptr<Effect>(new UpscaleEffect(
+                pLogicalDevice,
+                upscaleFormat,
+                pLogicalSwapchain->outputExtent,
+                std::vector<VkImage>(pLogicalSwapchain->fakeImages.end() - pLogicalSwapchain->imageCount, pLogicalSwapchain->fakeImages.end()),
+                pLogicalSwapchain->images,
+                pConfig.get())));
+        }
+        else if (!pLogicalDevice->supportsMutableFormat)
         {
             pLogicalSwapchain->effects.push_back(std::shared_ptr<Effect>(new TransferEffect(
                 pLogicalDevice,
@@ -514,22 +1301,68 @@ namespace vkBasalt
                 pConfig.get())));
         }
 
-        VkImageView depthImageView = pLogicalDevice->depthImageViews.size() ? pLogicalDevice->depthImageViews[0] : VK_NULL_HANDLE;
-        VkImage     depthImage     = pLogicalDevice->depthImageViews.size() ? pLogicalDevice->depthImages[0] : VK_NULL_HANDLE;
-        VkFormat    depthFormat    = pLogicalDevice->depthImageViews.size() ? pLogicalDevice->depthFormats[0] : VK_FORMAT_UNDEFINED;
+        // the detector runs last, so that the positions of the effects with a toggle key stay the same
+        pLogicalSwapchain->contentRect = {{0, 0}, pLogicalSwapchain->imageExtent};
+        if (getConfiguredContentRect(pLogicalSwapchain->imageExtent, pLogicalSwapchain->contentRect))
+        {
+            for (auto& effect : pLogicalSwapchain->effects)
+            {
+                effect->setContentRect(pLogicalSwapchain->contentRect);
+            }
+        }
+        else if (pConfig->getOption<bool>("letterboxDetection", false))
+        {
+            pLogicalSwapchain->letterboxDetector = std::shared_ptr<LetterboxDetector>(new LetterboxDetector(
+                pLogicalDevice,
+                pLogicalSwapchain->format,
+                pLogicalSwapchain->imageExtent,
+                std::vector<VkImage>(pLogicalSwapchain->fakeImages.begin(), pLogicalSwapchain->fakeImages.begin() + pLogicalSwapchain->imageCount),
+                pConfig.get()));
+            pLogicalSwapchain->effects.push_back(pLogicalSwapchain->letterboxDetector);
+        }
+
+        // textures and objects that none of the new effects picked up again are not needed anymore
+        trimTextureCache(pLogicalDevice);
+        trimObjectCache(pLogicalDevice);
 
         Logger::debug("effect string count: " + std::to_string(effectStrings.size()));
         Logger::debug("effect count: " + std::to_string(pLogicalSwapchain->effects.size()));
 
-        pLogicalSwapchain->commandBuffersEffect = allocateCommandBuffer(pLogicalDevice, pLogicalSwapchain->imageCount);
-        Logger::debug("allocated ComandBuffers " + std::to_string(pLogicalSwapchain->commandBuffersEffect.size()) + " for swapchain "
-                      + convertToString(swapchain));
+        // conditional rendering on the result of the comparer skips the effects, the effects with a toggle key use it already
+        if (pConfig->getOption<bool>("skipIdenticalFrames", false))
+        {
+            bool skippable = std::all_of(pLogicalSwapchain->effects.begin(), pLogicalSwapchain->effects.end(), [](auto& effect) {
+                return effect->isSkippable();
+            });
+            if (!pLogicalDevice->supportsConditionalRendering || !pLogicalSwapchain->copyEffects.empty() || !skippable)
+            {
+                Logger::err("cannot skip identical frames, that needs conditional rendering, no effectToggleKeys and effects that can be skipped");
+            }
+            else
+            {
+                std::vector<VkImage> images(pLogicalSwapchain->fakeImages.begin(),
+                                            pLogicalSwapchain->fakeImages.begin() + pLogicalSwapchain->imageCount);
+                pLogicalSwapchain->frameComparer = std::shared_ptr<FrameComparer>(
+                    new FrameComparer(pLogicalDevice, pLogicalSwapchain->format, pLogicalSwapchain->imageExtent, images));
+                pLogicalSwapchain->commandBuffersCompare = allocateCommandBuffer(pLogicalDevice, pLogicalSwapchain->imageCount);
+                writeCommandBuffers(pLogicalDevice, {pLogicalSwapchain->frameComparer}, pLogicalSwapchain->commandBuffersCompare);
+            }
+        }
+        pLogicalSwapchain->processedImages.assign(pLogicalSwapchain->imageCount, false);
 
-        writeCommandBuffers(
-            pLogicalDevice, pLogicalSwapchain->effects, depthImage, depthImageView, depthFormat, pLogicalSwapchain->commandBuffersEffect);
-        Logger::debug("wrote CommandBuffers");
+        if (pLogicalSwapchain->shadingRateGenerator)
+        {
+            pLogicalSwapchain->commandBuffersShadingRate = allocateCommandBuffer(pLogicalDevice, pLogicalSwapchain->imageCount);
+            writeCommandBuffers(pLogicalDevice, {pLogicalSwapchain->shadingRateGenerator}, pLogicalSwapchain->commandBuffersShadingRate);
+        }
+
+        pLogicalSwapchain->damageRadius = getDamageRadius(pLogicalSwapchain->effects);
+        Logger::debug("damage radius: " + std::to_string(pLogicalSwapchain->damageRadius));
+
+        writeEffectCommandBuffers(pLogicalDevice, pLogicalSwapchain);
 
         pLogicalSwapchain->semaphores = createSemaphores(pLogicalDevice, pLogicalSwapchain->imageCount);
+        pLogicalSwapchain->fences     = createFences(pLogicalDevice, pLogicalSwapchain->imageCount);
         Logger::debug("created semaphores");
         for (unsigned int i = 0; i < pLogicalSwapchain->imageCount; i++)
         {
@@ -537,22 +1370,26 @@ namespace vkBasalt
         }
         Logger::trace("vkGetSwapchainImagesKHR");
 
-        pLogicalSwapchain->defaultTransfer = std::shared_ptr<Effect>(new TransferEffect(
-            pLogicalDevice,
-            pLogicalSwapchain->format,
-            pLogicalSwapchain->imageExtent,
-            std::vector<VkImage>(pLogicalSwapchain->fakeImages.begin(), pLogicalSwapchain->fakeImages.begin() + pLogicalSwapchain->imageCount),
-            pLogicalSwapchain->images,
-            pConfig.get()));
+        std::vector<VkImage> applicationImages(pLogicalSwapchain->fakeImages.begin(),
+                                               pLogicalSwapchain->fakeImages.begin() + pLogicalSwapchain->imageCount);
+        if (upscale)
+        {
+            pLogicalSwapchain->defaultTransfer = std::shared_ptr<Effect>(new UpscaleEffect(
+                pLogicalDevice, upscaleFormat, pLogicalSwapchain->outputExtent, applicationImages, pLogicalSwapchain->images, pConfig.get()));
+        }
+        else
+        {
+            pLogicalSwapchain->defaultTransfer = std::shared_ptr<Effect>(new TransferEffect(pLogicalDevice,
+                                                                                            pLogicalSwapchain->format,
+                                                                                            pLogicalSwapchain->imageExtent,
+                                                                                            applicationImages,
+                                                                                            pLogicalSwapchain->images,
+                                                                                            pConfig.get()));
+        }
 
         pLogicalSwapchain->commandBuffersNoEffect = allocateCommandBuffer(pLogicalDevice, pLogicalSwapchain->imageCount);
 
-        writeCommandBuffers(pLogicalDevice,
-                            {pLogicalSwapchain->defaultTransfer},
-                            VK_NULL_HANDLE,
-                            VK_NULL_HANDLE,
-                            VK_FORMAT_UNDEFINED,
-                            pLogicalSwapchain->commandBuffersNoEffect);
+        writeCommandBuffers(pLogicalDevice, {pLogicalSwapchain->defaultTransfer}, pLogicalSwapchain->commandBuffersNoEffect);
 
         for (unsigned int i = 0; i < pLogicalSwapchain->imageCount; i++)
         {
@@ -584,12 +1421,48 @@ namespace vkBasalt
             pressed = false;
         }
 
+        // the keys of single effects, by position in the effects option
+        static std::vector<uint32_t> effectKeySymbols = [] {
+            std::vector<uint32_t> keySymbols;
+            for (auto& key : pConfig->getOption<std::vector<std::string>>("effectToggleKeys", {}))
+            {
+                keySymbols.push_back(convertToKeySym(key));
+            }
+            return keySymbols;
+        }();
+
+        static std::vector<bool> effectKeysPressed(effectKeySymbols.size(), false);
+        static std::vector<bool> effectsEnabled(effectKeySymbols.size(), true);
+
+        for (size_t i = 0; i < effectKeySymbols.size(); i++)
+        {
+            if (isKeyPressed(effectKeySymbols[i]))
+            {
+                if (!effectKeysPressed[i])
+                {
+                    effectsEnabled[i]    = !effectsEnabled[i];
+                    effectKeysPressed[i] = true;
+                }
+            }
+            else
+            {
+                effectKeysPressed[i] = false;
+            }
+        }
+
         LogicalDevice* pLogicalDevice = deviceMap[GetKey(queue)].get();
 
         std::vector<VkSemaphore> presentSemaphores;
         presentSemaphores.reserve(pPresentInfo->swapchainCount);
 
-        std::vector<VkPipelineStageFlags> waitStages(pPresentInfo->waitSemaphoreCount, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+        // VK_KHR_incremental_present, the effects spread the changes of the application, so the real present gets the grown rectangles
+        const VkPresentRegionsKHR*               pPresentRegions = findPresentRegions(pPresentInfo);
+        std::vector<std::vector<VkRectLayerKHR>> outputRects(pPresentInfo->swapchainCount);
+        std::vector<VkPresentRegionKHR>          outputRegions(pPresentInfo->swapchainCount);
+
+        // the letterbox detector reads the images of the application in a compute shader
+        std::vector<VkPipelineStageFlags> waitStages(pPresentInfo->waitSemaphoreCount,
+                                                     VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
 
         for (unsigned int i = 0; i < (*pPresentInfo).swapchainCount; i++)
         {
@@ -597,37 +1470,172 @@ namespace vkBasalt
             VkSwapchainKHR    swapchain         = (*pPresentInfo).pSwapchains[i];
             LogicalSwapchain* pLogicalSwapchain = swapchainMap[swapchain].get();
 
+            // the application can acquire the image again before the submission of its last present finished
+            VkFence fence = pLogicalSwapchain->fences[index];
+            pLogicalDevice->vkd.WaitForFences(pLogicalDevice->device, 1, &fence, VK_TRUE, UINT64_MAX);
+
+            // the depth image only changes between frames, no matter how often the application creates and destroys depth images
+            if (pLogicalSwapchain->depthGeneration != getDepthGeneration(pLogicalDevice))
+            {
+                uint64_t depthSerial = pLogicalSwapchain->depthSerial;
+                chooseSwapchainDepthImage(pLogicalDevice, pLogicalSwapchain);
+                if (pLogicalSwapchain->depthSerial != depthSerial)
+                {
+                    Logger::debug("switching depth image of swapchain " + convertToString(swapchain));
+                    resetDamage(pLogicalSwapchain);
+                }
+            }
+            // the other images may still read the depth image of before, they switch when they get presented themselves
+            if (pLogicalSwapchain->depthSerials[index] != pLogicalSwapchain->depthSerial)
+            {
+                useDepthImage(pLogicalDevice, pLogicalSwapchain, index);
+            }
+
+            std::vector<bool> swapchainEffectsEnabled(effectsEnabled.begin(), effectsEnabled.begin() + pLogicalSwapchain->copyEffects.size());
+            if (pLogicalSwapchain->pPredicates)
+            {
+                // the fence of the image got waited on above, so no submission reads its predicates anymore
+                for (size_t j = 0; j < swapchainEffectsEnabled.size(); j++)
+                {
+                    pLogicalSwapchain->pPredicates[index * swapchainEffectsEnabled.size() + j] = swapchainEffectsEnabled[j];
+                }
+                if (swapchainEffectsEnabled != pLogicalSwapchain->effectsEnabled)
+                {
+                    pLogicalSwapchain->effectsEnabled = swapchainEffectsEnabled;
+                    resetDamage(pLogicalSwapchain);
+                }
+            }
+            else if (swapchainEffectsEnabled != pLogicalSwapchain->effectsEnabled)
+            {
+                // without conditional rendering the switches are part of the command buffers,
+                // the other images may still run theirs, so every image gets recorded again before its next submission
+                pLogicalSwapchain->effectsEnabled = swapchainEffectsEnabled;
+                pLogicalSwapchain->staleCommandBuffers.assign(pLogicalSwapchain->imageCount, true);
+                resetDamage(pLogicalSwapchain);
+            }
+
+            // the detected rectangle is part of the command buffers, it changes rarely because it only shrinks after a while
+            if (pLogicalSwapchain->letterboxDetector
+                && !isSameRect(pLogicalSwapchain->letterboxDetector->getContentRect(), pLogicalSwapchain->contentRect))
+            {
+                pLogicalSwapchain->contentRect = pLogicalSwapchain->letterboxDetector->getContentRect();
+                Logger::debug("content rectangle " + std::to_string(pLogicalSwapchain->contentRect.offset.x) + ","
+                              + std::to_string(pLogicalSwapchain->contentRect.offset.y) + " "
+                              + std::to_string(pLogicalSwapchain->contentRect.extent.width) + "x"
+                              + std::to_string(pLogicalSwapchain->contentRect.extent.height));
+                for (auto& effect : pLogicalSwapchain->effects)
+                {
+                    effect->setContentRect(pLogicalSwapchain->contentRect);
+                }
+                pLogicalSwapchain->staleCommandBuffers.assign(pLogicalSwapchain->imageCount, true);
+                resetDamage(pLogicalSwapchain);
+            }
+
+            // without the effects the images get copied completely
+            if (presentEffect)
+            {
+                const VkPresentRegionKHR* pRegion = pPresentRegions && pPresentRegions->pRegions ? &pPresentRegions->pRegions[i] : nullptr;
+                if (!processDamage(pLogicalDevice, pLogicalSwapchain, index, pRegion, outputRects[i]))
+                {
+                    outputRects[i].clear();
+                }
+            }
+            else
+            {
+                resetDamage(pLogicalSwapchain);
+            }
+            outputRegions[i].rectangleCount = outputRects[i].size();
+            outputRegions[i].pRectangles    = outputRects[i].empty() ? nullptr : outputRects[i].data();
+
             for (auto& effect : pLogicalSwapchain->effects)
             {
-                effect->updateEffect();
+                effect->updateEffect(index);
+            }
+            // the changed flag of the image is only rewritten after the wait on its fence above
+            if (pLogicalSwapchain->frameComparer && presentEffect)
+            {
+                pLogicalSwapchain->frameComparer->updateEffect(index);
+            }
+
+            // the depth image is only in the shader read only layout while the effects run
+            std::vector<VkCommandBuffer> commandBuffers = {pLogicalSwapchain->commandBuffersNoEffect[index]};
+            if (presentEffect)
+            {
+                commandBuffers = {pLogicalSwapchain->commandBuffersEffect[index]};
+                if (!pLogicalSwapchain->commandBuffersShadingRate.empty())
+                {
+                    commandBuffers.insert(commandBuffers.begin(), pLogicalSwapchain->commandBuffersShadingRate[index]);
+                }
+                if (!pLogicalSwapchain->commandBuffersCompare.empty())
+                {
+                    commandBuffers.insert(commandBuffers.begin(), pLogicalSwapchain->commandBuffersCompare[index]);
+                }
+                if (pLogicalSwapchain->commandBuffersDepth[index * 2] != VK_NULL_HANDLE)
+                {
+                    commandBuffers.insert(commandBuffers.begin(), pLogicalSwapchain->commandBuffersDepth[index * 2]);
+                    commandBuffers.push_back(pLogicalSwapchain->commandBuffersDepth[index * 2 + 1]);
+                }
             }
 
             VkSubmitInfo submitInfo;
-            submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-            submitInfo.pNext              = nullptr;
-            submitInfo.waitSemaphoreCount = i == 0 ? pPresentInfo->waitSemaphoreCount : 0;
-            submitInfo.pWaitSemaphores    = i == 0 ? pPresentInfo->pWaitSemaphores : nullptr;
-            submitInfo.pWaitDstStageMask  = i == 0 ? waitStages.data() : nullptr;
-            submitInfo.commandBufferCount = 1;
-            submitInfo.pCommandBuffers =
-                presentEffect ? &(pLogicalSwapchain->commandBuffersEffect[index]) : &(pLogicalSwapchain->commandBuffersNoEffect[index]);
+            submitInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.pNext                = nullptr;
+            submitInfo.waitSemaphoreCount   = i == 0 ? pPresentInfo->waitSemaphoreCount : 0;
+            submitInfo.pWaitSemaphores      = i == 0 ? pPresentInfo->pWaitSemaphores : nullptr;
+            submitInfo.pWaitDstStageMask    = i == 0 ? waitStages.data() : nullptr;
+            submitInfo.commandBufferCount   = commandBuffers.size();
+            submitInfo.pCommandBuffers      = commandBuffers.data();
             submitInfo.signalSemaphoreCount = 1;
             submitInfo.pSignalSemaphores    = &(pLogicalSwapchain->semaphores[index]);
 
             presentSemaphores.push_back(pLogicalSwapchain->semaphores[index]);
 
-            VkResult vr = pLogicalDevice->vkd.QueueSubmit(pLogicalDevice->queue, 1, &submitInfo, VK_NULL_HANDLE);
+            pLogicalDevice->vkd.ResetFences(pLogicalDevice->device, 1, &fence);
+            VkResult vr = pLogicalDevice->vkd.QueueSubmit(pLogicalDevice->queue, 1, &submitInfo, fence);
 
             if (vr != VK_SUCCESS)
             {
                 return vr;
             }
+
+            // the outputs of the image exist now, its command buffer gets recorded once more to keep them
+            if (presentEffect && !pLogicalSwapchain->processedImages[index])
+            {
+                pLogicalSwapchain->processedImages[index] = true;
+                if (pLogicalSwapchain->frameComparer || pLogicalSwapchain->damageRadius != UINT32_MAX)
+                {
+                    pLogicalSwapchain->staleCommandBuffers[index] = true;
+                }
+            }
         }
 
         VkPresentInfoKHR presentInfo   = *pPresentInfo;
         presentInfo.waitSemaphoreCount = presentSemaphores.size();
         presentInfo.pWaitSemaphores    = presentSemaphores.data();
 
+        if (!pPresentRegions)
+        {
+            return pLogicalDevice->vkd.QueuePresentKHR(queue, &presentInfo);
+        }
+
+        // the pNext chain belongs to the application, the real present gets a copy of it with the grown regions
+        std::vector<std::vector<uint8_t>> chainStorage;
+        auto                              pPresentRegionsCopy = reinterpret_cast<VkPresentRegionsKHR*>(
+            copyChainUntil(presentInfo.pNext, VK_STRUCTURE_TYPE_PRESENT_REGIONS_KHR, getPresentInfoStructSize, chainStorage));
+        if (pPresentRegionsCopy)
+        {
+            pPresentRegionsCopy->pRegions = outputRegions.data();
+        }
+        else
+        {
+            static bool warned = false;
+            if (!warned)
+            {
+                Logger::err("unknown struct in the pNext chain of the present info, presenting the regions of the application");
+                warned = true;
+            }
+        }
+
         return pLogicalDevice->vkd.QueuePresentKHR(queue, &presentInfo);
     }
 
@@ -652,19 +1660,18 @@ namespace vkBasalt
         scoped_lock l(globalLock);
 
         LogicalDevice* pLogicalDevice = deviceMap[GetKey(device)].get();
-        if (isDepthFormat(pCreateInfo->format) && pCreateInfo->samples == VK_SAMPLE_COUNT_1_BIT
-            && ((pCreateInfo->usage & VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT) == VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT))
+        if (isDepthCandidate(*pCreateInfo))
         {
             Logger::debug("detected depth image with format: " + convertToString(pCreateInfo->format));
             Logger::debug(std::to_string(pCreateInfo->extent.width) + "x" + std::to_string(pCreateInfo->extent.height));
-            Logger::debug(
-                std::to_string((pCreateInfo->usage & VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT) == VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT));
 
             VkImageCreateInfo modifiedCreateInfo = *pCreateInfo;
             modifiedCreateInfo.usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
             VkResult result = pLogicalDevice->vkd.CreateImage(device, &modifiedCreateInfo, pAllocator, pImage);
-            pLogicalDevice->depthImages.push_back(*pImage);
-            pLogicalDevice->depthFormats.push_back(pCreateInfo->format);
+            if (result == VK_SUCCESS)
+            {
+                trackDepthImage(pLogicalDevice, *pImage, *pCreateInfo);
+            }
 
             return result;
         }
@@ -681,99 +1688,49 @@ namespace vkBasalt
         LogicalDevice* pLogicalDevice = deviceMap[GetKey(device)].get();
 
         VkResult result = pLogicalDevice->vkd.BindImageMemory(device, image, memory, memoryOffset);
-        // TODO what if the application creates more than one image before binding memory?
-        if (pLogicalDevice->depthImages.size() && image == pLogicalDevice->depthImages.back())
+        if (result == VK_SUCCESS)
         {
-            Logger::debug("before creating depth image view");
-            VkImageView depthImageView = createImageViews(pLogicalDevice,
-                                                          pLogicalDevice->depthFormats[pLogicalDevice->depthImages.size() - 1],
-                                                          {image},
-                                                          VK_IMAGE_VIEW_TYPE_2D,
-                                                          VK_IMAGE_ASPECT_DEPTH_BIT)[0];
+            bindDepthImage(pLogicalDevice, image);
+        }
+        return result;
+    }
 
-            VkFormat depthFormat = pLogicalDevice->depthFormats[pLogicalDevice->depthImages.size() - 1];
+    VKAPI_ATTR VkResult VKAPI_CALL vkBasalt_BindImageMemory2(VkDevice device, uint32_t bindInfoCount, const VkBindImageMemoryInfo* pBindInfos)
+    {
+        scoped_lock l(globalLock);
 
-            Logger::debug("created depth image view");
-            pLogicalDevice->depthImageViews.push_back(depthImageView);
-            if (pLogicalDevice->depthImageViews.size() > 1)
-            {
-                return result;
-            }
+        LogicalDevice* pLogicalDevice = deviceMap[GetKey(device)].get();
 
-            for (auto& it : swapchainMap)
-            {
-                LogicalSwapchain* pLogicalSwapchain = it.second.get();
-                if (pLogicalSwapchain->pLogicalDevice == pLogicalDevice)
-                {
-                    if (pLogicalSwapchain->commandBuffersEffect.size())
-                    {
-                        pLogicalDevice->vkd.FreeCommandBuffers(pLogicalDevice->device,
-                                                               pLogicalDevice->commandPool,
-                                                               pLogicalSwapchain->commandBuffersEffect.size(),
-                                                               pLogicalSwapchain->commandBuffersEffect.data());
-                        pLogicalSwapchain->commandBuffersEffect.clear();
-                        pLogicalSwapchain->commandBuffersEffect = allocateCommandBuffer(pLogicalDevice, pLogicalSwapchain->imageCount);
-                        Logger::debug("allocated CommandBuffers for swapchain " + convertToString(it.first));
-
-                        writeCommandBuffers(
-                            pLogicalDevice, pLogicalSwapchain->effects, image, depthImageView, depthFormat, pLogicalSwapchain->commandBuffersEffect);
-                        Logger::debug("wrote CommandBuffers");
-                    }
-                }
-            }
+        VkResult result = pLogicalDevice->vkd.BindImageMemory2(device, bindInfoCount, pBindInfos);
+        for (uint32_t i = 0; result == VK_SUCCESS && i < bindInfoCount; i++)
+        {
+            bindDepthImage(pLogicalDevice, pBindInfos[i].image);
         }
         return result;
     }
 
-    VKAPI_ATTR void VKAPI_CALL vkBasalt_DestroyImage(VkDevice device, VkImage image, const VkAllocationCallbacks* pAllocator)
+    VKAPI_ATTR VkResult VKAPI_CALL vkBasalt_BindImageMemory2KHR(VkDevice device, uint32_t bindInfoCount, const VkBindImageMemoryInfo* pBindInfos)
     {
         scoped_lock l(globalLock);
 
         LogicalDevice* pLogicalDevice = deviceMap[GetKey(device)].get();
 
-        for (uint32_t i = 0; i < pLogicalDevice->depthImages.size(); i++)
+        VkResult result = pLogicalDevice->vkd.BindImageMemory2KHR(device, bindInfoCount, pBindInfos);
+        for (uint32_t i = 0; result == VK_SUCCESS && i < bindInfoCount; i++)
         {
-            if (pLogicalDevice->depthImages[i] == image)
-            {
-                pLogicalDevice->depthImages.erase(pLogicalDevice->depthImages.begin() + i);
-                // TODO what if a image gets destroyed before binding memory?
-                if (pLogicalDevice->depthImageViews.size() - 1 >= i)
-                {
-                    pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, pLogicalDevice->depthImageViews[i], nullptr);
-                    pLogicalDevice->depthImageViews.erase(pLogicalDevice->depthImageViews.begin() + i);
-                }
-                pLogicalDevice->depthFormats.erase(pLogicalDevice->depthFormats.begin() + i);
-
-                VkImageView depthImageView = pLogicalDevice->depthImageViews.size() ? pLogicalDevice->depthImageViews[0] : VK_NULL_HANDLE;
-                VkImage     depthImage     = pLogicalDevice->depthImageViews.size() ? pLogicalDevice->depthImages[0] : VK_NULL_HANDLE;
-                VkFormat    depthFormat    = pLogicalDevice->depthImageViews.size() ? pLogicalDevice->depthFormats[0] : VK_FORMAT_UNDEFINED;
-                for (auto& it : swapchainMap)
-                {
-                    LogicalSwapchain* pLogicalSwapchain = it.second.get();
-                    if (pLogicalSwapchain->pLogicalDevice == pLogicalDevice)
-                    {
-                        if (pLogicalSwapchain->commandBuffersEffect.size())
-                        {
-                            pLogicalDevice->vkd.FreeCommandBuffers(pLogicalDevice->device,
-                                                                   pLogicalDevice->commandPool,
-                                                                   pLogicalSwapchain->commandBuffersEffect.size(),
-                                                                   pLogicalSwapchain->commandBuffersEffect.data());
-                            pLogicalSwapchain->commandBuffersEffect.clear();
-                            pLogicalSwapchain->commandBuffersEffect = allocateCommandBuffer(pLogicalDevice, pLogicalSwapchain->imageCount);
-                            Logger::debug("allocated CommandBuffers for swapchain " + convertToString(it.first));
-
-                            writeCommandBuffers(pLogicalDevice,
-                                                pLogicalSwapchain->effects,
-                                                depthImage,
-                                                depthImageView,
-                                                depthFormat,
-                                                pLogicalSwapchain->commandBuffersEffect);
-                            Logger::debug("wrote CommandBuffers");
-                        }
-                    }
-                }
-            }
+            bindDepthImage(pLogicalDevice, pBindInfos[i].image);
         }
+        return result;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL vkBasalt_DestroyImage(VkDevice device, VkImage image, const VkAllocationCallbacks* pAllocator)
+    {
+        scoped_lock l(globalLock);
+
+        LogicalDevice* pLogicalDevice = deviceMap[GetKey(device)].get();
+
+        // the swapchains switch to another depth image at their next present
+        untrackDepthImage(pLogicalDevice, image);
 
         pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, image, pAllocator);
     }
@@ -871,6 +1828,8 @@ extern "C"
     GETPROCADDR(EnumerateInstanceExtensionProperties);                                                                                               \
     GETPROCADDR(CreateInstance);                                                                                                                     \
     GETPROCADDR(DestroyInstance);                                                                                                                    \
+    GETPROCADDR(GetPhysicalDeviceSurfaceCapabilitiesKHR);                                                                                            \
+    GETPROCADDR(GetPhysicalDeviceSurfaceCapabilities2KHR);                                                                                           \
                                                                                                                                                      \
     /* device chain functions we intercept*/                                                                                                         \
     if (!std::strcmp(pName, "vkGetDeviceProcAddr"))                                                                                                  \
@@ -903,8 +1862,22 @@ extern "C"
         INTERCEPT_CALLS
 
         {
-            vkBasalt::scoped_lock l(vkBasalt::globalLock);
-            return vkBasalt::deviceMap[vkBasalt::GetKey(device)]->vkd.GetDeviceProcAddr(device, pName);
+            vkBasalt::scoped_lock    l(vkBasalt::globalLock);
+            vkBasalt::LogicalDevice* pLogicalDevice = vkBasalt::deviceMap[vkBasalt::GetKey(device)].get();
+
+            // unlike the other hooks these depend on what the application enabled
+            if (vkBasalt::pConfig->getOption<std::string>("depthCapture", "off") == "on")
+            {
+                if (pLogicalDevice->supportsBindMemory2)
+                {
+                    GETPROCADDR(BindImageMemory2);
+                }
+                if (pLogicalDevice->supportsBindMemory2KHR)
+                {
+                    GETPROCADDR(BindImageMemory2KHR);
+                }
+            }
+            return pLogicalDevice->vkd.GetDeviceProcAddr(device, pName);
         }
     }
 
@@ -26,12 +26,15 @@ namespace vkBasalt
 
         return commandBuffers;
     }
-    void writeCommandBuffers(LogicalDevice*                                 pLogicalDevice,
-                             std::vector<std::shared_ptr<vkBasalt::Effect>> effects,
-                             VkImage                                        depthImage,
-                             VkImageView                                    depthImageView,
-                             VkFormat                                       depthFormat,
-                             std::vector<VkCommandBuffer>                   commandBuffers)
+    void writeCommandBuffer(LogicalDevice*                                 pLogicalDevice,
+                            std::vector<std::shared_ptr<vkBasalt::Effect>> effects,
+                            uint32_t                                       imageIndex,
+                            VkCommandBuffer                                commandBuffer,
+                            std::vector<std::shared_ptr<vkBasalt::Effect>> copyEffects,
+                            VkBuffer                                       predicateBuffer,
+                            std::vector<bool>                              effectsEnabled,
+                            VkBuffer                                       changedBuffer,
+                            VkDeviceSize                                   changedOffset)
     {
         VkCommandBufferBeginInfo beginInfo = {};
 
@@ -40,74 +43,130 @@ namespace vkBasalt
         beginInfo.flags            = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
         beginInfo.pInheritanceInfo = nullptr;
 
-        for (auto& effect : effects)
+        VkResult result = pLogicalDevice->vkd.BeginCommandBuffer(commandBuffer, &beginInfo);
+        ASSERT_VULKAN(result);
+
+        // barriers, copies and render pass load ops happen either way, the effects have to be recorded to keep their outputs
+        if (changedBuffer != VK_NULL_HANDLE)
+        {
+            VkConditionalRenderingBeginInfoEXT conditionalRenderingBeginInfo;
+            conditionalRenderingBeginInfo.sType  = VK_STRUCTURE_TYPE_CONDITIONAL_RENDERING_BEGIN_INFO_EXT;
+            conditionalRenderingBeginInfo.pNext  = nullptr;
+            conditionalRenderingBeginInfo.buffer = changedBuffer;
+            conditionalRenderingBeginInfo.offset = changedOffset;
+            conditionalRenderingBeginInfo.flags  = 0;
+
+            pLogicalDevice->vkd.CmdBeginConditionalRenderingEXT(commandBuffer, &conditionalRenderingBeginInfo);
+        }
+
+        for (uint32_t j = 0; j < effects.size(); j++)
+        {
+            Logger::debug("before applying effect " + convertToString(effects[j]));
+            if (j >= copyEffects.size())
+            {
+                effects[j]->applyEffect(imageIndex, commandBuffer);
+                continue;
+            }
+            if (predicateBuffer == VK_NULL_HANDLE)
+            {
+                (effectsEnabled[j] ? effects[j] : copyEffects[j])->applyEffect(imageIndex, commandBuffer);
+                continue;
+            }
+
+            // the predicate of the effect decides if the effect or its copy draws, barriers and render pass clears happen either way
+            VkConditionalRenderingBeginInfoEXT conditionalRenderingBeginInfo;
+            conditionalRenderingBeginInfo.sType  = VK_STRUCTURE_TYPE_CONDITIONAL_RENDERING_BEGIN_INFO_EXT;
+            conditionalRenderingBeginInfo.pNext  = nullptr;
+            conditionalRenderingBeginInfo.buffer = predicateBuffer;
+            conditionalRenderingBeginInfo.offset = (imageIndex * copyEffects.size() + j) * sizeof(uint32_t);
+            conditionalRenderingBeginInfo.flags  = 0;
+
+            pLogicalDevice->vkd.CmdBeginConditionalRenderingEXT(commandBuffer, &conditionalRenderingBeginInfo);
+            effects[j]->applyEffect(imageIndex, commandBuffer);
+            pLogicalDevice->vkd.CmdEndConditionalRenderingEXT(commandBuffer);
+
+            conditionalRenderingBeginInfo.flags = VK_CONDITIONAL_RENDERING_INVERTED_BIT_EXT;
+            pLogicalDevice->vkd.CmdBeginConditionalRenderingEXT(commandBuffer, &conditionalRenderingBeginInfo);
+            copyEffects[j]->applyEffect(imageIndex, commandBuffer);
+            pLogicalDevice->vkd.CmdEndConditionalRenderingEXT(commandBuffer);
+        }
+
+        if (changedBuffer != VK_NULL_HANDLE)
         {
-            effect->useDepthImage(depthImageView);
+            pLogicalDevice->vkd.CmdEndConditionalRenderingEXT(commandBuffer);
         }
 
+        result = pLogicalDevice->vkd.EndCommandBuffer(commandBuffer);
+        ASSERT_VULKAN(result);
+    }
+
+    void writeCommandBuffers(LogicalDevice*                                 pLogicalDevice,
+                             std::vector<std::shared_ptr<vkBasalt::Effect>> effects,
+                             std::vector<VkCommandBuffer>                   commandBuffers,
+                             std::vector<std::shared_ptr<vkBasalt::Effect>> copyEffects,
+                             VkBuffer                                       predicateBuffer,
+                             std::vector<bool>                              effectsEnabled)
+    {
         for (uint32_t i = 0; i < commandBuffers.size(); i++)
         {
+            writeCommandBuffer(pLogicalDevice, effects, i, commandBuffers[i], copyEffects, predicateBuffer, effectsEnabled);
+        }
+    }
+
+    std::vector<VkCommandBuffer> writeDepthCommandBuffers(LogicalDevice* pLogicalDevice, VkImage depthImage, VkFormat depthFormat)
+    {
+        std::vector<VkCommandBuffer> commandBuffers = allocateCommandBuffer(pLogicalDevice, 2);
 
+        VkCommandBufferBeginInfo beginInfo = {};
+
+        beginInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.pNext            = nullptr;
+        beginInfo.flags            = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+        beginInfo.pInheritanceInfo = nullptr;
+
+        VkImageMemoryBarrier memoryBarrier;
+        memoryBarrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        memoryBarrier.pNext               = nullptr;
+        memoryBarrier.image               = depthImage;
+        memoryBarrier.oldLayout           = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        memoryBarrier.newLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        memoryBarrier.srcAccessMask       = 0;
+        memoryBarrier.dstAccessMask       = VK_ACCESS_SHADER_READ_BIT;
+        memoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        memoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        memoryBarrier.subresourceRange.aspectMask =
+            isStencilFormat(depthFormat) ? VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT : VK_IMAGE_ASPECT_DEPTH_BIT;
+        memoryBarrier.subresourceRange.baseMipLevel   = 0;
+        memoryBarrier.subresourceRange.levelCount     = 1;
+        memoryBarrier.subresourceRange.baseArrayLayer = 0;
+        memoryBarrier.subresourceRange.layerCount     = 1;
+
+        for (uint32_t i = 0; i < commandBuffers.size(); i++)
+        {
             VkResult result = pLogicalDevice->vkd.BeginCommandBuffer(commandBuffers[i], &beginInfo);
             ASSERT_VULKAN(result);
 
-            VkImageMemoryBarrier memoryBarrier;
-            memoryBarrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-            memoryBarrier.pNext               = nullptr;
-            memoryBarrier.image               = depthImage;
-            memoryBarrier.oldLayout           = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-            memoryBarrier.newLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            memoryBarrier.srcAccessMask       = 0;
-            memoryBarrier.dstAccessMask       = VK_ACCESS_SHADER_READ_BIT;
-            memoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-            memoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-            memoryBarrier.subresourceRange.aspectMask =
-                isStencilFormat(depthFormat) ? VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT : VK_IMAGE_ASPECT_DEPTH_BIT;
-            memoryBarrier.subresourceRange.baseMipLevel   = 0;
-            memoryBarrier.subresourceRange.levelCount     = 1;
-            memoryBarrier.subresourceRange.baseArrayLayer = 0;
-            memoryBarrier.subresourceRange.layerCount     = 1;
-
-            if (depthImageView)
-            {
-                pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffers[i],
-                                                       VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                                                       VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-                                                       0,
-                                                       0,
-                                                       nullptr,
-                                                       0,
-                                                       nullptr,
-                                                       1,
-                                                       &memoryBarrier);
-            }
+            pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffers[i],
+                                                   VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                                   VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                                                   0,
+                                                   0,
+                                                   nullptr,
+                                                   0,
+                                                   nullptr,
+                                                   1,
+                                                   &memoryBarrier);
 
-            for (uint32_t j = 0; j < effects.size(); j++)
-            {
-                Logger::debug("before applying effect " + convertToString(effects[j]));
-                effects[j]->applyEffect(i, commandBuffers[i]);
-            }
+            result = pLogicalDevice->vkd.EndCommandBuffer(commandBuffers[i]);
+            ASSERT_VULKAN(result);
 
+            // the second command buffer gives the image back to the application
             memoryBarrier.oldLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
             memoryBarrier.newLayout     = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
             memoryBarrier.dstAccessMask = 0;
-            if (depthImageView)
-            {
-                pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffers[i],
-                                                       VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                                                       VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-                                                       0,
-                                                       0,
-                                                       nullptr,
-                                                       0,
-                                                       nullptr,
-                                                       1,
-                                                       &memoryBarrier);
-            }
-
-            result = pLogicalDevice->vkd.EndCommandBuffer(commandBuffers[i]);
-            ASSERT_VULKAN(result);
         }
+
+        return commandBuffers;
     }
 
     std::vector<VkSemaphore> createSemaphores(LogicalDevice* pLogicalDevice, uint32_t count)
@@ -125,4 +184,20 @@ namespace vkBasalt
         return semaphores;
     }
 
+    std::vector<VkFence> createFences(LogicalDevice* pLogicalDevice, uint32_t count)
+    {
+        std::vector<VkFence> fences(count);
+        VkFenceCreateInfo    info;
+        info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        info.pNext = nullptr;
+        info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            VkResult result = pLogicalDevice->vkd.CreateFence(pLogicalDevice->device, &info, nullptr, &fences[i]);
+            ASSERT_VULKAN(result);
+        }
+        return fences;
+    }
+
 } // namespace vkBasalt
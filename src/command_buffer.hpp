@@ -17,14 +17,37 @@ namespace vkBasalt
 
     std::vector<VkCommandBuffer> allocateCommandBuffer(LogicalDevice* pLogicalDevice, uint32_t count);
 
+    // copyEffects can stand in for the effects at the same position, effects past the end of copyEffects always run
+    // with a predicate buffer, one uint32_t per effect and swapchain image picks the effect or its copy through conditional rendering,
+    // without one effectsEnabled picks them while recording
     void writeCommandBuffers(LogicalDevice*                                 pLogicalDevice,
                              std::vector<std::shared_ptr<vkBasalt::Effect>> effects,
-                             VkImage                                        depthImage,
-                             VkImageView                                    depthImageView,
-                             VkFormat                                       depthFormat,
-                             std::vector<VkCommandBuffer>                   commandBuffers);
+                             std::vector<VkCommandBuffer>                   commandBuffers,
+                             std::vector<std::shared_ptr<vkBasalt::Effect>> copyEffects     = {},
+                             VkBuffer                                       predicateBuffer = VK_NULL_HANDLE,
+                             std::vector<bool>                              effectsEnabled  = {});
+
+    // records the command buffer of a single swapchain image the same way
+    // with a changed buffer all effects run inside of conditional rendering on the uint32_t at changedOffset,
+    // that cannot be combined with a predicate buffer, because conditional rendering does not nest
+    void writeCommandBuffer(LogicalDevice*                                 pLogicalDevice,
+                            std::vector<std::shared_ptr<vkBasalt::Effect>> effects,
+                            uint32_t                                       imageIndex,
+                            VkCommandBuffer                                commandBuffer,
+                            std::vector<std::shared_ptr<vkBasalt::Effect>> copyEffects     = {},
+                            VkBuffer                                       predicateBuffer = VK_NULL_HANDLE,
+                            std::vector<bool>                              effectsEnabled  = {},
+                            VkBuffer                                       changedBuffer   = VK_NULL_HANDLE,
+                            VkDeviceSize                                   changedOffset   = 0);
+
+    // two command buffers that move the depth image into the shader read only layout and back,
+    // they get submitted around the effect command buffers, so those stay the same whichever depth image the effects read
+    std::vector<VkCommandBuffer> writeDepthCommandBuffers(LogicalDevice* pLogicalDevice, VkImage depthImage, VkFormat depthFormat);
 
     std::vector<VkSemaphore> createSemaphores(LogicalDevice* pLogicalDevice, uint32_t count);
+
+    // the fences start signaled, as if a submission had already finished
+    std::vector<VkFence> createFences(LogicalDevice* pLogicalDevice, uint32_t count);
 } // namespace vkBasalt
 
 #endif // COMMAND_BUFFER_HPP_INCLUDED
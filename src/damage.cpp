@@ -0,0 +1,82 @@
+#include "damage.hpp"
+
+#include <algorithm>
+
+namespace vkBasalt
+{
+    namespace
+    {
+        bool isEmptyRect(VkRect2D rect)
+        {
+            return rect.extent.width == 0 || rect.extent.height == 0;
+        }
+    } // namespace
+
+    VkRect2D uniteDamage(VkRect2D first, VkRect2D second)
+    {
+        if (isEmptyRect(first))
+        {
+            return second;
+        }
+        if (isEmptyRect(second))
+        {
+            return first;
+        }
+        int32_t left   = std::min(first.offset.x, second.offset.x);
+        int32_t top    = std::min(first.offset.y, second.offset.y);
+        int32_t right  = std::max(first.offset.x + (int32_t) first.extent.width, second.offset.x + (int32_t) second.extent.width);
+        int32_t bottom = std::max(first.offset.y + (int32_t) first.extent.height, second.offset.y + (int32_t) second.extent.height);
+        return {{left, top}, {(uint32_t) (right - left), (uint32_t) (bottom - top)}};
+    }
+
+    VkRect2D intersectRects(VkRect2D first, VkRect2D second)
+    {
+        int32_t left   = std::max(first.offset.x, second.offset.x);
+        int32_t top    = std::max(first.offset.y, second.offset.y);
+        int32_t right  = std::min(first.offset.x + (int32_t) first.extent.width, second.offset.x + (int32_t) second.extent.width);
+        int32_t bottom = std::min(first.offset.y + (int32_t) first.extent.height, second.offset.y + (int32_t) second.extent.height);
+        if (right <= left || bottom <= top)
+        {
+            return {{0, 0}, {0, 0}};
+        }
+        return {{left, top}, {(uint32_t) (right - left), (uint32_t) (bottom - top)}};
+    }
+
+    VkRect2D dilateRect(VkRect2D rect, uint32_t radius, VkExtent2D imageExtent)
+    {
+        if (isEmptyRect(rect))
+        {
+            return rect;
+        }
+        // 64 bit, so that large radii do not overflow
+        int64_t left   = std::max<int64_t>((int64_t) rect.offset.x - radius, 0);
+        int64_t top    = std::max<int64_t>((int64_t) rect.offset.y - radius, 0);
+        int64_t right  = std::min<int64_t>((int64_t) rect.offset.x + rect.extent.width + radius, imageExtent.width);
+        int64_t bottom = std::min<int64_t>((int64_t) rect.offset.y + rect.extent.height + radius, imageExtent.height);
+        if (right <= left || bottom <= top)
+        {
+            return {{0, 0}, {0, 0}};
+        }
+        return {{(int32_t) left, (int32_t) top}, {(uint32_t) (right - left), (uint32_t) (bottom - top)}};
+    }
+
+    uint32_t getDamageRadius(const std::vector<std::shared_ptr<Effect>>& effects)
+    {
+        uint64_t radius = 0;
+        for (auto& effect : effects)
+        {
+            radius += effect->getDamageRadius();
+        }
+        return (uint32_t) std::min<uint64_t>(radius, UINT32_MAX);
+    }
+
+    const VkPresentRegionsKHR* findPresentRegions(const VkPresentInfoKHR* pPresentInfo)
+    {
+        const VkBaseInStructure* pStruct = static_cast<const VkBaseInStructure*>(pPresentInfo->pNext);
+        while (pStruct && pStruct->sType != VK_STRUCTURE_TYPE_PRESENT_REGIONS_KHR)
+        {
+            pStruct = pStruct->pNext;
+        }
+        return reinterpret_cast<const VkPresentRegionsKHR*>(pStruct);
+    }
+} // namespace vkBasalt
@@ -0,0 +1,28 @@
+#ifndef DAMAGE_HPP_INCLUDED
+#define DAMAGE_HPP_INCLUDED
+#include <vector>
+#include <memory>
+
+#include "vulkan_include.hpp"
+
+#include "effect.hpp"
+
+namespace vkBasalt
+{
+    // the bounding rectangle of both, empty rectangles do not count
+    VkRect2D uniteDamage(VkRect2D first, VkRect2D second);
+
+    // the overlap of both rectangles, empty if there is none
+    VkRect2D intersectRects(VkRect2D first, VkRect2D second);
+
+    // grows the rectangle by radius on every side and clamps it to the image, empty rectangles stay empty
+    VkRect2D dilateRect(VkRect2D rect, uint32_t radius, VkExtent2D imageExtent);
+
+    // the sum of the damage radii of the effects, UINT32_MAX if one of them can only process the whole image
+    uint32_t getDamageRadius(const std::vector<std::shared_ptr<Effect>>& effects);
+
+    // the VkPresentRegionsKHR of VK_KHR_incremental_present in the pNext chain of the present, nullptr if there is none
+    const VkPresentRegionsKHR* findPresentRegions(const VkPresentInfoKHR* pPresentInfo);
+} // namespace vkBasalt
+
+#endif // DAMAGE_HPP_INCLUDED
@@ -0,0 +1,151 @@
+#include "dds_file.hpp"
+
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+
+#include "logger.hpp"
+
+namespace vkBasalt
+{
+    namespace
+    {
+        constexpr uint32_t makeFourCC(char a, char b, char c, char d)
+        {
+            return uint32_t(uint8_t(a)) | (uint32_t(uint8_t(b)) << 8) | (uint32_t(uint8_t(c)) << 16) | (uint32_t(uint8_t(d)) << 24);
+        }
+
+        constexpr uint32_t ddsMagic       = makeFourCC('D', 'D', 'S', ' ');
+        constexpr uint32_t ddsHeaderSize  = 124;
+        constexpr uint32_t dx10HeaderSize = 20;
+
+        constexpr uint32_t ddsdMipMapCount = 0x00020000;
+        constexpr uint32_t ddpfFourCC      = 0x00000004;
+        constexpr uint32_t ddsCaps2Cubemap = 0x00000200;
+        constexpr uint32_t ddsCaps2Volume  = 0x00200000;
+
+        uint32_t readUint32(const unsigned char* data, uint32_t offset)
+        {
+            uint32_t value;
+            std::memcpy(&value, data + offset, sizeof(value));
+            return value;
+        }
+    } // namespace
+
+    DdsFile::DdsFile(const std::string& file) : filePath(file)
+    {
+        std::ifstream ddsStream(file, std::ios::binary);
+
+        unsigned char header[4 + ddsHeaderSize];
+        if (!ddsStream.read(reinterpret_cast<char*>(header), sizeof(header)) || readUint32(header, 0) != ddsMagic
+            || readUint32(header, 4) != ddsHeaderSize)
+        {
+            return;
+        }
+
+        uint32_t flags       = readUint32(header, 4 + 4);
+        uint32_t pixelFlags  = readUint32(header, 4 + 76);
+        uint32_t fourCC      = readUint32(header, 4 + 80);
+        uint32_t caps2       = readUint32(header, 4 + 108);
+        uint32_t levelsInDds = (flags & ddsdMipMapCount) ? readUint32(header, 4 + 24) : 1;
+
+        if (!(pixelFlags & ddpfFourCC) || (caps2 & (ddsCaps2Cubemap | ddsCaps2Volume)))
+        {
+            return;
+        }
+
+        dataOffset = sizeof(header);
+
+        VkFormat fileFormat;
+        if (fourCC == makeFourCC('D', 'X', '1', '0'))
+        {
+            unsigned char dx10Header[dx10HeaderSize];
+            // only plain 2D textures without array layers
+            if (!ddsStream.read(reinterpret_cast<char*>(dx10Header), sizeof(dx10Header)) || readUint32(dx10Header, 4) != 3
+                || readUint32(dx10Header, 12) > 1)
+            {
+                return;
+            }
+            dataOffset += dx10HeaderSize;
+            fileFormat = convertDxgiFormat(readUint32(dx10Header, 0));
+        }
+        else
+        {
+            fileFormat = convertFourCC(fourCC);
+        }
+
+        width     = readUint32(header, 4 + 12);
+        height    = readUint32(header, 4 + 8);
+        mipLevels = std::max(levelsInDds, 1u);
+        format    = fileFormat;
+    }
+
+    uint32_t DdsFile::getLevelSize(uint32_t level) const
+    {
+        uint32_t blockSize = (format == VK_FORMAT_BC1_RGBA_UNORM_BLOCK || format == VK_FORMAT_BC4_UNORM_BLOCK) ? 8 : 16;
+
+        uint32_t levelWidth  = std::max(width >> level, 1u);
+        uint32_t levelHeight = std::max(height >> level, 1u);
+        return ((levelWidth + 3) / 4) * ((levelHeight + 3) / 4) * blockSize;
+    }
+
+    std::vector<unsigned char> DdsFile::readLevels(uint32_t levelCount) const
+    {
+        uint32_t size = 0;
+        for (uint32_t i = 0; i < levelCount; i++)
+        {
+            size += getLevelSize(i);
+        }
+
+        std::vector<unsigned char> levels(size, 0);
+
+        std::ifstream ddsStream(filePath, std::ios::binary);
+        ddsStream.seekg(dataOffset);
+        if (!ddsStream.read(reinterpret_cast<char*>(levels.data()), size))
+        {
+            Logger::err("dds file is too short: " + filePath);
+        }
+        return levels;
+    }
+
+    VkFormat DdsFile::convertFourCC(uint32_t fourCC)
+    {
+        switch (fourCC)
+        {
+            case makeFourCC('D', 'X', 'T', '1'): return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+            case makeFourCC('D', 'X', 'T', '2'): return VK_FORMAT_BC2_UNORM_BLOCK;
+            case makeFourCC('D', 'X', 'T', '3'): return VK_FORMAT_BC2_UNORM_BLOCK;
+            case makeFourCC('D', 'X', 'T', '4'): return VK_FORMAT_BC3_UNORM_BLOCK;
+            case makeFourCC('D', 'X', 'T', '5'): return VK_FORMAT_BC3_UNORM_BLOCK;
+            case makeFourCC('A', 'T', 'I', '1'): return VK_FORMAT_BC4_UNORM_BLOCK;
+            case makeFourCC('B', 'C', '4', 'U'): return VK_FORMAT_BC4_UNORM_BLOCK;
+            case makeFourCC('A', 'T', 'I', '2'): return VK_FORMAT_BC5_UNORM_BLOCK;
+            case makeFourCC('B', 'C', '5', 'U'): return VK_FORMAT_BC5_UNORM_BLOCK;
+            default: return VK_FORMAT_UNDEFINED;
+        }
+    }
+
+    VkFormat DdsFile::convertDxgiFormat(uint32_t dxgiFormat)
+    {
+        switch (dxgiFormat)
+        {
+            case 71: // DXGI_FORMAT_BC1_UNORM
+            case 72: // DXGI_FORMAT_BC1_UNORM_SRGB
+                return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+            case 74: // DXGI_FORMAT_BC2_UNORM
+            case 75: // DXGI_FORMAT_BC2_UNORM_SRGB
+                return VK_FORMAT_BC2_UNORM_BLOCK;
+            case 77: // DXGI_FORMAT_BC3_UNORM
+            case 78: // DXGI_FORMAT_BC3_UNORM_SRGB
+                return VK_FORMAT_BC3_UNORM_BLOCK;
+            case 80: // DXGI_FORMAT_BC4_UNORM
+                return VK_FORMAT_BC4_UNORM_BLOCK;
+            case 83: // DXGI_FORMAT_BC5_UNORM
+                return VK_FORMAT_BC5_UNORM_BLOCK;
+            case 98: // DXGI_FORMAT_BC7_UNORM
+            case 99: // DXGI_FORMAT_BC7_UNORM_SRGB
+                return VK_FORMAT_BC7_UNORM_BLOCK;
+            default: return VK_FORMAT_UNDEFINED;
+        }
+    }
+} // namespace vkBasalt
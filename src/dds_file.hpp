@@ -0,0 +1,47 @@
+#ifndef DDS_FILE_HPP_INCLUDED
+#define DDS_FILE_HPP_INCLUDED
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "vulkan_include.hpp"
+
+namespace vkBasalt
+{
+    /*
+       reads .dds files that store block compressed (BC1-BC5, BC7) data
+       so that the blocks can be uploaded without decompressing them first
+
+       format will be VK_FORMAT_UNDEFINED if the file is no dds file or does not contain a single block compressed 2D texture,
+       such files still need to be decoded with stbi_dds_load_from_file
+       sRGB formats get reported as their UNORM counterpart, since the sampler decides how the texture gets read
+
+       See: https://docs.microsoft.com/en-us/windows/win32/direct3ddds/dx-graphics-dds-pguide
+    */
+    class DdsFile
+    {
+    public:
+        VkFormat format    = VK_FORMAT_UNDEFINED;
+        uint32_t width     = 0;
+        uint32_t height    = 0;
+        uint32_t mipLevels = 0;
+
+        DdsFile(const std::string& file);
+
+        // returns the size in bytes of the given mip level
+        uint32_t getLevelSize(uint32_t level) const;
+
+        // returns the first levelCount mip levels tightly packed one after another
+        std::vector<unsigned char> readLevels(uint32_t levelCount) const;
+
+    private:
+        std::string filePath;
+        uint32_t    dataOffset = 0;
+
+        VkFormat convertFourCC(uint32_t fourCC);
+        VkFormat convertDxgiFormat(uint32_t dxgiFormat);
+    };
+} // namespace vkBasalt
+
+#endif // DDS_FILE_HPP_INCLUDED
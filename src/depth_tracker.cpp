@@ -0,0 +1,197 @@
+#include "depth_tracker.hpp"
+
+#include <algorithm>
+#include <tuple>
+
+#include "command_buffer.hpp"
+#include "image_view.hpp"
+#include "format.hpp"
+#include "util.hpp"
+
+namespace vkBasalt
+{
+    namespace
+    {
+        DepthTracker* getDepthTracker(LogicalDevice* pLogicalDevice)
+        {
+            if (!pLogicalDevice->depthTracker)
+            {
+                pLogicalDevice->depthTracker = std::make_shared<DepthTracker>();
+            }
+            return pLogicalDevice->depthTracker.get();
+        }
+
+        // higher is better, compared member by member
+        std::tuple<bool, bool, bool, bool, bool, uint64_t, uint64_t> scoreDepthImage(const DepthImage& depthImage, VkExtent2D swapchainExtent)
+        {
+            bool sameExtent = depthImage.extent.width == swapchainExtent.width && depthImage.extent.height == swapchainExtent.height;
+            // render scaling keeps the aspect ratio, shadow maps are mostly square
+            bool sameAspectRatio = (uint64_t) depthImage.extent.width * swapchainExtent.height
+                                   == (uint64_t) depthImage.extent.height * swapchainExtent.width;
+            // cascades and cube maps are arrays, shadow maps always get sampled by the application itself
+            bool singleLayer = depthImage.arrayLayers == 1 && !(depthImage.flags & VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT);
+            bool singleLevel = depthImage.mipLevels == 1;
+            bool notSampled  = !(depthImage.usage & VK_IMAGE_USAGE_SAMPLED_BIT);
+            return {sameExtent,
+                    sameAspectRatio,
+                    singleLayer,
+                    singleLevel,
+                    notSampled,
+                    (uint64_t) depthImage.extent.width * depthImage.extent.height,
+                    depthImage.serial};
+        }
+
+        void destroyDepthImage(LogicalDevice* pLogicalDevice, const DepthImage& depthImage)
+        {
+            if (depthImage.imageView != VK_NULL_HANDLE)
+            {
+                pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, depthImage.imageView, nullptr);
+            }
+            if (!depthImage.commandBuffers.empty())
+            {
+                pLogicalDevice->vkd.FreeCommandBuffers(
+                    pLogicalDevice->device, pLogicalDevice->commandPool, depthImage.commandBuffers.size(), depthImage.commandBuffers.data());
+            }
+        }
+    } // namespace
+
+    bool isDepthCandidate(const VkImageCreateInfo& createInfo)
+    {
+        // transient attachments cannot be sampled
+        return isDepthFormat(createInfo.format) && createInfo.samples == VK_SAMPLE_COUNT_1_BIT && createInfo.imageType == VK_IMAGE_TYPE_2D
+               && (createInfo.usage & VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT) && !(createInfo.usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT);
+    }
+
+    void trackDepthImage(LogicalDevice* pLogicalDevice, VkImage image, const VkImageCreateInfo& createInfo)
+    {
+        DepthTracker* pTracker = getDepthTracker(pLogicalDevice);
+
+        DepthImage depthImage;
+        depthImage.image       = image;
+        depthImage.format      = createInfo.format;
+        depthImage.extent      = createInfo.extent;
+        depthImage.mipLevels   = createInfo.mipLevels;
+        depthImage.arrayLayers = createInfo.arrayLayers;
+        depthImage.flags       = createInfo.flags;
+        depthImage.usage       = createInfo.usage;
+        depthImage.imageView   = VK_NULL_HANDLE;
+        depthImage.serial      = pTracker->nextSerial++;
+        depthImage.users       = 0;
+
+        pTracker->images[image] = depthImage;
+    }
+
+    void bindDepthImage(LogicalDevice* pLogicalDevice, VkImage image)
+    {
+        DepthTracker* pTracker = getDepthTracker(pLogicalDevice);
+
+        auto it = pTracker->images.find(image);
+        if (it == pTracker->images.end() || it->second.imageView != VK_NULL_HANDLE)
+        {
+            return;
+        }
+
+        Logger::debug("before creating depth image view");
+        it->second.imageView = createImageViews(pLogicalDevice, it->second.format, {image}, VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_ASPECT_DEPTH_BIT)[0];
+        Logger::debug("created depth image view");
+
+        pTracker->generation++;
+    }
+
+    void untrackDepthImage(LogicalDevice* pLogicalDevice, VkImage image)
+    {
+        DepthTracker* pTracker = getDepthTracker(pLogicalDevice);
+
+        auto it = pTracker->images.find(image);
+        if (it == pTracker->images.end())
+        {
+            return;
+        }
+
+        // images that never got memory were no candidate yet
+        if (it->second.imageView != VK_NULL_HANDLE)
+        {
+            pTracker->generation++;
+        }
+
+        // the swapchain images switch away when they get presented next, until then their submissions read the view
+        if (it->second.users > 0)
+        {
+            pTracker->retiredImages.push_back(it->second);
+        }
+        else
+        {
+            destroyDepthImage(pLogicalDevice, it->second);
+        }
+        pTracker->images.erase(it);
+    }
+
+    uint64_t getDepthGeneration(LogicalDevice* pLogicalDevice)
+    {
+        return getDepthTracker(pLogicalDevice)->generation;
+    }
+
+    const DepthImage* chooseDepthImage(LogicalDevice* pLogicalDevice, VkExtent2D swapchainExtent)
+    {
+        const DepthImage* pBest = nullptr;
+        for (auto& [image, depthImage] : getDepthTracker(pLogicalDevice)->images)
+        {
+            if (depthImage.imageView == VK_NULL_HANDLE)
+            {
+                continue;
+            }
+            if (!pBest || scoreDepthImage(depthImage, swapchainExtent) > scoreDepthImage(*pBest, swapchainExtent))
+            {
+                pBest = &depthImage;
+            }
+        }
+        return pBest;
+    }
+
+    const DepthImage* retainDepthImage(LogicalDevice* pLogicalDevice, uint64_t serial)
+    {
+        for (auto& [image, depthImage] : getDepthTracker(pLogicalDevice)->images)
+        {
+            if (depthImage.serial != serial)
+            {
+                continue;
+            }
+            if (depthImage.commandBuffers.empty())
+            {
+                depthImage.commandBuffers = writeDepthCommandBuffers(pLogicalDevice, image, depthImage.format);
+            }
+            depthImage.users++;
+            return &depthImage;
+        }
+        return nullptr;
+    }
+
+    void releaseDepthImage(LogicalDevice* pLogicalDevice, uint64_t serial)
+    {
+        if (serial == 0)
+        {
+            return;
+        }
+
+        DepthTracker* pTracker = getDepthTracker(pLogicalDevice);
+
+        for (auto& [image, depthImage] : pTracker->images)
+        {
+            if (depthImage.serial == serial)
+            {
+                depthImage.users--;
+                return;
+            }
+        }
+
+        auto it = std::find_if(pTracker->retiredImages.begin(), pTracker->retiredImages.end(), [serial](const DepthImage& depthImage) {
+            return depthImage.serial == serial;
+        });
+        if (it != pTracker->retiredImages.end() && --it->users == 0)
+        {
+            Logger::debug("destroying retired depth image view");
+            destroyDepthImage(pLogicalDevice, *it);
+            pTracker->retiredImages.erase(it);
+        }
+    }
+} // namespace vkBasalt
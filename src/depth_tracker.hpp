@@ -0,0 +1,70 @@
+#ifndef DEPTH_TRACKER_HPP_INCLUDED
+#define DEPTH_TRACKER_HPP_INCLUDED
+#include <unordered_map>
+#include <vector>
+
+#include "vulkan_include.hpp"
+
+#include "logical_device.hpp"
+
+namespace vkBasalt
+{
+    // a depth attachment that the application created, the view exists once memory is bound
+    struct DepthImage
+    {
+        VkImage                      image;
+        VkFormat                     format;
+        VkExtent3D                   extent;
+        uint32_t                     mipLevels;
+        uint32_t                     arrayLayers;
+        VkImageCreateFlags           flags;
+        VkImageUsageFlags            usage;
+        VkImageView                  imageView;
+        // counts up from 1 with every created image, newer images win ties
+        uint64_t                     serial;
+        // the layout transitions around the effects, recorded the first time the image gets chosen
+        std::vector<VkCommandBuffer> commandBuffers;
+        // the swapchain images whose effects read the image
+        uint32_t                     users;
+    };
+
+    // Every single sample depth attachment of the device, indexed by image so that the create, bind and destroy hooks stay cheap.
+    // The hooks only bump the generation, which image the effects read gets decided once per frame at present time.
+    struct DepthTracker
+    {
+        std::unordered_map<VkImage, DepthImage> images;
+        // untracked images that swapchain images still read, the view and command buffers go once the last one lets go of them
+        std::vector<DepthImage>                 retiredImages;
+        uint64_t                                generation = 0;
+        uint64_t                                nextSerial = 1;
+    };
+
+    // returns true if the image is a depth attachment worth tracking
+    bool isDepthCandidate(const VkImageCreateInfo& createInfo);
+
+    void trackDepthImage(LogicalDevice* pLogicalDevice, VkImage image, const VkImageCreateInfo& createInfo);
+
+    // creates the view of a tracked image
+    void bindDepthImage(LogicalDevice* pLogicalDevice, VkImage image);
+
+    // forgets a tracked image, its view and command buffers get destroyed once no swapchain uses them anymore
+    void untrackDepthImage(LogicalDevice* pLogicalDevice, VkImage image);
+
+    // changes whenever the set of candidates changes
+    uint64_t getDepthGeneration(LogicalDevice* pLogicalDevice);
+
+    // the bound candidate that most likely is the main depth buffer for a swapchain of the given extent, nullptr if there is none
+    // images with the extent of the swapchain come first, then images with its aspect ratio,
+    // single layer and single level images before arrays and mip chains, images the application does not sample itself
+    // and finally the larger and newer image
+    const DepthImage* chooseDepthImage(LogicalDevice* pLogicalDevice, VkExtent2D swapchainExtent);
+
+    // counts a swapchain image as user of the bound candidate with the serial and records its command buffers, nullptr for serial 0
+    // the view and the command buffers to submit before and after the effects stay valid until the swapchain image releases it
+    const DepthImage* retainDepthImage(LogicalDevice* pLogicalDevice, uint64_t serial);
+
+    // the swapchain image does not use the image anymore and all its submissions that did have finished, nothing happens for serial 0
+    void releaseDepthImage(LogicalDevice* pLogicalDevice, uint64_t serial);
+} // namespace vkBasalt
+
+#endif // DEPTH_TRACKER_HPP_INCLUDED
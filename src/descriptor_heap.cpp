@@ -0,0 +1,166 @@
+#include "descriptor_heap.hpp"
+
+#include <algorithm>
+#include <climits>
+
+#include "util.hpp"
+
+namespace vkBasalt
+{
+    DescriptorHeap* getDescriptorHeap(LogicalDevice* pLogicalDevice)
+    {
+        if (!pLogicalDevice->supportsDescriptorIndexing)
+        {
+            return nullptr;
+        }
+        if (pLogicalDevice->descriptorHeap)
+        {
+            return pLogicalDevice->descriptorHeap.get();
+        }
+
+        VkPhysicalDeviceDescriptorIndexingPropertiesEXT indexingProperties = {};
+        indexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+
+        VkPhysicalDeviceProperties2 properties2 = {};
+        properties2.sType                       = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        properties2.pNext                       = &indexingProperties;
+        pLogicalDevice->vki.GetPhysicalDeviceProperties2(pLogicalDevice->physicalDevice, &properties2);
+
+        // a few thousand slots are plenty for every effect of every swapchain, the limits are far higher on most drivers
+        std::shared_ptr<DescriptorHeap> pHeap(new DescriptorHeap());
+        pHeap->capacity             = std::min({4096u,
+                                    indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers,
+                                    indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                                    indexingProperties.maxPerStageUpdateAfterBindResources,
+                                    indexingProperties.maxDescriptorSetUpdateAfterBindSamplers,
+                                    indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages});
+        pHeap->maxPushConstantsSize = properties2.properties.limits.maxPushConstantsSize;
+        Logger::debug("descriptor heap capacity: " + std::to_string(pHeap->capacity));
+
+        VkDescriptorBindingFlagsEXT bindingFlags = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT
+                                                   | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT
+                                                   | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT;
+
+        VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsCreateInfo;
+        bindingFlagsCreateInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+        bindingFlagsCreateInfo.pNext         = nullptr;
+        bindingFlagsCreateInfo.bindingCount  = 1;
+        bindingFlagsCreateInfo.pBindingFlags = &bindingFlags;
+
+        VkDescriptorSetLayoutBinding descriptorSetLayoutBinding;
+        descriptorSetLayoutBinding.binding            = 0;
+        descriptorSetLayoutBinding.descriptorType     = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptorSetLayoutBinding.descriptorCount    = pHeap->capacity;
+        descriptorSetLayoutBinding.stageFlags         = VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_VERTEX_BIT;
+        descriptorSetLayoutBinding.pImmutableSamplers = nullptr;
+
+        VkDescriptorSetLayoutCreateInfo descriptorSetCreateInfo;
+        descriptorSetCreateInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        descriptorSetCreateInfo.pNext        = &bindingFlagsCreateInfo;
+        descriptorSetCreateInfo.flags        = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+        descriptorSetCreateInfo.bindingCount = 1;
+        descriptorSetCreateInfo.pBindings    = &descriptorSetLayoutBinding;
+
+        VkResult result = pLogicalDevice->vkd.CreateDescriptorSetLayout(pLogicalDevice->device, &descriptorSetCreateInfo, nullptr, &pHeap->layout);
+        ASSERT_VULKAN(result);
+
+        VkDescriptorPoolSize poolSize;
+        poolSize.type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        poolSize.descriptorCount = pHeap->capacity;
+
+        VkDescriptorPoolCreateInfo descriptorPoolCreateInfo;
+        descriptorPoolCreateInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        descriptorPoolCreateInfo.pNext         = nullptr;
+        descriptorPoolCreateInfo.flags         = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+        descriptorPoolCreateInfo.maxSets       = 1;
+        descriptorPoolCreateInfo.poolSizeCount = 1;
+        descriptorPoolCreateInfo.pPoolSizes    = &poolSize;
+
+        result = pLogicalDevice->vkd.CreateDescriptorPool(pLogicalDevice->device, &descriptorPoolCreateInfo, nullptr, &pHeap->pool);
+        ASSERT_VULKAN(result);
+
+        VkDescriptorSetAllocateInfo descriptorSetAllocateInfo;
+        descriptorSetAllocateInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        descriptorSetAllocateInfo.pNext              = nullptr;
+        descriptorSetAllocateInfo.descriptorPool     = pHeap->pool;
+        descriptorSetAllocateInfo.descriptorSetCount = 1;
+        descriptorSetAllocateInfo.pSetLayouts        = &pHeap->layout;
+
+        result = pLogicalDevice->vkd.AllocateDescriptorSets(pLogicalDevice->device, &descriptorSetAllocateInfo, &pHeap->set);
+        ASSERT_VULKAN(result);
+
+        // hand out the low slots first
+        for (uint32_t i = pHeap->capacity; i > 0; i--)
+        {
+            pHeap->freeSlots.push_back(i - 1);
+        }
+
+        pLogicalDevice->descriptorHeap = pHeap;
+        return pHeap.get();
+    }
+
+    uint32_t allocateDescriptorSlot(LogicalDevice* pLogicalDevice, VkSampler sampler, VkImageView imageView)
+    {
+        DescriptorHeap* pHeap = getDescriptorHeap(pLogicalDevice);
+        if (!pHeap || pHeap->freeSlots.empty())
+        {
+            Logger::err("descriptor heap is full");
+            return UINT32_MAX;
+        }
+
+        uint32_t slot = pHeap->freeSlots.back();
+        pHeap->freeSlots.pop_back();
+
+        writeDescriptorSlots(pLogicalDevice, {slot}, {sampler}, {imageView});
+
+        return slot;
+    }
+
+    void writeDescriptorSlots(LogicalDevice*                  pLogicalDevice,
+                              const std::vector<uint32_t>&    slots,
+                              const std::vector<VkSampler>&   samplers,
+                              const std::vector<VkImageView>& imageViews)
+    {
+        std::vector<VkDescriptorImageInfo> imageInfos(slots.size());
+        std::vector<VkWriteDescriptorSet>  writeDescriptorSets(slots.size());
+        for (size_t i = 0; i < slots.size(); i++)
+        {
+            imageInfos[i].sampler     = samplers[i];
+            imageInfos[i].imageView   = imageViews[i];
+            imageInfos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+            writeDescriptorSets[i].sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writeDescriptorSets[i].pNext            = nullptr;
+            writeDescriptorSets[i].dstSet           = pLogicalDevice->descriptorHeap->set;
+            writeDescriptorSets[i].dstBinding       = 0;
+            writeDescriptorSets[i].dstArrayElement  = slots[i];
+            writeDescriptorSets[i].descriptorCount  = 1;
+            writeDescriptorSets[i].descriptorType   = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            writeDescriptorSets[i].pImageInfo       = &imageInfos[i];
+            writeDescriptorSets[i].pBufferInfo      = nullptr;
+            writeDescriptorSets[i].pTexelBufferView = nullptr;
+        }
+
+        pLogicalDevice->vkd.UpdateDescriptorSets(pLogicalDevice->device, writeDescriptorSets.size(), writeDescriptorSets.data(), 0, nullptr);
+    }
+
+    void freeDescriptorSlot(LogicalDevice* pLogicalDevice, uint32_t slot)
+    {
+        if (pLogicalDevice->descriptorHeap && slot != UINT32_MAX)
+        {
+            pLogicalDevice->descriptorHeap->freeSlots.push_back(slot);
+        }
+    }
+
+    void destroyDescriptorHeap(LogicalDevice* pLogicalDevice)
+    {
+        if (!pLogicalDevice->descriptorHeap)
+        {
+            return;
+        }
+        // the set goes with the pool
+        pLogicalDevice->vkd.DestroyDescriptorPool(pLogicalDevice->device, pLogicalDevice->descriptorHeap->pool, nullptr);
+        pLogicalDevice->vkd.DestroyDescriptorSetLayout(pLogicalDevice->device, pLogicalDevice->descriptorHeap->layout, nullptr);
+        pLogicalDevice->descriptorHeap.reset();
+    }
+} // namespace vkBasalt
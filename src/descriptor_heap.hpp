@@ -0,0 +1,46 @@
+#ifndef DESCRIPTOR_HEAP_HPP_INCLUDED
+#define DESCRIPTOR_HEAP_HPP_INCLUDED
+#include <vector>
+#include <memory>
+
+#include "vulkan_include.hpp"
+
+#include "logical_device.hpp"
+
+namespace vkBasalt
+{
+    // One descriptor set per device with a single array of combined image samplers.
+    // Effects write their images into slots of the array and tell their shaders the slot of every sampler through push constants,
+    // so that switching the image behind a sampler is a new slot index instead of a new descriptor set.
+    // The array is update after bind and partially bound, so slots can be written while other slots are in use.
+    struct DescriptorHeap
+    {
+        VkDescriptorSetLayout layout;
+        VkDescriptorPool      pool;
+        VkDescriptorSet       set;
+        uint32_t              capacity;
+        // the largest push constant block, it limits how many samplers an effect can index
+        uint32_t              maxPushConstantsSize;
+        std::vector<uint32_t> freeSlots;
+    };
+
+    // creates the heap on first use, returns nullptr if the device does not support descriptor indexing
+    DescriptorHeap* getDescriptorHeap(LogicalDevice* pLogicalDevice);
+
+    // returns a slot that shows the image view through the sampler, or UINT32_MAX if the heap is full
+    uint32_t allocateDescriptorSlot(LogicalDevice* pLogicalDevice, VkSampler sampler, VkImageView imageView);
+
+    // points already allocated slots at other image views in a single update, none of the slots may be in use by a pending command buffer
+    void writeDescriptorSlots(LogicalDevice*                  pLogicalDevice,
+                              const std::vector<uint32_t>&    slots,
+                              const std::vector<VkSampler>&   samplers,
+                              const std::vector<VkImageView>& imageViews);
+
+    // the slot must not be in use by a pending command buffer
+    void freeDescriptorSlot(LogicalDevice* pLogicalDevice, uint32_t slot);
+
+    // only to be called when the device gets destroyed
+    void destroyDescriptorHeap(LogicalDevice* pLogicalDevice);
+} // namespace vkBasalt
+
+#endif // DESCRIPTOR_HEAP_HPP_INCLUDED
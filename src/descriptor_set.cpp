@@ -1,5 +1,7 @@
 #include "descriptor_set.hpp"
 
+#include "object_cache.hpp"
+
 namespace vkBasalt
 {
 
@@ -27,8 +29,6 @@ namespace vkBasalt
 
     VkDescriptorSetLayout createUniformBufferDescriptorSetLayout(LogicalDevice* pLogicalDevice)
     {
-        VkDescriptorSetLayout descriptorSetLayout;
-
         VkDescriptorSetLayoutBinding descriptorSetLayoutBinding;
         descriptorSetLayoutBinding.binding            = 0;
         descriptorSetLayoutBinding.descriptorType     = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
@@ -43,11 +43,7 @@ namespace vkBasalt
         descriptorSetCreateInfo.bindingCount = 1;
         descriptorSetCreateInfo.pBindings    = &descriptorSetLayoutBinding;
 
-        VkResult result =
-            pLogicalDevice->vkd.CreateDescriptorSetLayout(pLogicalDevice->device, &descriptorSetCreateInfo, nullptr, &descriptorSetLayout);
-        ASSERT_VULKAN(result)
-
-        return descriptorSetLayout;
+        return getCachedDescriptorSetLayout(pLogicalDevice, descriptorSetCreateInfo);
     }
 
     VkDescriptorSet writeBufferDescriptorSet(LogicalDevice*        pLogicalDevice,
@@ -93,8 +89,6 @@ namespace vkBasalt
 
     VkDescriptorSetLayout createImageSamplerDescriptorSetLayout(LogicalDevice* pLogicalDevice, uint32_t count)
     {
-        VkDescriptorSetLayout descriptorSetLayout;
-
         std::vector<VkDescriptorSetLayoutBinding> bindigs(count);
         for (uint32_t i = 0; i < count; i++)
         {
@@ -114,10 +108,31 @@ namespace vkBasalt
         descriptorSetCreateInfo.bindingCount = count;
         descriptorSetCreateInfo.pBindings    = bindigs.data();
 
-        VkResult result =
-            pLogicalDevice->vkd.CreateDescriptorSetLayout(pLogicalDevice->device, &descriptorSetCreateInfo, nullptr, &descriptorSetLayout);
-        ASSERT_VULKAN(result)
-        return descriptorSetLayout;
+        return getCachedDescriptorSetLayout(pLogicalDevice, descriptorSetCreateInfo);
+    }
+
+    VkDescriptorSetLayout createImageSamplerUniformDescriptorSetLayout(LogicalDevice* pLogicalDevice)
+    {
+        VkDescriptorSetLayoutBinding descriptorSetLayoutBindings[2];
+        descriptorSetLayoutBindings[0].binding            = 0;
+        descriptorSetLayoutBindings[0].descriptorType     = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptorSetLayoutBindings[0].descriptorCount    = 1;
+        descriptorSetLayoutBindings[0].stageFlags         = VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_VERTEX_BIT;
+        descriptorSetLayoutBindings[0].pImmutableSamplers = nullptr;
+        descriptorSetLayoutBindings[1].binding            = 1;
+        descriptorSetLayoutBindings[1].descriptorType     = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        descriptorSetLayoutBindings[1].descriptorCount    = 1;
+        descriptorSetLayoutBindings[1].stageFlags         = VK_SHADER_STAGE_VERTEX_BIT;
+        descriptorSetLayoutBindings[1].pImmutableSamplers = nullptr;
+
+        VkDescriptorSetLayoutCreateInfo descriptorSetCreateInfo;
+        descriptorSetCreateInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        descriptorSetCreateInfo.pNext        = nullptr;
+        descriptorSetCreateInfo.flags        = 0;
+        descriptorSetCreateInfo.bindingCount = 2;
+        descriptorSetCreateInfo.pBindings    = descriptorSetLayoutBindings;
+
+        return getCachedDescriptorSetLayout(pLogicalDevice, descriptorSetCreateInfo);
     }
 
     std::vector<VkDescriptorSet> allocateAndWriteImageSamplerDescriptorSets(LogicalDevice*                        pLogicalDevice,
@@ -15,6 +15,7 @@ namespace vkBasalt
 {
     VkDescriptorPool createDescriptorPool(LogicalDevice* pLogicalDevice, const std::vector<VkDescriptorPoolSize>& poolSizes);
 
+    // the layouts are shared through the object cache of the device, release them with releaseCachedObject
     VkDescriptorSetLayout createUniformBufferDescriptorSetLayout(LogicalDevice* pLogicalDevice);
 
     VkDescriptorSet writeBufferDescriptorSet(LogicalDevice*        pLogicalDevice,
@@ -24,6 +25,9 @@ namespace vkBasalt
 
     VkDescriptorSetLayout createImageSamplerDescriptorSetLayout(LogicalDevice* pLogicalDevice, uint32_t count);
 
+    // a combined image sampler at binding 0 and a uniform buffer for the vertex stage at binding 1
+    VkDescriptorSetLayout createImageSamplerUniformDescriptorSetLayout(LogicalDevice* pLogicalDevice);
+
     std::vector<VkDescriptorSet> allocateAndWriteImageSamplerDescriptorSets(LogicalDevice*                        pLogicalDevice,
                                                                             VkDescriptorPool                      descriptorPool,
                                                                             VkDescriptorSetLayout                 descriptorSetLayout,
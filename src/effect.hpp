@@ -15,8 +15,29 @@ namespace vkBasalt
     {
     public:
         void virtual applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer) = 0;
-        void virtual updateEffect(){};
-        void virtual useDepthImage(VkImageView depthImageView){};
+        // called before every submission of the command buffer of the swapchain image, once the last one for the image finished
+        void virtual updateEffect(uint32_t imageIndex){};
+        // the effect reads the depth image for the swapchain image from now on, the last submission for that image has finished
+        void virtual useDepthImage(uint32_t imageIndex, VkImageView depthImageView){};
+        // false if useDepthImage changes descriptors that the recorded command buffer of the image uses, it has to be recorded again then
+        bool virtual rebindsDepthImageInPlace() { return true; };
+        // only the pixels inside the rectangle get processed, the rest of the output gets cleared to black, see effect_border.hpp
+        // takes effect the next time the command buffers get recorded
+        void virtual setContentRect(VkRect2D contentRect){};
+        // how far around an output pixel the effect reads its input, UINT32_MAX if it can only process the whole image
+        uint32_t virtual getDamageRadius() { return UINT32_MAX; };
+        // only the pixels of the swapchain image inside the rectangle get processed, an empty rectangle processes none,
+        // it is data the recorded command buffer reads, so it takes effect with the next submission of the image
+        // and may only change once the last one has finished, the rest of the output only survives with setKeepOutput
+        void virtual setDamageRect(uint32_t imageIndex, VkRect2D damageRect){};
+        // true if the output keeps its content when conditional rendering skips the effect in a recording that keeps the output
+        bool virtual isSkippable() { return false; };
+        // the output keeps what it had the last time for the image where the effect does not write it, only valid once it got written
+        // takes effect the next time the command buffers get recorded
+        void virtual setKeepOutput(bool keepOutput){};
+        // renders with the shading rate image, so that up to maxShadingRate x maxShadingRate pixels share a fragment in flat tiles
+        // false if the effect cannot, takes effect the next time the command buffers get recorded
+        bool virtual useShadingRateImage(VkImageView shadingRateImageView, uint32_t maxShadingRate) { return false; };
         virtual ~Effect(){};
 
     private:
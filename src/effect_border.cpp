@@ -0,0 +1,121 @@
+#include "effect_border.hpp"
+
+#include "letterbox.hpp"
+
+namespace vkBasalt
+{
+    BorderEffect::BorderEffect(LogicalDevice*       pLogicalDevice,
+                               VkFormat             format,
+                               VkExtent2D           imageExtent,
+                               std::vector<VkImage> inputImages,
+                               std::vector<VkImage> outputImages,
+                               Config*              pConfig)
+    {
+        this->pLogicalDevice = pLogicalDevice;
+        this->format         = format;
+        this->imageExtent    = imageExtent;
+        this->inputImages    = inputImages;
+        this->outputImages   = outputImages;
+        this->pConfig        = pConfig;
+        this->contentRect    = {{0, 0}, imageExtent};
+    }
+
+    void BorderEffect::applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer)
+    {
+        std::vector<VkImageCopy> imageCopies;
+        for (auto& borderRect : getBorderRects(imageExtent, contentRect))
+        {
+            if (borderRect.extent.width == 0 || borderRect.extent.height == 0)
+            {
+                continue;
+            }
+            VkImageCopy imageCopy;
+            imageCopy.srcSubresource            = {};
+            imageCopy.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            imageCopy.srcSubresource.layerCount = 1;
+            imageCopy.srcOffset                 = {borderRect.offset.x, borderRect.offset.y, 0};
+            imageCopy.dstSubresource            = imageCopy.srcSubresource;
+            imageCopy.dstOffset                 = imageCopy.srcOffset;
+            imageCopy.extent                    = {borderRect.extent.width, borderRect.extent.height, 1};
+            imageCopies.push_back(imageCopy);
+        }
+        if (imageCopies.empty())
+        {
+            return;
+        }
+
+        // the effects in front of it wrote the output and read the input
+        VkImageMemoryBarrier memoryBarrier;
+        memoryBarrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        memoryBarrier.pNext               = nullptr;
+        memoryBarrier.srcAccessMask       = 0;
+        memoryBarrier.dstAccessMask       = VK_ACCESS_TRANSFER_READ_BIT;
+        memoryBarrier.oldLayout           = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        memoryBarrier.newLayout           = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        memoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        memoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        memoryBarrier.image               = inputImages[imageIndex];
+
+        memoryBarrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        memoryBarrier.subresourceRange.baseMipLevel   = 0;
+        memoryBarrier.subresourceRange.levelCount     = 1;
+        memoryBarrier.subresourceRange.baseArrayLayer = 0;
+        memoryBarrier.subresourceRange.layerCount     = 1;
+
+        pLogicalDevice->vkd.CmdPipelineBarrier(
+            commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarrier);
+
+        // the inside of the output has to stay, so the layout gets kept
+        memoryBarrier.image         = outputImages[imageIndex];
+        memoryBarrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+        memoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        memoryBarrier.newLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        pLogicalDevice->vkd.CmdPipelineBarrier(
+            commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarrier);
+
+        pLogicalDevice->vkd.CmdCopyImage(commandBuffer,
+                                         inputImages[imageIndex],
+                                         VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                         outputImages[imageIndex],
+                                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                         imageCopies.size(),
+                                         imageCopies.data());
+
+        memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        memoryBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+        memoryBarrier.image         = outputImages[imageIndex];
+        memoryBarrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        memoryBarrier.newLayout     = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        pLogicalDevice->vkd.CmdPipelineBarrier(
+            commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarrier);
+
+        memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        memoryBarrier.dstAccessMask = 0;
+        memoryBarrier.image         = inputImages[imageIndex];
+        memoryBarrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        memoryBarrier.newLayout     = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        pLogicalDevice->vkd.CmdPipelineBarrier(
+            commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarrier);
+    }
+
+    void BorderEffect::setContentRect(VkRect2D contentRect)
+    {
+        this->contentRect = contentRect;
+    }
+
+    uint32_t BorderEffect::getDamageRadius()
+    {
+        return 0;
+    }
+
+    bool BorderEffect::isSkippable()
+    {
+        // skipped effects in front of it leave its input as it was the last time, so copying it again changes nothing
+        return true;
+    }
+
+    BorderEffect::~BorderEffect()
+    {
+    }
+
+} // namespace vkBasalt
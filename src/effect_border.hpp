@@ -0,0 +1,47 @@
+#ifndef EFFECT_BORDER_HPP_INCLUDED
+#define EFFECT_BORDER_HPP_INCLUDED
+#include <vector>
+#include <fstream>
+#include <string>
+#include <iostream>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+
+#include "vulkan_include.hpp"
+
+#include "effect.hpp"
+#include "config.hpp"
+
+#include "logical_device.hpp"
+
+namespace vkBasalt
+{
+    // Copies the parts of the images of the application outside of the content rectangle into the output of the effects,
+    // so that content in the borders shows up unprocessed instead of black, even before the letterbox detector notices it.
+    class BorderEffect : public Effect
+    {
+    public:
+        BorderEffect(LogicalDevice*       pLogicalDevice,
+                     VkFormat             format,
+                     VkExtent2D           imageExtent,
+                     std::vector<VkImage> inputImages,
+                     std::vector<VkImage> outputImages,
+                     Config*              pConfig);
+        void virtual applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer) override;
+        void virtual setContentRect(VkRect2D contentRect) override;
+        uint32_t virtual getDamageRadius() override;
+        bool virtual isSkippable() override;
+        virtual ~BorderEffect();
+
+    private:
+        LogicalDevice*       pLogicalDevice;
+        std::vector<VkImage> inputImages;
+        std::vector<VkImage> outputImages;
+        VkExtent2D           imageExtent;
+        VkFormat             format;
+        VkRect2D             contentRect;
+        Config*              pConfig;
+    };
+} // namespace vkBasalt
+#endif // EFFECT_BORDER_HPP_INCLUDED
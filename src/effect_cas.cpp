@@ -25,7 +25,7 @@ namespace vkBasalt
 
         float sharpness = pConfig->getOption<float>("casSharpness", 0.4f);
 
-        vertexCode   = full_screen_triangle_vert;
+        vertexCode   = damage_rect_vert;
         fragmentCode = cas_frag;
 
         VkSpecializationMapEntry sharpnessMapEntry;
@@ -44,6 +44,11 @@ namespace vkBasalt
 
         init(pLogicalDevice, format, imageExtent, inputImages, outputImages, pConfig);
     }
+    uint32_t CasEffect::getDamageRadius()
+    {
+        // the 3x3 neighbourhood
+        return 1;
+    }
     CasEffect::~CasEffect()
     {
     }
@@ -24,6 +24,7 @@ namespace vkBasalt
                   std::vector<VkImage> inputImages,
                   std::vector<VkImage> outputImages,
                   Config*              pConfig);
+        uint32_t virtual getDamageRadius() override;
         ~CasEffect();
     };
 } // namespace vkBasalt
@@ -0,0 +1,30 @@
+#include "effect_copy.hpp"
+
+#include "shader_sources.hpp"
+
+namespace vkBasalt
+{
+    CopyEffect::CopyEffect(LogicalDevice*       pLogicalDevice,
+                           VkFormat             format,
+                           VkExtent2D           imageExtent,
+                           std::vector<VkImage> inputImages,
+                           std::vector<VkImage> outputImages,
+                           Config*              pConfig)
+    {
+        // unlike the TransferEffect this is a draw, so conditional rendering can skip it
+        vertexCode   = damage_rect_vert;
+        fragmentCode = copy_frag;
+
+        pVertexSpecInfo   = nullptr;
+        pFragmentSpecInfo = nullptr;
+
+        init(pLogicalDevice, format, imageExtent, inputImages, outputImages, pConfig);
+    }
+    uint32_t CopyEffect::getDamageRadius()
+    {
+        return 0;
+    }
+    CopyEffect::~CopyEffect()
+    {
+    }
+} // namespace vkBasalt
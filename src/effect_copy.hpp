@@ -0,0 +1,32 @@
+#ifndef EFFECT_COPY_HPP_INCLUDED
+#define EFFECT_COPY_HPP_INCLUDED
+#include <vector>
+#include <fstream>
+#include <string>
+#include <iostream>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+
+#include "vulkan_include.hpp"
+
+#include "effect_simple.hpp"
+#include "config.hpp"
+
+namespace vkBasalt
+{
+    class CopyEffect : public SimpleEffect
+    {
+    public:
+        CopyEffect(LogicalDevice*       pLogicalDevice,
+                   VkFormat             format,
+                   VkExtent2D           imageExtent,
+                   std::vector<VkImage> inputImages,
+                   std::vector<VkImage> outputImages,
+                   Config*              pConfig);
+        uint32_t virtual getDamageRadius() override;
+        ~CopyEffect();
+    };
+} // namespace vkBasalt
+
+#endif // EFFECT_COPY_HPP_INCLUDED
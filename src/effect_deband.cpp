@@ -1,6 +1,8 @@
 #include "effect_deband.hpp"
 
 #include <cstring>
+#include <cmath>
+#include <algorithm>
 
 #include "image_view.hpp"
 #include "descriptor_set.hpp"
@@ -22,7 +24,7 @@ namespace vkBasalt
                                std::vector<VkImage> outputImages,
                                Config*              pConfig)
     {
-        vertexCode   = full_screen_triangle_vert;
+        vertexCode   = damage_rect_vert;
         fragmentCode = deband_frag;
 
         struct
@@ -50,6 +52,9 @@ namespace vkBasalt
         debandOptions.range         = pConfig->getOption<float>("debandRange", 16.0f);
         debandOptions.iterations    = pConfig->getOption<int32_t>("debandIterations", 4);
 
+        // the reference pixels lie up to range times iterations pixels away, one more for the bilinear filter
+        damageRadius = (uint32_t) std::ceil(std::max(debandOptions.range, 0.0f) * std::max(debandOptions.iterations, 0)) + 1;
+
         std::vector<VkSpecializationMapEntry> specMapEntrys(9);
         for (uint32_t i = 0; i < specMapEntrys.size(); i++)
         {
@@ -69,6 +74,10 @@ namespace vkBasalt
 
         init(pLogicalDevice, format, imageExtent, inputImages, outputImages, pConfig);
     }
+    uint32_t DebandEffect::getDamageRadius()
+    {
+        return damageRadius;
+    }
     DebandEffect::~DebandEffect()
     {
     }
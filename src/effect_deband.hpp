@@ -24,7 +24,11 @@ namespace vkBasalt
                      std::vector<VkImage> inputImages,
                      std::vector<VkImage> outputImages,
                      Config*              pConfig);
+        uint32_t virtual getDamageRadius() override;
         ~DebandEffect();
+
+    private:
+        uint32_t damageRadius;
     };
 } // namespace vkBasalt
 
@@ -27,7 +27,7 @@ namespace vkBasalt
 
         float specData[2] = {sharpness, denoise};
 
-        vertexCode   = full_screen_triangle_vert;
+        vertexCode   = damage_rect_vert;
         fragmentCode = dls_frag;
 
         VkSpecializationMapEntry mapEntries[2];
@@ -49,6 +49,11 @@ namespace vkBasalt
 
         init(pLogicalDevice, format, imageExtent, inputImages, outputImages, pConfig);
     }
+    uint32_t DlsEffect::getDamageRadius()
+    {
+        // the 3x3 neighbourhood
+        return 1;
+    }
     DlsEffect::~DlsEffect()
     {
     }
@@ -0,0 +1,49 @@
+#include "effect_easu.hpp"
+
+#include "shader_sources.hpp"
+
+namespace vkBasalt
+{
+    EasuEffect::EasuEffect(LogicalDevice*       pLogicalDevice,
+                           VkFormat             format,
+                           VkExtent2D           imageExtent,
+                           std::vector<VkImage> inputImages,
+                           std::vector<VkImage> outputImages,
+                           Config*              pConfig)
+    {
+        vertexCode   = damage_rect_vert;
+        fragmentCode = easu_frag;
+
+        // imageExtent is the size of the output, the shader gets the size of the input from the image itself
+        struct
+        {
+            float outputWidth;
+            float outputHeight;
+        } easuOptions{};
+
+        easuOptions.outputWidth  = (float) imageExtent.width;
+        easuOptions.outputHeight = (float) imageExtent.height;
+
+        std::vector<VkSpecializationMapEntry> specMapEntrys(2);
+        for (uint32_t i = 0; i < specMapEntrys.size(); i++)
+        {
+            specMapEntrys[i].constantID = i;
+            specMapEntrys[i].offset     = sizeof(float) * i;
+            specMapEntrys[i].size       = sizeof(float);
+        }
+
+        VkSpecializationInfo specializationInfo;
+        specializationInfo.mapEntryCount = specMapEntrys.size();
+        specializationInfo.pMapEntries   = specMapEntrys.data();
+        specializationInfo.dataSize      = sizeof(easuOptions);
+        specializationInfo.pData         = &easuOptions;
+
+        pVertexSpecInfo   = nullptr;
+        pFragmentSpecInfo = &specializationInfo;
+
+        init(pLogicalDevice, format, imageExtent, inputImages, outputImages, pConfig);
+    }
+    EasuEffect::~EasuEffect()
+    {
+    }
+} // namespace vkBasalt
@@ -0,0 +1,31 @@
+#ifndef EFFECT_EASU_HPP_INCLUDED
+#define EFFECT_EASU_HPP_INCLUDED
+#include <vector>
+#include <fstream>
+#include <string>
+#include <iostream>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+
+#include "vulkan_include.hpp"
+
+#include "effect_simple.hpp"
+#include "config.hpp"
+
+namespace vkBasalt
+{
+    class EasuEffect : public SimpleEffect
+    {
+    public:
+        EasuEffect(LogicalDevice*       pLogicalDevice,
+                   VkFormat             format,
+                   VkExtent2D           imageExtent,
+                   std::vector<VkImage> inputImages,
+                   std::vector<VkImage> outputImages,
+                   Config*              pConfig);
+        ~EasuEffect();
+    };
+} // namespace vkBasalt
+
+#endif // EFFECT_EASU_HPP_INCLUDED
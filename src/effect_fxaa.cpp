@@ -26,7 +26,7 @@ namespace vkBasalt
         float fxaaQualityEdgeThreshold    = pConfig->getOption<float>("fxaaQualityEdgeThreshold", 0.125f);
         float fxaaQualityEdgeThresholdMin = pConfig->getOption<float>("fxaaQualityEdgeThresholdMin", 0.0312f);
 
-        vertexCode   = full_screen_triangle_vert;
+        vertexCode   = damage_rect_vert;
         fragmentCode = fxaa_frag;
 
         std::vector<VkSpecializationMapEntry> specMapEntrys(5);
@@ -51,6 +51,11 @@ namespace vkBasalt
 
         init(pLogicalDevice, format, imageExtent, inputImages, outputImages, pConfig);
     }
+    uint32_t FxaaEffect::getDamageRadius()
+    {
+        // the edge search of quality preset 39 walks up to 26.5 pixels along the edge, plus the neighbours of the end points
+        return 32;
+    }
     FxaaEffect::~FxaaEffect()
     {
     }
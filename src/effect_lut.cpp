@@ -10,8 +10,10 @@
 #include "framebuffer.hpp"
 #include "shader.hpp"
 #include "sampler.hpp"
+#include "object_cache.hpp"
 #include "image.hpp"
 #include "lut_cube.hpp"
+#include "util.hpp"
 
 #include "stb_image.h"
 
@@ -26,30 +28,67 @@ namespace vkBasalt
                          std::vector<VkImage> outputImages,
                          Config*              pConfig)
     {
-        vertexCode   = full_screen_triangle_vert;
+        vertexCode   = damage_rect_vert;
         fragmentCode = lut_frag;
 
         std::string lutFile = pConfig->getOption<std::string>("lutFile");
 
-        int      height;
-        LutCube  lutCube;
-        stbi_uc* pixels;
-        int32_t  usingPNG = (int32_t)(lutFile.find(".cube") == std::string::npos && lutFile.find(".CUBE") == std::string::npos);
-        if (!usingPNG)
-        {
-            lutCube = LutCube(lutFile);
-            pixels  = lutCube.colorCube.data();
-            height  = lutCube.size;
-        }
-        else
+        int32_t usingPNG = (int32_t)(lutFile.find(".cube") == std::string::npos && lutFile.find(".CUBE") == std::string::npos);
+
+        // big luts cost a lot of memory and cache bandwidth for little gain, so they can be resampled to a smaller size
+        int32_t maxLutSize = pConfig->getOption<int32_t>("lutMaxSize", 0);
+
+        // parsing a lut is slow, reuse the texture if another effect already loaded the same file
+        std::string lutKey = "lut:" + getFileCacheKey(lutFile) + ":" + std::to_string(maxLutSize);
+        lutTexture         = getCachedTexture(pLogicalDevice, lutKey);
+        if (!lutTexture)
         {
-            int channels, width;
-            pixels = stbi_load(lutFile.c_str(), &width, &height, &channels, STBI_rgb_alpha);
-            if (width != height * height)
+            int                   height;
+            std::vector<uint32_t> colors;
+            if (!usingPNG)
+            {
+                LutCube lutCube(lutFile);
+                colors = std::move(lutCube.colorCube);
+                height = lutCube.size;
+            }
+            else
             {
-                Logger::err("bad lut");
+                int      channels, width;
+                stbi_uc* pixels = stbi_load(lutFile.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+                if (pixels == nullptr || width != height * height)
+                {
+                    Logger::err("bad lut");
+                }
+                if (pixels != nullptr)
+                {
+                    colors.resize(height * height * height);
+                    for (size_t i = 0; i < colors.size(); i++)
+                    {
+                        colors[i] = packLutColor(pixels[i * 4] / 255.0f, pixels[i * 4 + 1] / 255.0f, pixels[i * 4 + 2] / 255.0f);
+                    }
+                    stbi_image_free(pixels);
+                }
             }
+
+            if (maxLutSize >= 2 && height > maxLutSize)
+            {
+                Logger::debug("resampling lut from " + std::to_string(height) + " to " + std::to_string(maxLutSize));
+                colors = resampleLut(colors, height, maxLutSize);
+                height = maxLutSize;
+            }
+
+            VkExtent3D lutImageExtent = {(uint32_t) height, (uint32_t) height, (uint32_t) height};
+
+            // 10 bits per channel keep more of the precision of .cube files than R8G8B8A8 at the same size
+            lutTexture = createCachedTexture(pLogicalDevice, lutKey, lutImageExtent, VK_FORMAT_A2B10G10R10_UNORM_PACK32);
+
+            uploadToImage(pLogicalDevice,
+                          lutTexture->image,
+                          lutImageExtent,
+                          colors.size() * sizeof(uint32_t),
+                          reinterpret_cast<const unsigned char*>(colors.data()));
         }
+        int32_t height = lutTexture->extent.width;
 
         std::vector<VkSpecializationMapEntry> specMapEntrys(2);
         for (uint32_t i = 0; i < specMapEntrys.size(); i++)
@@ -69,24 +108,7 @@ namespace vkBasalt
         pVertexSpecInfo   = nullptr;
         pFragmentSpecInfo = &fragmentSpecializationInfo;
 
-        VkExtent3D lutImageExtent = {(uint32_t) height, (uint32_t) height, (uint32_t) height};
-
-        lutImage = createImages(pLogicalDevice,
-                                1,
-                                lutImageExtent,
-                                VK_FORMAT_R8G8B8A8_UNORM, // TODO search for format and save it
-                                VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
-                                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                                lutMemory)[0];
-
-        uploadToImage(pLogicalDevice, lutImage, lutImageExtent, height * height * height * 4, pixels);
-
-        if (usingPNG)
-        {
-            stbi_image_free(pixels);
-        }
-
-        lutImageView = createImageViews(pLogicalDevice, VK_FORMAT_R8G8B8A8_UNORM, std::vector<VkImage>(1, lutImage), VK_IMAGE_VIEW_TYPE_3D)[0];
+        lutImageView = lutTexture->imageViewUNORM;
 
         lutDescriptorSetLayout = createImageSamplerDescriptorSetLayout(pLogicalDevice, 1);
         descriptorSetLayouts.push_back(lutDescriptorSetLayout);
@@ -108,13 +130,14 @@ namespace vkBasalt
                                                        {sampler},
                                                        std::vector<std::vector<VkImageView>>(1, std::vector<VkImageView>(1, lutImageView)))[0];
     }
+    uint32_t LutEffect::getDamageRadius()
+    {
+        return 0;
+    }
     LutEffect::~LutEffect()
     {
-        pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, lutImageView, nullptr);
-        pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, lutImage, nullptr);
-        pLogicalDevice->vkd.DestroyDescriptorSetLayout(pLogicalDevice->device, lutDescriptorSetLayout, nullptr);
+        releaseCachedObject<VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT>(pLogicalDevice, lutDescriptorSetLayout);
         pLogicalDevice->vkd.DestroyDescriptorPool(pLogicalDevice->device, lutDescriptorPool, nullptr);
-        pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, lutMemory, nullptr);
     }
     void LutEffect::applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer)
     {
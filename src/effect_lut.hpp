@@ -12,6 +12,7 @@
 
 #include "effect_simple.hpp"
 #include "config.hpp"
+#include "texture_cache.hpp"
 
 namespace vkBasalt
 {
@@ -24,16 +25,17 @@ namespace vkBasalt
                   std::vector<VkImage> inputImages,
                   std::vector<VkImage> outputImages,
                   Config*              pConfig);
+        uint32_t virtual getDamageRadius() override;
         ~LutEffect();
         void applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer) override;
 
     private:
-        VkImage               lutImage;
-        VkDeviceMemory        lutMemory;
         VkImageView           lutImageView;
         VkDescriptorSetLayout lutDescriptorSetLayout;
         VkDescriptorPool      lutDescriptorPool;
         VkDescriptorSet       lutDescriptorSet;
+
+        std::shared_ptr<CachedTexture> lutTexture;
     };
 } // namespace vkBasalt
 
@@ -0,0 +1,41 @@
+#include "effect_rcas.hpp"
+
+#include <cmath>
+
+#include "shader_sources.hpp"
+
+namespace vkBasalt
+{
+    RcasEffect::RcasEffect(LogicalDevice*       pLogicalDevice,
+                           VkFormat             format,
+                           VkExtent2D           imageExtent,
+                           std::vector<VkImage> inputImages,
+                           std::vector<VkImage> outputImages,
+                           Config*              pConfig)
+    {
+        // the option is in stops, every stop halves the sharpening
+        float sharpness = std::exp2(-pConfig->getOption<float>("upscaleSharpness", 0.2f));
+
+        vertexCode   = damage_rect_vert;
+        fragmentCode = rcas_frag;
+
+        VkSpecializationMapEntry sharpnessMapEntry;
+        sharpnessMapEntry.constantID = 0;
+        sharpnessMapEntry.offset     = 0;
+        sharpnessMapEntry.size       = sizeof(float);
+
+        VkSpecializationInfo fragmentSpecializationInfo;
+        fragmentSpecializationInfo.mapEntryCount = 1;
+        fragmentSpecializationInfo.pMapEntries   = &sharpnessMapEntry;
+        fragmentSpecializationInfo.dataSize      = sizeof(float);
+        fragmentSpecializationInfo.pData         = &sharpness;
+
+        pVertexSpecInfo   = nullptr;
+        pFragmentSpecInfo = &fragmentSpecializationInfo;
+
+        init(pLogicalDevice, format, imageExtent, inputImages, outputImages, pConfig);
+    }
+    RcasEffect::~RcasEffect()
+    {
+    }
+} // namespace vkBasalt
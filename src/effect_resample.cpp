@@ -0,0 +1,26 @@
+#include "effect_resample.hpp"
+
+#include "shader_sources.hpp"
+
+namespace vkBasalt
+{
+    ResampleEffect::ResampleEffect(LogicalDevice*       pLogicalDevice,
+                                   VkFormat             format,
+                                   VkExtent2D           imageExtent,
+                                   std::vector<VkImage> inputImages,
+                                   std::vector<VkImage> outputImages,
+                                   Config*              pConfig)
+    {
+        // the input images can have any size, they get filtered to imageExtent
+        vertexCode   = damage_rect_vert;
+        fragmentCode = resample_frag;
+
+        pVertexSpecInfo   = nullptr;
+        pFragmentSpecInfo = nullptr;
+
+        init(pLogicalDevice, format, imageExtent, inputImages, outputImages, pConfig);
+    }
+    ResampleEffect::~ResampleEffect()
+    {
+    }
+} // namespace vkBasalt
@@ -17,8 +17,12 @@
 #include "framebuffer.hpp"
 #include "shader.hpp"
 #include "sampler.hpp"
+#include "object_cache.hpp"
 #include "image.hpp"
 #include "format.hpp"
+#include "dds_file.hpp"
+#include "reshade_usage.hpp"
+#include "letterbox.hpp"
 
 #include "util.hpp"
 
@@ -28,22 +32,127 @@
 
 namespace vkBasalt
 {
+    struct TextureLoad
+    {
+        std::string                filePath;
+        VkExtent3D                 extent;
+        VkFormat                   format;
+        VkImage                    image;
+        uint32_t                   mipLevels;
+        std::vector<unsigned char> pixels;
+        // only set if the blocks of a dds file get uploaded directly
+        std::vector<uint32_t>      levelSizes;
+    };
+
+    // returns true if the block compressed data can stand in for a texture of the given format
+    static bool isBlockFormatCompatible(VkFormat blockFormat, VkFormat textureFormat)
+    {
+        switch (blockFormat)
+        {
+            case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+            case VK_FORMAT_BC2_UNORM_BLOCK:
+            case VK_FORMAT_BC3_UNORM_BLOCK:
+            case VK_FORMAT_BC7_UNORM_BLOCK: return convertToUNORM(textureFormat) == VK_FORMAT_R8G8B8A8_UNORM;
+            case VK_FORMAT_BC4_UNORM_BLOCK: return textureFormat == VK_FORMAT_R8_UNORM;
+            case VK_FORMAT_BC5_UNORM_BLOCK: return textureFormat == VK_FORMAT_R8G8_UNORM;
+            default: return false;
+        }
+    }
+
+    // decodes a source texture and converts it to the size and format of the reshade texture
+    // this gets called from worker threads, so it must not touch any vulkan state
+    static std::vector<unsigned char> loadTexture(const std::string& filePath, VkExtent3D extent, VkFormat format)
+    {
+        int desiredChannels;
+        switch (format)
+        {
+            case VK_FORMAT_R8_UNORM: desiredChannels = STBI_grey; break;
+            case VK_FORMAT_R8G8_UNORM:
+                desiredChannels = STBI_rgb_alpha; // TODO why doesn't STBI_grey_alpha work?
+                break;
+            case VK_FORMAT_R8G8B8A8_UNORM: desiredChannels = STBI_rgb_alpha; break;
+            case VK_FORMAT_R8G8B8A8_SRGB: desiredChannels = STBI_rgb_alpha; break;
+            default:
+                Logger::err("unsupported texture upload format" + std::to_string(format));
+                desiredChannels = 4;
+                break;
+        }
+        int outputChannels = (format == VK_FORMAT_R8G8_UNORM) ? 2 : desiredChannels;
+
+        std::vector<unsigned char> result(extent.width * extent.height * outputChannels, 0);
+
+        FILE* const file = fopen(filePath.c_str(), "rb");
+        if (file == nullptr)
+        {
+            Logger::err("couldn't open texture: " + filePath);
+            return result;
+        }
+
+        stbi_uc* pixels;
+        int      width;
+        int      height;
+        int      channels;
+        if (stbi_dds_test_file(file))
+        {
+            pixels = stbi_dds_load_from_file(file, &width, &height, &channels, desiredChannels);
+        }
+        else
+        {
+            pixels = stbi_load_from_file(file, &width, &height, &channels, desiredChannels);
+        }
+        fclose(file);
+
+        if (pixels == nullptr)
+        {
+            Logger::err("couldn't decode texture: " + filePath);
+            return result;
+        }
+
+        // change RGBA to RG
+        if (format == VK_FORMAT_R8G8_UNORM)
+        {
+            uint32_t pos = 0;
+            for (uint32_t j = 0; j < static_cast<uint32_t>(width * height * desiredChannels); j += 4)
+            {
+                pixels[pos] = pixels[j];
+                pos++;
+                pixels[pos] = pixels[j + 1];
+                pos++;
+            }
+        }
+
+        if (static_cast<uint32_t>(width) != extent.width || static_cast<uint32_t>(height) != extent.height)
+        {
+            stbir_resize_uint8(pixels, width, height, 0, result.data(), extent.width, extent.height, 0, outputChannels);
+        }
+        else
+        {
+            std::memcpy(result.data(), pixels, result.size());
+        }
+
+        stbi_image_free(pixels);
+        return result;
+    }
+
     ReshadeEffect::ReshadeEffect(LogicalDevice*       pLogicalDevice,
                                  VkFormat             format,
                                  VkExtent2D           imageExtent,
                                  std::vector<VkImage> inputImages,
                                  std::vector<VkImage> outputImages,
                                  Config*              pConfig,
-                                 std::string          effectName)
+                                 std::string          effectName,
+                                 uint32_t             updateInterval)
     {
         Logger::debug("in creating ReshadeEffect");
 
         this->pLogicalDevice   = pLogicalDevice;
         this->imageExtent      = imageExtent;
+        this->contentRect      = {{0, 0}, imageExtent};
         this->inputImages      = inputImages;
         this->outputImages     = outputImages;
         this->pConfig          = pConfig;
         this->effectName       = effectName;
+        this->updateInterval   = updateInterval;
         inputOutputFormatUNORM = convertToUNORM(format);
         inputOutputFormatSRGB  = convertToSRGB(format);
 
@@ -54,6 +163,7 @@ namespace vkBasalt
         outputImageViewsUNORM = createImageViews(pLogicalDevice, inputOutputFormatUNORM, outputImages);
         Logger::debug("created ImageViews");
 
+        pDescriptorHeap = getDescriptorHeap(pLogicalDevice);
         createReshadeModule();
 
         enumerateReshadeUniforms(module);
@@ -71,25 +181,64 @@ namespace vkBasalt
                          stagingBufferMemory);
         }
 
+        // passes that nothing reads never get recorded, so they are dropped before anything gets created for them
+        ReshadeUsage                      usage = analyzeReshadeModule(module);
+        std::vector<reshadefx::pass_info> livePasses;
+        std::vector<std::array<bool, 8>>  loadTargets;
+        std::vector<std::array<bool, 8>>  storeTargets;
+        for (size_t i = 0; i < module.techniques[0].passes.size(); i++)
+        {
+            if (usage.livePasses[i])
+            {
+                livePasses.push_back(module.techniques[0].passes[i]);
+                loadTargets.push_back(usage.loadTargets[i]);
+                storeTargets.push_back(usage.storeTargets[i]);
+            }
+        }
+        module.techniques[0].passes = livePasses;
+
         stencilFormat = getStencilFormat(pLogicalDevice);
         Logger::debug("Stencil Format: " + std::to_string(stencilFormat));
-        textureMemory.push_back(VK_NULL_HANDLE);
-        stencilImage = createImages(pLogicalDevice,
-                                    1,
-                                    {imageExtent.width, imageExtent.height, 1},
-                                    stencilFormat,
-                                    VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
-                                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                                    textureMemory.back())[0];
-
-        stencilImageView = createImageViews(
-            pLogicalDevice, stencilFormat, {stencilImage}, VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT)[0];
+        if (usage.usesStencil)
+        {
+            textureMemory.push_back(VK_NULL_HANDLE);
+            stencilImage = createImages(pLogicalDevice,
+                                        1,
+                                        {imageExtent.width, imageExtent.height, 1},
+                                        stencilFormat,
+                                        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+                                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                        textureMemory.back())[0];
+
+            stencilImageView = createImageViews(
+                pLogicalDevice, stencilFormat, {stencilImage}, VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT)[0];
+        }
 
         std::vector<std::vector<VkImageView>> imageViewVector;
+        std::vector<TextureLoad>              textureLoads;
 
+        // mip maps are only worth generating for render targets that get sampled below the first level
+        std::set<std::string> mipMappedTextures;
+        for (auto& texture : module.textures)
+        {
+            bool isRenderTarget = usage.renderedSRGB.count(texture.unique_name) || usage.renderedUNORM.count(texture.unique_name);
+            if (usage.mipLevels[texture.unique_name] > 1 && isRenderTarget)
+            {
+                mipMappedTextures.insert(texture.unique_name);
+            }
+        }
+        if (!mipMappedTextures.empty() && pLogicalDevice->supportsComputeMipMaps)
+        {
+            mipMapGenerator = std::make_unique<MipMapGenerator>(pLogicalDevice, mipMappedTextures.size());
+        }
+
+        std::unordered_map<std::string, uint32_t> pooledTargetCounts;
+        std::set<std::string>                     pooledTargets;
         for (size_t i = 0; i < module.textures.size(); i++)
         {
-            textureMipLevels[module.textures[i].unique_name] = module.textures[i].levels;
+            uint32_t levels = usage.mipLevels[module.textures[i].unique_name];
+
+            textureMipLevels[module.textures[i].unique_name] = levels;
             textureExtents[module.textures[i].unique_name]   = {module.textures[i].width, module.textures[i].height, 1};
             if (module.textures[i].semantic == "COLOR")
             {
@@ -105,6 +254,8 @@ namespace vkBasalt
             }
             if (module.textures[i].semantic == "DEPTH")
             {
+                depthTextureNames.push_back(module.textures[i].unique_name);
+
                 textureImageViewsUNORM[module.textures[i].unique_name] = inputImageViewsUNORM;
                 renderImageViewsUNORM[module.textures[i].unique_name]  = inputImageViewsUNORM;
 
@@ -115,178 +266,210 @@ namespace vkBasalt
                 textureFormatsSRGB[module.textures[i].unique_name]  = inputOutputFormatSRGB;
                 continue;
             }
+            if (!usage.isUsed(module.textures[i].unique_name))
+            {
+                Logger::debug("skipping unused texture " + module.textures[i].unique_name);
+                continue;
+            }
             VkExtent3D textureExtent = {module.textures[i].width, module.textures[i].height, 1};
             // TODO handle mip map levels correctly
-            // TODO handle pooled textures better
             if (const auto source = std::find_if(
                     module.textures[i].annotations.begin(), module.textures[i].annotations.end(), [](const auto& a) { return a.name == "source"; });
                 source == module.textures[i].annotations.end())
             {
-                textureMemory.push_back(VK_NULL_HANDLE);
-                std::vector<VkImage> images = createImages(pLogicalDevice,
-                                                           1,
-                                                           textureExtent,
-                                                           convertReshadeFormat(module.textures[i].format),
-                                                           VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT
-                                                               | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
-                                                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                                                           textureMemory.back(),
-                                                           module.textures[i].levels);
-
-                textureImages[module.textures[i].unique_name] = images;
-                std::vector<VkImageView> imageViewsUNORM =
-                    std::vector<VkImageView>(inputImages.size(),
-                                             createImageViews(pLogicalDevice,
-                                                              convertToUNORM(convertReshadeFormat(module.textures[i].format)),
-                                                              images,
-                                                              VK_IMAGE_VIEW_TYPE_2D,
-                                                              VK_IMAGE_ASPECT_COLOR_BIT,
-                                                              module.textures[i].levels)[0]);
-
-                std::vector<VkImageView> imageViewsSRGB =
-                    std::vector<VkImageView>(inputImages.size(),
-                                             createImageViews(pLogicalDevice,
-                                                              convertToSRGB(convertReshadeFormat(module.textures[i].format)),
-                                                              images,
-                                                              VK_IMAGE_VIEW_TYPE_2D,
-                                                              VK_IMAGE_ASPECT_COLOR_BIT,
-                                                              module.textures[i].levels)[0]);
-
-                textureImageViewsUNORM[module.textures[i].unique_name] = imageViewsUNORM;
-                textureImageViewsSRGB[module.textures[i].unique_name]  = imageViewsSRGB;
+                VkImageUsageFlags imageUsage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT
+                                               | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
 
-                if (module.textures[i].levels > 1)
+                bool computeMipMaps = mipMapGenerator && mipMappedTextures.count(module.textures[i].unique_name)
+                                      && mipMapGenerator->supports(convertReshadeFormat(module.textures[i].format), textureExtent);
+                if (computeMipMaps)
                 {
+                    imageUsage |= VK_IMAGE_USAGE_STORAGE_BIT;
+                }
 
-                    renderImageViewsUNORM[module.textures[i].unique_name] = std::vector<VkImageView>(
-                        inputImages.size(),
-                        createImageViews(pLogicalDevice, convertToUNORM(convertReshadeFormat(module.textures[i].format)), images)[0]);
+                // pooled render targets do not keep their content between effects, and the effects run one after another,
+                // so every effect on the device can share them as long as size, format and levels match
+                // the nth pooled target of a description gets the nth shared image, so that targets of the same effect never alias
+                bool pooled = std::any_of(module.textures[i].annotations.begin(), module.textures[i].annotations.end(), [](const auto& a) {
+                    return a.name == "pooled" && a.value.as_uint[0];
+                });
 
-                    renderImageViewsSRGB[module.textures[i].unique_name] = std::vector<VkImageView>(
-                        inputImages.size(),
-                        createImageViews(pLogicalDevice, convertToSRGB(convertReshadeFormat(module.textures[i].format)), images)[0]);
+                std::vector<VkImage>           images;
+                std::shared_ptr<CachedTexture> pooledTexture;
+                if (pooled)
+                {
+                    pooledTargets.insert(module.textures[i].unique_name);
+                    std::string poolKey = "reshade:pooled:" + std::to_string(textureExtent.width) + "x" + std::to_string(textureExtent.height)
+                                          + ":" + std::to_string(convertReshadeFormat(module.textures[i].format)) + ":"
+                                          + std::to_string(levels) + ":" + std::to_string(imageUsage);
+                    poolKey += ":" + std::to_string(pooledTargetCounts[poolKey]++);
+
+                    pooledTexture = getCachedTexture(pLogicalDevice, poolKey);
+                    if (!pooledTexture)
+                    {
+                        pooledTexture = createCachedTexture(
+                            pLogicalDevice, poolKey, textureExtent, convertReshadeFormat(module.textures[i].format), levels, imageUsage);
+                        changeImageLayout(pLogicalDevice, {pooledTexture->image}, levels);
+                    }
+                    pooledTextures.push_back(pooledTexture);
+                    images = {pooledTexture->image};
                 }
                 else
                 {
-                    renderImageViewsUNORM[module.textures[i].unique_name] = imageViewsUNORM;
-                    renderImageViewsSRGB[module.textures[i].unique_name]  = imageViewsSRGB;
+                    textureMemory.push_back(VK_NULL_HANDLE);
+                    images = createImages(pLogicalDevice,
+                                          1,
+                                          textureExtent,
+                                          convertReshadeFormat(module.textures[i].format),
+                                          imageUsage,
+                                          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                          textureMemory.back(),
+                                          levels);
                 }
 
-                textureFormatsUNORM[module.textures[i].unique_name] = convertToUNORM(convertReshadeFormat(module.textures[i].format));
-                textureFormatsSRGB[module.textures[i].unique_name]  = convertToSRGB(convertReshadeFormat(module.textures[i].format));
-                changeImageLayout(pLogicalDevice, images, module.textures[i].levels);
-                continue;
-            }
-            else
-            {
-                textureMemory.push_back(VK_NULL_HANDLE);
-                std::vector<VkImage> images =
-                    createImages(pLogicalDevice,
-                                 1,
-                                 textureExtent,
-                                 convertReshadeFormat(module.textures[i].format), // TODO search for format and save it
-                                 VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
-                                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                                 textureMemory.back(),
-                                 module.textures[i].levels);
-
                 textureImages[module.textures[i].unique_name] = images;
 
-                std::vector<VkImageView> imageViews = createImageViews(pLogicalDevice,
-                                                                       convertToUNORM(convertReshadeFormat(module.textures[i].format)),
-                                                                       images,
-                                                                       VK_IMAGE_VIEW_TYPE_2D,
-                                                                       VK_IMAGE_ASPECT_COLOR_BIT,
-                                                                       module.textures[i].levels);
-
-                std::vector<VkImageView> imageViewsUNORM = std::vector<VkImageView>(inputImages.size(), imageViews[0]);
-
-                imageViews = createImageViews(pLogicalDevice,
-                                              convertToSRGB(convertReshadeFormat(module.textures[i].format)),
-                                              images,
-                                              VK_IMAGE_VIEW_TYPE_2D,
-                                              VK_IMAGE_ASPECT_COLOR_BIT,
-                                              module.textures[i].levels);
-
-                std::vector<VkImageView> imageViewsSRGB = std::vector<VkImageView>(inputImages.size(), imageViews[0]);
+                if (computeMipMaps)
+                {
+                    mipMapGenerator->addImage(images[0], convertReshadeFormat(module.textures[i].format), textureExtent, levels);
+                    computeMipMapTextures.insert(module.textures[i].unique_name);
+                }
+                auto createViews = [&](VkFormat viewFormat, uint32_t viewLevels) {
+                    return std::vector<VkImageView>(
+                        inputImages.size(),
+                        createImageViews(pLogicalDevice, viewFormat, images, VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_ASPECT_COLOR_BIT, viewLevels)[0]);
+                };
+                VkFormat formatUNORM = convertToUNORM(convertReshadeFormat(module.textures[i].format));
+                VkFormat formatSRGB  = convertToSRGB(convertReshadeFormat(module.textures[i].format));
+
+                // only the views that live samplers and passes use get created, with a single level they serve both
+                bool renderedUNORM = usage.renderedUNORM.count(module.textures[i].unique_name);
+                bool renderedSRGB  = usage.renderedSRGB.count(module.textures[i].unique_name);
+
+                std::vector<VkImageView> imageViewsUNORM;
+                std::vector<VkImageView> imageViewsSRGB;
+                if (pooledTexture)
+                {
+                    imageViewsUNORM = std::vector<VkImageView>(inputImages.size(), pooledTexture->imageViewUNORM);
+                    imageViewsSRGB  = std::vector<VkImageView>(inputImages.size(), pooledTexture->imageViewSRGB);
+                }
+                else
+                {
+                    if (usage.sampledUNORM.count(module.textures[i].unique_name) || (levels == 1 && renderedUNORM))
+                    {
+                        imageViewsUNORM = createViews(formatUNORM, levels);
+                    }
+                    if (usage.sampledSRGB.count(module.textures[i].unique_name) || (levels == 1 && renderedSRGB))
+                    {
+                        imageViewsSRGB = createViews(formatSRGB, levels);
+                    }
+                }
 
                 textureImageViewsUNORM[module.textures[i].unique_name] = imageViewsUNORM;
                 textureImageViewsSRGB[module.textures[i].unique_name]  = imageViewsSRGB;
 
-                renderImageViewsUNORM[module.textures[i].unique_name] = imageViewsUNORM;
-                renderImageViewsSRGB[module.textures[i].unique_name]  = imageViewsSRGB;
-
-                textureFormatsUNORM[module.textures[i].unique_name] = convertToUNORM(convertReshadeFormat(module.textures[i].format));
-                textureFormatsSRGB[module.textures[i].unique_name]  = convertToSRGB(convertReshadeFormat(module.textures[i].format));
-
-                int desiredChannels;
-                switch (textureFormatsUNORM[module.textures[i].unique_name])
+                if (levels > 1)
                 {
-                    case VK_FORMAT_R8_UNORM: desiredChannels = STBI_grey; break;
-                    case VK_FORMAT_R8G8_UNORM:
-                        desiredChannels = STBI_rgb_alpha; // TODO why doesn't STBI_grey_alpha work?
-                        break;
-                    case VK_FORMAT_R8G8B8A8_UNORM: desiredChannels = STBI_rgb_alpha; break;
-                    case VK_FORMAT_R8G8B8A8_SRGB: desiredChannels = STBI_rgb_alpha; break;
-                    default:
-                        Logger::err("unsupported texture upload format" + std::to_string(textureFormatsUNORM[module.textures[i].unique_name]));
-                        desiredChannels = 4;
-                        break;
+                    if (renderedUNORM)
+                    {
+                        renderImageViewsUNORM[module.textures[i].unique_name] = createViews(formatUNORM, 1);
+                    }
+                    if (renderedSRGB)
+                    {
+                        renderImageViewsSRGB[module.textures[i].unique_name] = createViews(formatSRGB, 1);
+                    }
                 }
-
-                std::string          filePath = pConfig->getOption<std::string>("reshadeTexturePath") + "/" + source->value.string_data;
-                stbi_uc*             pixels;
-                std::vector<stbi_uc> resizedPixels;
-                uint32_t             size;
-                int                  width;
-                int                  height;
-
-                size = textureExtent.width * textureExtent.height * desiredChannels;
-
-                FILE* const file = fopen(filePath.c_str(), "rb");
-
-                if (file == nullptr)
+                else
                 {
-                    Logger::err("couldn't open texture: " + filePath);
+                    renderImageViewsUNORM[module.textures[i].unique_name] = imageViewsUNORM;
+                    renderImageViewsSRGB[module.textures[i].unique_name]  = imageViewsSRGB;
                 }
-                if (stbi_dds_test_file(file))
+
+                textureFormatsUNORM[module.textures[i].unique_name] = formatUNORM;
+                textureFormatsSRGB[module.textures[i].unique_name]  = formatSRGB;
+                if (!pooled)
                 {
-                    int channels;
-                    pixels = stbi_dds_load_from_file(file, &width, &height, &channels, desiredChannels);
+                    changeImageLayout(pLogicalDevice, images, levels);
                 }
-                else
+                continue;
+            }
+            else
+            {
+                VkFormat    textureFormat = convertReshadeFormat(module.textures[i].format);
+                std::string filePath      = pConfig->getOption<std::string>("reshadeTexturePath") + "/" + source->value.string_data;
+
+                // block compressed dds files can be uploaded as they are if they already have the right size and enough mip levels,
+                // which saves decoding as well as most of the memory
+                DdsFile ddsFile(filePath);
+                bool    uploadBlocks = isBlockFormatCompatible(ddsFile.format, textureFormat) && ddsFile.width == textureExtent.width
+                                    && ddsFile.height == textureExtent.height && ddsFile.mipLevels >= levels
+                                    && isFormatSupported(pLogicalDevice, ddsFile.format, VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT);
+                if (uploadBlocks)
                 {
-                    int channels;
-                    pixels = stbi_load_from_file(file, &width, &height, &channels, desiredChannels);
+                    Logger::debug("uploading dds blocks directly: " + filePath);
+                    textureFormat = ddsFile.format;
                 }
 
-                // change RGBA to RG
-                if (textureFormatsUNORM[module.textures[i].unique_name] == VK_FORMAT_R8G8_UNORM)
+                // source textures only depend on the file and how it gets stored, so every effect on this device can share them
+                std::string textureKey = "reshade:" + getFileCacheKey(filePath) + ":" + std::to_string(textureExtent.width) + "x"
+                                         + std::to_string(textureExtent.height) + ":" + std::to_string(textureFormat) + ":"
+                                         + std::to_string(levels);
+
+                std::shared_ptr<CachedTexture> texture = getCachedTexture(pLogicalDevice, textureKey);
+                if (!texture)
                 {
-                    uint32_t pos = 0;
-                    for (uint32_t j = 0; j < size; j += 4)
+                    texture = createCachedTexture(pLogicalDevice, textureKey, textureExtent, textureFormat, levels);
+                    textureLoads.push_back(
+                        {filePath, textureExtent, convertToUNORM(textureFormat), texture->image, levels, {}, {}});
+                    if (uploadBlocks)
                     {
-                        pixels[pos] = pixels[j];
-                        pos++;
-                        pixels[pos] = pixels[j + 1];
-                        pos++;
+                        for (uint32_t level = 0; level < levels; level++)
+                        {
+                            textureLoads.back().levelSizes.push_back(ddsFile.getLevelSize(level));
+                        }
                     }
-                    size /= 2;
-                    desiredChannels /= 2;
                 }
+                sourceTextures.push_back(texture);
 
-                if (static_cast<uint32_t>(width) != textureExtent.width || static_cast<uint32_t>(height) != textureExtent.height)
-                {
-                    resizedPixels.resize(size);
-                    stbir_resize_uint8(pixels, width, height, 0, resizedPixels.data(), textureExtent.width, textureExtent.height, 0, desiredChannels);
-                }
+                std::vector<VkImageView> imageViewsUNORM = std::vector<VkImageView>(inputImages.size(), texture->imageViewUNORM);
+                std::vector<VkImageView> imageViewsSRGB  = std::vector<VkImageView>(inputImages.size(), texture->imageViewSRGB);
 
-                uploadToImage(
-                    pLogicalDevice, images[0], textureExtent, size, resizedPixels.size() ? resizedPixels.data() : pixels, module.textures[i].levels);
-                stbi_image_free(pixels);
+                textureImageViewsUNORM[module.textures[i].unique_name] = imageViewsUNORM;
+                textureImageViewsSRGB[module.textures[i].unique_name]  = imageViewsSRGB;
+
+                renderImageViewsUNORM[module.textures[i].unique_name] = imageViewsUNORM;
+                renderImageViewsSRGB[module.textures[i].unique_name]  = imageViewsSRGB;
+
+                textureFormatsUNORM[module.textures[i].unique_name] = convertToUNORM(textureFormat);
+                textureFormatsSRGB[module.textures[i].unique_name]  = convertToSRGB(textureFormat);
             }
         }
 
+        // decoding is the expensive part, so decode all source textures at once and upload them in one batch
+        parallelFor(textureLoads.size(), [&textureLoads](size_t i) {
+            if (textureLoads[i].levelSizes.empty())
+            {
+                textureLoads[i].pixels = loadTexture(textureLoads[i].filePath, textureLoads[i].extent, textureLoads[i].format);
+            }
+            else
+            {
+                textureLoads[i].pixels = DdsFile(textureLoads[i].filePath).readLevels(textureLoads[i].levelSizes.size());
+            }
+        });
+
+        std::vector<ImageUpload> uploads;
+        for (auto& textureLoad : textureLoads)
+        {
+            uploads.push_back({textureLoad.image,
+                               textureLoad.extent,
+                               static_cast<uint32_t>(textureLoad.pixels.size()),
+                               textureLoad.pixels.data(),
+                               textureLoad.mipLevels,
+                               textureLoad.levelSizes});
+        }
+        uploadToImages(pLogicalDevice, uploads);
+        Logger::debug("uploaded " + std::to_string(uploads.size()) + " source textures");
+
         for (size_t i = 0; i < module.samplers.size(); i++)
         {
             reshadefx::sampler_info info = module.samplers[i];
@@ -295,11 +478,19 @@ namespace vkBasalt
 
             samplers.push_back(sampler);
 
-            imageViewVector.push_back(info.srgb ? textureImageViewsSRGB[info.texture_name] : textureImageViewsUNORM[info.texture_name]);
+            // samplers that only dead passes read still need a valid descriptor, so they get the input image like a missing depth image
+            std::vector<VkImageView> imageViews = info.srgb ? textureImageViewsSRGB[info.texture_name] : textureImageViewsUNORM[info.texture_name];
+            if (imageViews.empty())
+            {
+                imageViews = info.srgb ? inputImageViewsSRGB : inputImageViewsUNORM;
+            }
+            imageViewVector.push_back(imageViews);
         }
 
-        imageSamplerDescriptorSetLayout = createImageSamplerDescriptorSetLayout(pLogicalDevice, module.samplers.size());
-        uniformDescriptorSetLayout      = createUniformBufferDescriptorSetLayout(pLogicalDevice);
+        // the descriptor heap takes the place of the image sampler descriptor sets, the passes find their images through push constants
+        imageSamplerDescriptorSetLayout =
+            pDescriptorHeap ? pDescriptorHeap->layout : createImageSamplerDescriptorSetLayout(pLogicalDevice, module.samplers.size());
+        uniformDescriptorSetLayout = createUniformBufferDescriptorSetLayout(pLogicalDevice);
         Logger::debug("created descriptorSetLayouts");
 
         VkDescriptorPoolSize imagePoolSize;
@@ -310,25 +501,76 @@ namespace vkBasalt
         bufferPoolSize.type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
         bufferPoolSize.descriptorCount = 3;
 
-        std::vector<VkDescriptorPoolSize> poolSizes = {imagePoolSize, bufferPoolSize};
+        std::vector<VkDescriptorPoolSize> poolSizes = {bufferPoolSize};
+        if (!pDescriptorHeap)
+        {
+            poolSizes.push_back(imagePoolSize);
+        }
 
         descriptorPool = createDescriptorPool(pLogicalDevice, poolSizes);
         Logger::debug("created descriptorPool");
 
         std::vector<VkDescriptorSetLayout> descriptorSetLayouts = {uniformDescriptorSetLayout, imageSamplerDescriptorSetLayout};
 
-        pipelineLayout = createGraphicsPipelineLayout(pLogicalDevice, descriptorSetLayouts);
+        std::vector<VkPushConstantRange> pushConstantRanges;
+        if (pDescriptorHeap && !samplers.empty())
+        {
+            VkPushConstantRange pushConstantRange;
+            pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+            pushConstantRange.offset     = 0;
+            pushConstantRange.size       = samplers.size() * sizeof(uint32_t);
+            pushConstantRanges.push_back(pushConstantRange);
+        }
+
+        pipelineLayout = createGraphicsPipelineLayout(pLogicalDevice, descriptorSetLayouts, 0, pushConstantRanges);
 
         Logger::debug("created Pipeline layout");
 
+        // depth samplers get slots of their own that useDepthImage rewrites, until then they show the input image
+        if (pDescriptorHeap)
+        {
+            depthSamplerSlots.resize(samplers.size());
+            for (size_t i = 0; i < samplers.size(); i++)
+            {
+                if (std::find(depthTextureNames.begin(), depthTextureNames.end(), module.samplers[i].texture_name) == depthTextureNames.end())
+                {
+                    continue;
+                }
+                for (size_t j = 0; j < inputImages.size(); j++)
+                {
+                    depthSamplerSlots[i].push_back(allocateDescriptorSlot(pLogicalDevice, samplers[i], inputImageViewsUNORM[j]));
+                }
+            }
+        }
+
+        // the heap slots of the samplers for every swapchain image, samplers and views that occur more than once share a slot
+        auto getSamplerSlots = [&](const std::vector<std::vector<VkImageView>>& imageViews) {
+            std::vector<std::vector<uint32_t>> samplerSlots(inputImages.size(), std::vector<uint32_t>(samplers.size()));
+            for (size_t j = 0; j < inputImages.size(); j++)
+            {
+                for (size_t i = 0; i < samplers.size(); i++)
+                {
+                    samplerSlots[j][i] = depthSamplerSlots[i].empty() ? getDescriptorSlot(samplers[i], imageViews[i][j]) : depthSamplerSlots[i][j];
+                }
+            }
+            return samplerSlots;
+        };
+
         Logger::debug("output writes: " + std::to_string(outputWrites));
         if (bufferSize)
         {
             bufferDescriptorSet = writeBufferDescriptorSet(pLogicalDevice, descriptorPool, uniformDescriptorSetLayout, stagingBuffer);
         }
 
-        inputDescriptorSets =
-            allocateAndWriteImageSamplerDescriptorSets(pLogicalDevice, descriptorPool, imageSamplerDescriptorSetLayout, samplers, imageViewVector);
+        if (pDescriptorHeap)
+        {
+            inputSamplerSlots = getSamplerSlots(imageViewVector);
+        }
+        else
+        {
+            inputDescriptorSets = allocateAndWriteImageSamplerDescriptorSets(
+                pLogicalDevice, descriptorPool, imageSamplerDescriptorSetLayout, samplers, imageViewVector);
+        }
 
         // count the back buffer writes
         for (auto& pass : module.techniques[0].passes)
@@ -340,46 +582,79 @@ namespace vkBasalt
         }
 
         // if there is only one outputWrite, we can directly write to outputImages
+        // the back buffer only lives while the effect gets applied, so like the textures one image serves every swapchain image
         if (outputWrites > 1)
         {
             textureMemory.push_back(VK_NULL_HANDLE);
-            backBufferImages = createImages(pLogicalDevice,
-                                            inputImages.size(),
-                                            {imageExtent.width, imageExtent.height, 1},
-                                            format, // TODO search for format and save it
-                                            VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
-                                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                                            textureMemory.back());
-
-            backBufferImageViewsSRGB  = createImageViews(pLogicalDevice, inputOutputFormatSRGB, backBufferImages);
-            backBufferImageViewsUNORM = createImageViews(pLogicalDevice, inputOutputFormatUNORM, backBufferImages);
+            VkImage backBufferImage = createImages(pLogicalDevice,
+                                                   1,
+                                                   {imageExtent.width, imageExtent.height, 1},
+                                                   format, // TODO search for format and save it
+                                                   VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+                                                   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                   textureMemory.back())[0];
+
+            backBufferImages          = std::vector<VkImage>(inputImages.size(), backBufferImage);
+            backBufferImageViewsSRGB  = std::vector<VkImageView>(inputImages.size(),
+                                                                createImageViews(pLogicalDevice, inputOutputFormatSRGB, {backBufferImage})[0]);
+            backBufferImageViewsUNORM = std::vector<VkImageView>(inputImages.size(),
+                                                                 createImageViews(pLogicalDevice, inputOutputFormatUNORM, {backBufferImage})[0]);
 
             std::replace(imageViewVector.begin(), imageViewVector.end(), inputImageViewsSRGB, backBufferImageViewsSRGB);
             std::replace(imageViewVector.begin(), imageViewVector.end(), inputImageViewsUNORM, backBufferImageViewsUNORM);
 
-            backBufferDescriptorSets = allocateAndWriteImageSamplerDescriptorSets(
-                pLogicalDevice, descriptorPool, imageSamplerDescriptorSetLayout, samplers, imageViewVector);
+            if (pDescriptorHeap)
+            {
+                backBufferSamplerSlots = getSamplerSlots(imageViewVector);
+            }
+            else
+            {
+                backBufferDescriptorSets = allocateAndWriteImageSamplerDescriptorSets(
+                    pLogicalDevice, descriptorPool, imageSamplerDescriptorSetLayout, samplers, imageViewVector);
+            }
         }
         if (outputWrites > 2)
         {
             std::replace(imageViewVector.begin(), imageViewVector.end(), backBufferImageViewsSRGB, outputImageViewsSRGB);
             std::replace(imageViewVector.begin(), imageViewVector.end(), backBufferImageViewsUNORM, outputImageViewsUNORM);
-            outputDescriptorSets = allocateAndWriteImageSamplerDescriptorSets(
-                pLogicalDevice, descriptorPool, imageSamplerDescriptorSetLayout, samplers, imageViewVector);
+            if (pDescriptorHeap)
+            {
+                outputSamplerSlots = getSamplerSlots(imageViewVector);
+            }
+            else
+            {
+                outputDescriptorSets = allocateAndWriteImageSamplerDescriptorSets(
+                    pLogicalDevice, descriptorPool, imageSamplerDescriptorSetLayout, samplers, imageViewVector);
+            }
         }
 
         Logger::debug("after writing ImageSamplerDescriptorSets");
 
         bool firstTimeStencilAccess = true; // Used to clear the sttencil attachment on the first time
 
+        // only passes that cover the whole image get the stencil attachment
+        auto hasStencilAttachment = [&](const reshadefx::pass_info& pass) {
+            return usage.usesStencil && (pass.viewport_width ? pass.viewport_width : imageExtent.width) == imageExtent.width
+                   && (pass.viewport_height ? pass.viewport_height : imageExtent.height) == imageExtent.height;
+        };
+
         for (bool outputToBackBuffer = outputWrites % 2 == 0; auto& pass : module.techniques[0].passes)
         {
+            size_t passIndex = &pass - module.techniques[0].passes.data();
+
             std::vector<VkAttachmentReference>               attachmentReferences;
             std::vector<VkAttachmentDescription>             attachmentDescriptions;
             std::vector<VkPipelineColorBlendAttachmentState> attachmentBlendStates;
             std::vector<std::vector<VkImageView>>            attachmentImageViews;
             std::vector<std::string>                         currentRenderTargets;
 
+            // the stencil gets cleared every frame and pooled targets get overwritten by other effects, so passes using them always run
+            bool amortized = updateInterval > 1 && pass.render_target_names[0] != "" && !pass.stencil_enable
+                             && std::none_of(pass.render_target_names, pass.render_target_names + 8, [&](const std::string& target) {
+                                    return pooledTargets.count(target) != 0;
+                                });
+            amortizedPasses.push_back(amortized);
+
             for (int i = 0; i < 8; i++)
             {
                 std::string target = pass.render_target_names[i];
@@ -391,8 +666,15 @@ namespace vkBasalt
                 attachmentDescription.samples = VK_SAMPLE_COUNT_1_BIT;
                 attachmentDescription.loadOp  = pass.clear_render_targets
                                                    ? VK_ATTACHMENT_LOAD_OP_CLEAR
-                                                   : pass.blend_enable ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-                attachmentDescription.storeOp        = VK_ATTACHMENT_STORE_OP_STORE;
+                                                   : loadTargets[passIndex][i] ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+                attachmentDescription.storeOp = storeTargets[passIndex][i] ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+                // a skipped pass must leave its targets as they were, so it loads and stores them and clears inside the pass instead,
+                // with don't care the render pass would still make the targets undefined while the draws get skipped
+                if (amortized)
+                {
+                    attachmentDescription.loadOp  = VK_ATTACHMENT_LOAD_OP_LOAD;
+                    attachmentDescription.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+                }
                 attachmentDescription.stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
                 attachmentDescription.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
                 attachmentDescription.initialLayout  = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
@@ -401,7 +683,7 @@ namespace vkBasalt
                 if (target == "" && i == 0)
                 {
                     attachmentDescription.format        = pass.srgb_write_enable ? inputOutputFormatSRGB : inputOutputFormatUNORM;
-                    attachmentDescription.loadOp        = VK_ATTACHMENT_LOAD_OP_LOAD;
+                    attachmentDescription.loadOp        = loadTargets[passIndex][0] ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
                     attachmentDescription.storeOp       = VK_ATTACHMENT_STORE_OP_STORE;
                     attachmentDescription.initialLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
                     attachmentDescription.finalLayout   = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
@@ -457,7 +739,7 @@ namespace vkBasalt
 
             uint32_t depthAttachmentCount = 0;
 
-            if (scissor.extent.width == imageExtent.width && scissor.extent.height == imageExtent.height)
+            if (hasStencilAttachment(pass))
             {
                 depthAttachmentCount = 1;
 
@@ -476,12 +758,18 @@ namespace vkBasalt
                 attachmentDescription.loadOp         = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
                 attachmentDescription.storeOp        = VK_ATTACHMENT_STORE_OP_DONT_CARE;
                 attachmentDescription.stencilLoadOp  = firstTimeStencilAccess ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD;
-                attachmentDescription.stencilStoreOp = VK_ATTACHMENT_STORE_OP_STORE;
                 attachmentDescription.initialLayout  = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
                 attachmentDescription.finalLayout    = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
                 firstTimeStencilAccess = false;
 
+                // the stencil gets cleared every frame, so it only has to be stored for a later pass that tests against it
+                bool stencilReadLater =
+                    std::any_of(module.techniques[0].passes.begin() + passIndex + 1, module.techniques[0].passes.end(), [&](const auto& laterPass) {
+                        return laterPass.stencil_enable && hasStencilAttachment(laterPass);
+                    });
+                attachmentDescription.stencilStoreOp = stencilReadLater ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+
                 attachmentDescriptions.push_back(attachmentDescription);
             }
 
@@ -519,22 +807,44 @@ namespace vkBasalt
             renderPassCreateInfo.dependencyCount = 1;
             renderPassCreateInfo.pDependencies   = &subpassDependency;
 
-            VkRenderPass renderPass;
-            VkResult     result = pLogicalDevice->vkd.CreateRenderPass(pLogicalDevice->device, &renderPassCreateInfo, nullptr, &renderPass);
-            ASSERT_VULKAN(result);
-            renderPasses.push_back(renderPass);
+            // with dynamic rendering the attachments are rendered to directly, the pipeline only needs their formats
+            VkRenderPass                     renderPass = VK_NULL_HANDLE;
+            std::vector<VkFormat>            colorFormats;
+            VkPipelineRenderingCreateInfoKHR renderingCreateInfo;
+            DynamicRenderingPass             renderingPass;
 
-            VkRenderPassBeginInfo renderPassBeginInfo;
-            renderPassBeginInfo.sType           = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-            renderPassBeginInfo.pNext           = nullptr;
-            renderPassBeginInfo.renderPass      = renderPass;
-            renderPassBeginInfo.framebuffer     = VK_NULL_HANDLE; // changed at apply time
-            renderPassBeginInfo.renderArea      = scissor;
-            renderPassBeginInfo.clearValueCount = attachmentDescriptions.size();
-            VkClearValue clearValues[9]         = {};
-            renderPassBeginInfo.pClearValues    = clearValues;
+            if (pLogicalDevice->supportsDynamicRendering)
+            {
+                for (size_t j = 0; j < attachmentDescriptions.size() - depthAttachmentCount; j++)
+                {
+                    colorFormats.push_back(attachmentDescriptions[j].format);
+                    renderingPass.loadOps.push_back(attachmentDescriptions[j].loadOp);
+                    renderingPass.storeOps.push_back(attachmentDescriptions[j].storeOp);
+                }
+                renderingCreateInfo = getPipelineRenderingCreateInfo(colorFormats, depthAttachmentCount ? stencilFormat : VK_FORMAT_UNDEFINED);
 
-            renderPassBeginInfos.push_back(renderPassBeginInfo);
+                renderingPass.renderArea     = scissor;
+                renderingPass.useStencil     = depthAttachmentCount;
+                renderingPass.stencilLoadOp  = depthAttachmentCount ? attachmentDescriptions.back().stencilLoadOp : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+                renderingPass.stencilStoreOp = depthAttachmentCount ? attachmentDescriptions.back().stencilStoreOp : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            }
+            else
+            {
+                renderPass = getCachedRenderPass(pLogicalDevice, renderPassCreateInfo);
+                renderPasses.push_back(renderPass);
+
+                VkRenderPassBeginInfo renderPassBeginInfo;
+                renderPassBeginInfo.sType           = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+                renderPassBeginInfo.pNext           = nullptr;
+                renderPassBeginInfo.renderPass      = renderPass;
+                renderPassBeginInfo.framebuffer     = VK_NULL_HANDLE; // changed at apply time
+                renderPassBeginInfo.renderArea      = scissor;
+                renderPassBeginInfo.clearValueCount = attachmentDescriptions.size();
+                VkClearValue clearValues[9]         = {};
+                renderPassBeginInfo.pClearValues    = clearValues;
+
+                renderPassBeginInfos.push_back(renderPassBeginInfo);
+            }
 
             // framebuffers
 
@@ -542,20 +852,43 @@ namespace vkBasalt
             {
                 std::vector<VkImageView> backBufferImageViews = pass.srgb_write_enable ? backBufferImageViewsSRGB : backBufferImageViewsUNORM;
                 std::vector<VkImageView> outputImageViews     = pass.srgb_write_enable ? outputImageViewsSRGB : outputImageViewsUNORM;
-                framebuffers.push_back(createFramebuffers(
-                    pLogicalDevice,
-                    renderPass,
-                    imageExtent,
-                    {outputToBackBuffer ? backBufferImageViews : outputImageViews, std::vector<VkImageView>(inputImages.size(), stencilImageView)}));
+                if (renderPass == VK_NULL_HANDLE)
+                {
+                    renderingPass.images     = {outputToBackBuffer ? backBufferImages : outputImages};
+                    renderingPass.imageViews = {outputToBackBuffer ? backBufferImageViews : outputImageViews};
+                }
+                else
+                {
+                    // the stencil attachment, if there is one, stays where it is
+                    attachmentImageViews[0] = outputToBackBuffer ? backBufferImageViews : outputImageViews;
+                    framebuffers.push_back(createFramebuffers(pLogicalDevice, renderPass, imageExtent, attachmentImageViews));
+                }
                 outputToBackBuffer = !outputToBackBuffer;
                 switchSamplers.push_back(true);
             }
             else
             {
-                framebuffers.push_back(createFramebuffers(pLogicalDevice, renderPass, scissor.extent, attachmentImageViews));
+                if (renderPass == VK_NULL_HANDLE)
+                {
+                    for (auto& target : currentRenderTargets)
+                    {
+                        renderingPass.images.push_back(std::vector<VkImage>(inputImages.size(), textureImages[target][0]));
+                    }
+                    renderingPass.imageViews = attachmentImageViews;
+                    renderingPass.imageViews.resize(currentRenderTargets.size());
+                }
+                else
+                {
+                    framebuffers.push_back(createFramebuffers(pLogicalDevice, renderPass, scissor.extent, attachmentImageViews));
+                }
                 switchSamplers.push_back(false);
             }
 
+            if (renderPass == VK_NULL_HANDLE)
+            {
+                renderingPasses.push_back(renderingPass);
+            }
+
             // pipeline
 
             // Configure effect
@@ -711,12 +1044,15 @@ namespace vkBasalt
             colorBlendCreateInfo.blendConstants[2] = 0.0f;
             colorBlendCreateInfo.blendConstants[3] = 0.0f;
 
+            // the scissor of passes that render to the back buffer follows the content rectangle
+            VkDynamicState dynamicStates[] = {VK_DYNAMIC_STATE_SCISSOR};
+
             VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo;
             dynamicStateCreateInfo.sType             = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
             dynamicStateCreateInfo.pNext             = nullptr;
             dynamicStateCreateInfo.flags             = 0;
-            dynamicStateCreateInfo.dynamicStateCount = 0;
-            dynamicStateCreateInfo.pDynamicStates    = nullptr;
+            dynamicStateCreateInfo.dynamicStateCount = 1;
+            dynamicStateCreateInfo.pDynamicStates    = dynamicStates;
 
             VkPipelineDepthStencilStateCreateInfo depthStencilStateCreateInfo = {};
 
@@ -740,7 +1076,7 @@ namespace vkBasalt
 
             VkGraphicsPipelineCreateInfo pipelineCreateInfo;
             pipelineCreateInfo.sType               = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-            pipelineCreateInfo.pNext               = nullptr;
+            pipelineCreateInfo.pNext               = renderPass == VK_NULL_HANDLE ? &renderingCreateInfo : nullptr;
             pipelineCreateInfo.flags               = 0;
             pipelineCreateInfo.stageCount          = 2;
             pipelineCreateInfo.pStages             = shaderStages;
@@ -760,7 +1096,7 @@ namespace vkBasalt
             pipelineCreateInfo.basePipelineIndex   = -1;
 
             VkPipeline pipeline;
-            result = pLogicalDevice->vkd.CreateGraphicsPipelines(pLogicalDevice->device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &pipeline);
+            VkResult result = pLogicalDevice->vkd.CreateGraphicsPipelines(pLogicalDevice->device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &pipeline);
             ASSERT_VULKAN(result);
 
             graphicsPipelines.push_back(pipeline);
@@ -768,11 +1104,49 @@ namespace vkBasalt
             Logger::debug("vertex   entry: " + pass.vs_entry_point);
             Logger::debug("fragment entry: " + pass.ps_entry_point);
         }
+
+        // a pass can not sample its own render targets, so if the next pass writes the same target the mip maps would be wasted
+        for (size_t i = 0; i < renderTargets.size(); i++)
+        {
+            mipMapTargets.emplace_back();
+            for (auto& renderTarget : renderTargets[i])
+            {
+                bool writtenNext = i + 1 < renderTargets.size()
+                                   && std::find(renderTargets[i + 1].begin(), renderTargets[i + 1].end(), renderTarget) != renderTargets[i + 1].end();
+                if (mipMappedTextures.count(renderTarget) && !writtenNext)
+                {
+                    mipMapTargets.back().push_back(renderTarget);
+                }
+            }
+        }
+        if (std::find(amortizedPasses.begin(), amortizedPasses.end(), true) != amortizedPasses.end())
+        {
+            createBuffer(pLogicalDevice,
+                         inputImages.size() * sizeof(uint32_t),
+                         VK_BUFFER_USAGE_CONDITIONAL_RENDERING_BIT_EXT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         updatePredicateBuffer,
+                         updatePredicateMemory);
+
+            void*    data;
+            VkResult result = pLogicalDevice->vkd.MapMemory(pLogicalDevice->device, updatePredicateMemory, 0, VK_WHOLE_SIZE, 0, &data);
+            ASSERT_VULKAN(result);
+            pUpdatePredicates = static_cast<uint32_t*>(data);
+            std::fill(pUpdatePredicates, pUpdatePredicates + inputImages.size(), 1);
+            Logger::debug("running texture passes every " + std::to_string(updateInterval) + " frames");
+        }
         Logger::debug("finished creating Reshade effect");
     }
 
-    void ReshadeEffect::updateEffect()
+    void ReshadeEffect::updateEffect(uint32_t imageIndex)
     {
+        // the last submission for this image has finished, its fence got waited on, so its predicate is free to change
+        if (pUpdatePredicates)
+        {
+            pUpdatePredicates[imageIndex] = frameCount % updateInterval == 0;
+        }
+        frameCount++;
+
         if (bufferSize)
         {
             void*    data;
@@ -786,16 +1160,31 @@ namespace vkBasalt
         }
     }
 
-    void ReshadeEffect::useDepthImage(VkImageView depthImageView)
+    void ReshadeEffect::useDepthImage(uint32_t imageIndex, VkImageView depthImageView)
     {
-        std::vector<std::string> depthTextureNames;
+        // Use a input image if there is no depth image to prevent a crash
+        VkImageView imageView = depthImageView ? depthImageView : inputImageViewsUNORM[imageIndex];
 
-        for (auto& texture : module.textures)
+        // with the descriptor heap the depth samplers keep their slots, only the image view in them changes
+        if (pDescriptorHeap)
         {
-            if (texture.semantic == "DEPTH")
+            std::vector<uint32_t>    slots;
+            std::vector<VkSampler>   slotSamplers;
+            std::vector<VkImageView> slotImageViews;
+            for (size_t i = 0; i < depthSamplerSlots.size(); i++)
             {
-                depthTextureNames.push_back(texture.unique_name);
+                if (!depthSamplerSlots[i].empty())
+                {
+                    slots.push_back(depthSamplerSlots[i][imageIndex]);
+                    slotSamplers.push_back(samplers[i]);
+                    slotImageViews.push_back(imageView);
+                }
             }
+            if (!slots.empty())
+            {
+                writeDescriptorSlots(pLogicalDevice, slots, slotSamplers, slotImageViews);
+            }
+            return;
         }
 
         for (size_t i = 0; i < module.samplers.size(); i++)
@@ -805,39 +1194,34 @@ namespace vkBasalt
             {
                 if (info.texture_name == name)
                 {
-                    for (uint32_t j = 0; j < inputImages.size(); j++)
+                    VkDescriptorImageInfo imageInfo;
+                    imageInfo.sampler     = samplers[i];
+                    imageInfo.imageView   = imageView;
+                    imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+                    VkWriteDescriptorSet writeDescriptorSet = {};
+
+                    writeDescriptorSet.sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                    writeDescriptorSet.pNext            = nullptr;
+                    writeDescriptorSet.dstSet           = inputDescriptorSets[imageIndex];
+                    writeDescriptorSet.dstBinding       = i;
+                    writeDescriptorSet.dstArrayElement  = 0;
+                    writeDescriptorSet.descriptorCount  = 1;
+                    writeDescriptorSet.descriptorType   = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+                    writeDescriptorSet.pImageInfo       = &imageInfo;
+                    writeDescriptorSet.pBufferInfo      = nullptr;
+                    writeDescriptorSet.pTexelBufferView = nullptr;
+
+                    pLogicalDevice->vkd.UpdateDescriptorSets(pLogicalDevice->device, 1, &writeDescriptorSet, 0, nullptr);
+                    if (outputWrites > 1)
                     {
-                        VkDescriptorImageInfo imageInfo;
-                        imageInfo.sampler   = samplers[i];
-                        imageInfo.imageView = depthImageView
-                                                  ? depthImageView
-                                                  : inputImageViewsUNORM[j]; // Use a input image if there is no depth image to prevent a crash
-                        imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-
-                        VkWriteDescriptorSet writeDescriptorSet = {};
-
-                        writeDescriptorSet.sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-                        writeDescriptorSet.pNext            = nullptr;
-                        writeDescriptorSet.dstSet           = inputDescriptorSets[j];
-                        writeDescriptorSet.dstBinding       = i;
-                        writeDescriptorSet.dstArrayElement  = 0;
-                        writeDescriptorSet.descriptorCount  = 1;
-                        writeDescriptorSet.descriptorType   = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-                        writeDescriptorSet.pImageInfo       = &imageInfo;
-                        writeDescriptorSet.pBufferInfo      = nullptr;
-                        writeDescriptorSet.pTexelBufferView = nullptr;
-
+                        writeDescriptorSet.dstSet = backBufferDescriptorSets[imageIndex];
+                        pLogicalDevice->vkd.UpdateDescriptorSets(pLogicalDevice->device, 1, &writeDescriptorSet, 0, nullptr);
+                    }
+                    if (outputWrites > 2)
+                    {
+                        writeDescriptorSet.dstSet = outputDescriptorSets[imageIndex];
                         pLogicalDevice->vkd.UpdateDescriptorSets(pLogicalDevice->device, 1, &writeDescriptorSet, 0, nullptr);
-                        if (outputWrites > 1)
-                        {
-                            writeDescriptorSet.dstSet = backBufferDescriptorSets[j];
-                            pLogicalDevice->vkd.UpdateDescriptorSets(pLogicalDevice->device, 1, &writeDescriptorSet, 0, nullptr);
-                        }
-                        if (outputWrites > 2)
-                        {
-                            writeDescriptorSet.dstSet = outputDescriptorSets[j];
-                            pLogicalDevice->vkd.UpdateDescriptorSets(pLogicalDevice->device, 1, &writeDescriptorSet, 0, nullptr);
-                        }
                     }
                     break;
                 }
@@ -892,6 +1276,8 @@ namespace vkBasalt
             commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarrier);
         if (outputWrites > 1)
         {
+            // the back buffer is shared with the other swapchain images,
+            // bottom of pipe as source also waits for the last frame to be done with it
             memoryBarrier.image = backBufferImages[imageIndex];
             pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer,
                                                    VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
@@ -905,29 +1291,54 @@ namespace vkBasalt
                                                    &memoryBarrier);
         }
 
-        // stencil image
-        memoryBarrier.image                       = stencilImage;
-        memoryBarrier.srcAccessMask               = 0;
-        memoryBarrier.dstAccessMask               = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-        memoryBarrier.oldLayout                   = VK_IMAGE_LAYOUT_UNDEFINED;
-        memoryBarrier.newLayout                   = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-        memoryBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_STENCIL_BIT | VK_IMAGE_ASPECT_DEPTH_BIT;
+        // stencil image, only there if a pass uses it
+        if (stencilImage != VK_NULL_HANDLE)
+        {
+            memoryBarrier.image                       = stencilImage;
+            memoryBarrier.srcAccessMask               = 0;
+            memoryBarrier.dstAccessMask               = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            memoryBarrier.oldLayout                   = VK_IMAGE_LAYOUT_UNDEFINED;
+            memoryBarrier.newLayout                   = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+            memoryBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_STENCIL_BIT | VK_IMAGE_ASPECT_DEPTH_BIT;
 
-        pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer,
-                                               VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
-                                               VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
-                                               0,
-                                               0,
-                                               nullptr,
-                                               0,
-                                               nullptr,
-                                               1,
-                                               &memoryBarrier);
+            pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer,
+                                                   VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                                                   VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+                                                   0,
+                                                   0,
+                                                   nullptr,
+                                                   0,
+                                                   nullptr,
+                                                   1,
+                                                   &memoryBarrier);
+        }
 
         Logger::debug("after the first pipeline barrier");
 
-        pLogicalDevice->vkd.CmdBindDescriptorSets(
-            commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 1, 1, &(inputDescriptorSets[imageIndex]), 0, nullptr);
+        // with the descriptor heap the set stays bound and switching the images of the samplers only pushes new slots
+        auto bindSamplers = [&](const std::vector<VkDescriptorSet>& descriptorSets, const std::vector<std::vector<uint32_t>>& samplerSlots) {
+            if (!pDescriptorHeap)
+            {
+                pLogicalDevice->vkd.CmdBindDescriptorSets(
+                    commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 1, 1, &(descriptorSets[imageIndex]), 0, nullptr);
+            }
+            else if (!samplers.empty())
+            {
+                pLogicalDevice->vkd.CmdPushConstants(commandBuffer,
+                                                     pipelineLayout,
+                                                     VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                                                     0,
+                                                     samplerSlots[imageIndex].size() * sizeof(uint32_t),
+                                                     samplerSlots[imageIndex].data());
+            }
+        };
+
+        if (pDescriptorHeap)
+        {
+            pLogicalDevice->vkd.CmdBindDescriptorSets(
+                commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 1, 1, &pDescriptorHeap->set, 0, nullptr);
+        }
+        bindSamplers(inputDescriptorSets, inputSamplerSlots);
         Logger::debug("after binding image sampler");
 
         if (bufferSize)
@@ -940,40 +1351,139 @@ namespace vkBasalt
         bool backBufferNext = outputWrites % 2 == 0;
         for (size_t i = 0; i < graphicsPipelines.size(); i++)
         {
-            renderPassBeginInfos[i].framebuffer = framebuffers[i][imageIndex];
+            // the attachments of this pass for the current swapchain image
+            std::vector<VkImage>     renderingImages;
+            std::vector<VkImageView> renderingImageViews;
+
+            // barriers and load ops happen either way, but the draws, clears and compute mip maps only run on update frames
+            if (amortizedPasses[i])
+            {
+                VkConditionalRenderingBeginInfoEXT conditionalRenderingBeginInfo;
+                conditionalRenderingBeginInfo.sType  = VK_STRUCTURE_TYPE_CONDITIONAL_RENDERING_BEGIN_INFO_EXT;
+                conditionalRenderingBeginInfo.pNext  = nullptr;
+                conditionalRenderingBeginInfo.buffer = updatePredicateBuffer;
+                conditionalRenderingBeginInfo.offset = imageIndex * sizeof(uint32_t);
+                conditionalRenderingBeginInfo.flags  = 0;
+                pLogicalDevice->vkd.CmdBeginConditionalRenderingEXT(commandBuffer, &conditionalRenderingBeginInfo);
+            }
 
             Logger::debug("before beginn renderpass");
-            pLogicalDevice->vkd.CmdBeginRenderPass(commandBuffer, &renderPassBeginInfos[i], VK_SUBPASS_CONTENTS_INLINE);
+            if (pLogicalDevice->supportsDynamicRendering)
+            {
+                DynamicRenderingPass& renderingPass = renderingPasses[i];
+                for (size_t j = 0; j < renderingPass.images.size(); j++)
+                {
+                    renderingImages.push_back(renderingPass.images[j][imageIndex]);
+                    renderingImageViews.push_back(renderingPass.imageViews[j][imageIndex]);
+                }
+                beginRendering(pLogicalDevice,
+                               commandBuffer,
+                               renderingPass.renderArea,
+                               renderingImages,
+                               renderingImageViews,
+                               renderingPass.loadOps,
+                               VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                               VkClearValue{},
+                               renderingPass.useStencil ? stencilImageView : VK_NULL_HANDLE,
+                               renderingPass.stencilLoadOp,
+                               renderingPass.storeOps,
+                               renderingPass.stencilStoreOp);
+            }
+            else
+            {
+                renderPassBeginInfos[i].framebuffer = framebuffers[i][imageIndex];
+                pLogicalDevice->vkd.CmdBeginRenderPass(commandBuffer, &renderPassBeginInfos[i], VK_SUBPASS_CONTENTS_INLINE);
+            }
             Logger::debug("after beginn renderpass");
 
             pLogicalDevice->vkd.CmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipelines[i]);
             Logger::debug("after bind pipeliene");
 
+            VkRect2D renderArea = renderingPasses.empty() ? renderPassBeginInfos[i].renderArea : renderingPasses[i].renderArea;
+
+            // the back buffer only gets rendered inside the content rectangle, the borders get cleared instead
+            if (module.techniques[0].passes[i].render_target_names[0] == "")
+            {
+                pLogicalDevice->vkd.CmdSetScissor(commandBuffer, 0, 1, &contentRect);
+
+                std::vector<VkClearRect> borderClearRects;
+                for (auto& borderRect : getBorderRects(imageExtent, contentRect))
+                {
+                    borderClearRects.push_back({borderRect, 0, 1});
+                }
+                if (!borderClearRects.empty())
+                {
+                    VkClearAttachment clearAttachment;
+                    clearAttachment.aspectMask      = VK_IMAGE_ASPECT_COLOR_BIT;
+                    clearAttachment.colorAttachment = 0;
+                    clearAttachment.clearValue      = {{{0.0f, 0.0f, 0.0f, 1.0f}}};
+                    pLogicalDevice->vkd.CmdClearAttachments(
+                        commandBuffer, 1, &clearAttachment, borderClearRects.size(), borderClearRects.data());
+                }
+            }
+            else
+            {
+                pLogicalDevice->vkd.CmdSetScissor(commandBuffer, 0, 1, &renderArea);
+            }
+
+            if (amortizedPasses[i] && module.techniques[0].passes[i].clear_render_targets)
+            {
+                std::vector<VkClearAttachment> clearAttachments(renderTargets[i].size());
+                for (uint32_t j = 0; j < clearAttachments.size(); j++)
+                {
+                    clearAttachments[j].aspectMask      = VK_IMAGE_ASPECT_COLOR_BIT;
+                    clearAttachments[j].colorAttachment = j;
+                    clearAttachments[j].clearValue      = {};
+                }
+                VkClearRect clearRect;
+                clearRect.rect           = renderArea;
+                clearRect.baseArrayLayer = 0;
+                clearRect.layerCount     = 1;
+                pLogicalDevice->vkd.CmdClearAttachments(commandBuffer, clearAttachments.size(), clearAttachments.data(), 1, &clearRect);
+            }
+
             pLogicalDevice->vkd.CmdDraw(commandBuffer, module.techniques[0].passes[i].num_vertices, 1, 0, 0);
             Logger::debug("after draw");
 
-            pLogicalDevice->vkd.CmdEndRenderPass(commandBuffer);
+            if (pLogicalDevice->supportsDynamicRendering)
+            {
+                endRendering(pLogicalDevice, commandBuffer, renderingImages, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            }
+            else
+            {
+                pLogicalDevice->vkd.CmdEndRenderPass(commandBuffer);
+            }
             Logger::debug("after end renderpass");
 
             if (switchSamplers[i] && outputWrites > 1)
             {
                 if (backBufferNext)
                 {
-                    pLogicalDevice->vkd.CmdBindDescriptorSets(
-                        commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 1, 1, &(backBufferDescriptorSets[imageIndex]), 0, nullptr);
+                    bindSamplers(backBufferDescriptorSets, backBufferSamplerSlots);
                 }
                 else if (outputWrites > 2)
                 {
-                    pLogicalDevice->vkd.CmdBindDescriptorSets(
-                        commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 1, 1, &(outputDescriptorSets[imageIndex]), 0, nullptr);
+                    bindSamplers(outputDescriptorSets, outputSamplerSlots);
                 }
                 backBufferNext = !backBufferNext;
             }
 
-            for (auto& renderTarget : renderTargets[i])
+            for (auto& renderTarget : mipMapTargets[i])
             {
-                generateMipMaps(
-                    pLogicalDevice, commandBuffer, textureImages[renderTarget][0], textureExtents[renderTarget], textureMipLevels[renderTarget]);
+                if (computeMipMapTextures.count(renderTarget))
+                {
+                    mipMapGenerator->generate(commandBuffer, textureImages[renderTarget][0]);
+                }
+                else
+                {
+                    generateMipMaps(
+                        pLogicalDevice, commandBuffer, textureImages[renderTarget][0], textureExtents[renderTarget], textureMipLevels[renderTarget]);
+                }
+            }
+
+            if (amortizedPasses[i])
+            {
+                pLogicalDevice->vkd.CmdEndConditionalRenderingEXT(commandBuffer);
             }
         }
         pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer,
@@ -1003,6 +1513,9 @@ namespace vkBasalt
     ReshadeEffect::~ReshadeEffect()
     {
         Logger::debug("destroying ReshadeEffect" + convertToString(this));
+        // the mip map views have to go before the images
+        mipMapGenerator.reset();
+
         for (auto& pipeline : graphicsPipelines)
         {
             pLogicalDevice->vkd.DestroyPipeline(pLogicalDevice->device, pipeline, nullptr);
@@ -1013,15 +1526,35 @@ namespace vkBasalt
             pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, stagingBufferMemory, nullptr);
             pLogicalDevice->vkd.DestroyBuffer(pLogicalDevice->device, stagingBuffer, nullptr);
         }
+        if (updatePredicateBuffer != VK_NULL_HANDLE)
+        {
+            pLogicalDevice->vkd.DestroyBuffer(pLogicalDevice->device, updatePredicateBuffer, nullptr);
+            pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, updatePredicateMemory, nullptr);
+        }
 
-        pLogicalDevice->vkd.DestroyPipelineLayout(pLogicalDevice->device, pipelineLayout, nullptr);
+        releaseCachedObject<VK_OBJECT_TYPE_PIPELINE_LAYOUT>(pLogicalDevice, pipelineLayout);
         for (auto& renderPass : renderPasses)
         {
-            pLogicalDevice->vkd.DestroyRenderPass(pLogicalDevice->device, renderPass, nullptr);
+            releaseCachedObject<VK_OBJECT_TYPE_RENDER_PASS>(pLogicalDevice, renderPass);
         }
 
-        pLogicalDevice->vkd.DestroyDescriptorSetLayout(pLogicalDevice->device, imageSamplerDescriptorSetLayout, nullptr);
-        pLogicalDevice->vkd.DestroyDescriptorSetLayout(pLogicalDevice->device, uniformDescriptorSetLayout, nullptr);
+        // the layout of the descriptor heap belongs to the device
+        if (!pDescriptorHeap)
+        {
+            releaseCachedObject<VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT>(pLogicalDevice, imageSamplerDescriptorSetLayout);
+        }
+        releaseCachedObject<VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT>(pLogicalDevice, uniformDescriptorSetLayout);
+        for (auto& descriptorSlot : descriptorSlots)
+        {
+            freeDescriptorSlot(pLogicalDevice, descriptorSlot.second);
+        }
+        for (auto& slots : depthSamplerSlots)
+        {
+            for (auto& slot : slots)
+            {
+                freeDescriptorSlot(pLogicalDevice, slot);
+            }
+        }
 
         pLogicalDevice->vkd.DestroyShaderModule(pLogicalDevice->device, shaderModule, nullptr);
 
@@ -1035,13 +1568,10 @@ namespace vkBasalt
             pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, imageView, nullptr);
         }
 
-        for (auto& imageView : backBufferImageViewsSRGB)
+        if (!backBufferImages.empty())
         {
-            pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, imageView, nullptr);
-        }
-        for (auto& imageView : backBufferImageViewsUNORM)
-        {
-            pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, imageView, nullptr);
+            pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, backBufferImageViewsSRGB[0], nullptr);
+            pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, backBufferImageViewsUNORM[0], nullptr);
         }
 
         for (auto& fbs : framebuffers)
@@ -1084,6 +1614,18 @@ namespace vkBasalt
             }
         }
 
+        // the views of source textures and pooled render targets belong to the texture cache
+        std::set<VkImage> cachedImages;
+        for (auto& textures : {sourceTextures, pooledTextures})
+        {
+            for (auto& texture : textures)
+            {
+                imageViewSet.erase(texture->imageViewUNORM);
+                imageViewSet.erase(texture->imageViewSRGB);
+                cachedImages.insert(texture->image);
+            }
+        }
+
         for (auto imageView : imageViewSet)
         {
             pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, imageView, nullptr);
@@ -1094,20 +1636,23 @@ namespace vkBasalt
         {
             for (auto image : it.second)
             {
-                pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, image, nullptr);
+                if (!cachedImages.count(image))
+                {
+                    pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, image, nullptr);
+                }
             }
         }
 
-        for (auto& image : backBufferImages)
+        if (!backBufferImages.empty())
         {
-            pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, image, nullptr);
+            pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, backBufferImages[0], nullptr);
         }
 
         pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, stencilImage, nullptr);
 
         for (auto& sampler : samplers)
         {
-            pLogicalDevice->vkd.DestroySampler(pLogicalDevice->device, sampler, nullptr);
+            releaseCachedObject<VK_OBJECT_TYPE_SAMPLER>(pLogicalDevice, sampler);
         }
 
         for (auto& memory : textureMemory)
@@ -1147,8 +1692,12 @@ namespace vkBasalt
             Logger::err(errors);
         }
 
-        std::unique_ptr<reshadefx::codegen> codegen(reshadefx::create_codegen_spirv(
-            true /* vulkan semantics */, true /* debug info */, true /* uniforms to spec constants */, true /*flip vertex shader*/));
+        // with a descriptor heap the samplers become slots of the shared descriptor array
+        std::unique_ptr<reshadefx::codegen> codegen(reshadefx::create_codegen_spirv(true /* vulkan semantics */,
+                                                                                    true /* debug info */,
+                                                                                    true /* uniforms to spec constants */,
+                                                                                    true /*flip vertex shader*/,
+                                                                                    pDescriptorHeap ? pDescriptorHeap->capacity : 0));
         parser.parse(std::move(preprocessor.output()), codegen.get());
 
         errors = parser.errors();
@@ -1158,6 +1707,15 @@ namespace vkBasalt
         }
         codegen->write_result(module);
 
+        // the slot of every sampler has to fit into the push constants
+        if (pDescriptorHeap && module.num_sampler_bindings * sizeof(uint32_t) > pDescriptorHeap->maxPushConstantsSize)
+        {
+            Logger::debug("too many samplers for the descriptor heap, using descriptor sets instead");
+            pDescriptorHeap = nullptr;
+            module          = reshadefx::module();
+            return createReshadeModule();
+        }
+
         VkShaderModuleCreateInfo shaderCreateInfo;
         shaderCreateInfo.sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
         shaderCreateInfo.pNext    = nullptr;
@@ -1171,6 +1729,29 @@ namespace vkBasalt
         Logger::debug("created reshade shaderModule");
     }
 
+    bool ReshadeEffect::rebindsDepthImageInPlace()
+    {
+        // without the heap the depth image is part of descriptor sets that recorded command buffers use
+        return pDescriptorHeap || depthTextureNames.empty();
+    }
+
+    void ReshadeEffect::setContentRect(VkRect2D contentRect)
+    {
+        this->contentRect = contentRect;
+    }
+
+    uint32_t ReshadeEffect::getDescriptorSlot(VkSampler sampler, VkImageView imageView)
+    {
+        auto it = descriptorSlots.find({sampler, imageView});
+        if (it != descriptorSlots.end())
+        {
+            return it->second;
+        }
+        uint32_t slot                         = allocateDescriptorSlot(pLogicalDevice, sampler, imageView);
+        descriptorSlots[{sampler, imageView}] = slot;
+        return slot;
+    }
+
     VkFormat ReshadeEffect::convertReshadeFormat(reshadefx::texture_format texFormat)
     {
         switch (texFormat)
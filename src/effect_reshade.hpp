@@ -6,6 +6,8 @@
 #include <iostream>
 #include <vector>
 #include <unordered_map>
+#include <set>
+#include <map>
 #include <memory>
 
 #include "vulkan_include.hpp"
@@ -15,6 +17,9 @@
 #include "reshade_uniforms.hpp"
 
 #include "logical_device.hpp"
+#include "texture_cache.hpp"
+#include "descriptor_heap.hpp"
+#include "mipmap.hpp"
 
 #include "reshade/effect_parser.hpp"
 #include "reshade/effect_codegen.hpp"
@@ -22,6 +27,20 @@
 
 namespace vkBasalt
 {
+    // the attachments of a pass that gets recorded with dynamic rendering instead of a render pass
+    struct DynamicRenderingPass
+    {
+        VkRect2D                         renderArea;
+        std::vector<VkAttachmentLoadOp>  loadOps;
+        std::vector<VkAttachmentStoreOp> storeOps;
+        // per attachment and swapchain image
+        std::vector<std::vector<VkImage>>     images;
+        std::vector<std::vector<VkImageView>> imageViews;
+        bool                                  useStencil;
+        VkAttachmentLoadOp                    stencilLoadOp;
+        VkAttachmentStoreOp                   stencilStoreOp;
+    };
+
     class ReshadeEffect : public Effect
     {
     public:
@@ -31,10 +50,13 @@ namespace vkBasalt
                       std::vector<VkImage> inputImages,
                       std::vector<VkImage> outputImages,
                       Config*              pConfig,
-                      std::string          effectName);
+                      std::string          effectName,
+                      uint32_t             updateInterval = 1);
         void virtual applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer) override;
-        void virtual updateEffect() override;
-        void virtual useDepthImage(VkImageView depthImageView) override;
+        void virtual updateEffect(uint32_t imageIndex) override;
+        void virtual useDepthImage(uint32_t imageIndex, VkImageView depthImageView) override;
+        bool virtual rebindsDepthImageInPlace() override;
+        void virtual setContentRect(VkRect2D contentRect) override;
         virtual ~ReshadeEffect();
 
     private:
@@ -61,6 +83,17 @@ namespace vkBasalt
         std::vector<VkDescriptorSet> outputDescriptorSets;
         std::vector<VkDescriptorSet> backBufferDescriptorSets;
 
+        // set if the samplers index the descriptor heap of the device through push constants instead of using descriptor sets
+        DescriptorHeap* pDescriptorHeap = nullptr;
+        // per swapchain image the heap slot of every sampler, like the descriptor sets above
+        std::vector<std::vector<uint32_t>> inputSamplerSlots;
+        std::vector<std::vector<uint32_t>> outputSamplerSlots;
+        std::vector<std::vector<uint32_t>> backBufferSamplerSlots;
+        // one slot per distinct sampler and image view
+        std::map<std::pair<VkSampler, VkImageView>, uint32_t> descriptorSlots;
+        // per sampler the slots of every swapchain image that useDepthImage rewrites, empty for samplers of other textures
+        std::vector<std::vector<uint32_t>> depthSamplerSlots;
+
         std::vector<std::vector<VkFramebuffer>> framebuffers;
 
         VkDescriptorSetLayout                 uniformDescriptorSetLayout;
@@ -70,21 +103,33 @@ namespace vkBasalt
         std::vector<VkRenderPass>             renderPasses;
         std::vector<std::vector<std::string>> renderTargets;
         std::vector<VkRenderPassBeginInfo>    renderPassBeginInfos;
+        std::vector<DynamicRenderingPass>     renderingPasses;
         VkPipelineLayout                      pipelineLayout;
         std::vector<VkPipeline>               graphicsPipelines;
         std::vector<bool>                     switchSamplers;
+        // render targets that need new mip maps after each pass
+        std::vector<std::vector<std::string>> mipMapTargets;
         VkExtent2D                            imageExtent;
+        // only limits the passes that render to the back buffer, passes that render to textures always cover them as a whole
+        VkRect2D                              contentRect;
         std::vector<VkSampler>                samplers;
+        std::vector<std::string>              depthTextureNames;
         Config*                               pConfig;
         std::string                           effectName;
         reshadefx::module                     module;
         std::vector<VkDeviceMemory>           textureMemory;
 
+        std::vector<std::shared_ptr<CachedTexture>> sourceTextures;
+        std::vector<std::shared_ptr<CachedTexture>> pooledTextures;
+
+        std::unique_ptr<MipMapGenerator> mipMapGenerator;
+        std::set<std::string>            computeMipMapTextures;
+
         VkFormat    inputOutputFormatUNORM;
         VkFormat    inputOutputFormatSRGB;
         VkFormat    stencilFormat;
-        VkImage     stencilImage;
-        VkImageView stencilImageView;
+        VkImage     stencilImage     = VK_NULL_HANDLE;
+        VkImageView stencilImageView = VK_NULL_HANDLE;
         // how often the shader writes to the reshade back buffer
         // we need to flip the "backbuffer" after each write if there is a next one
         int                      outputWrites = 0;
@@ -98,7 +143,17 @@ namespace vkBasalt
 
         std::vector<std::shared_ptr<ReshadeUniform>> uniforms;
 
+        // passes that only render to textures can run every updateInterval frames, the textures keep their content in between
+        // per swapchain image a conditional rendering predicate decides if they run, only set for an updateInterval above 1
+        uint32_t          updateInterval;
+        uint64_t          frameCount = 0;
+        std::vector<bool> amortizedPasses;
+        VkBuffer          updatePredicateBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory    updatePredicateMemory;
+        uint32_t*         pUpdatePredicates = nullptr;
+
         void          createReshadeModule();
+        uint32_t      getDescriptorSlot(VkSampler sampler, VkImageView imageView);
         VkFormat      convertReshadeFormat(reshadefx::texture_format texFormat);
         VkCompareOp   convertReshadeCompareOp(reshadefx::pass_stencil_func compareOp);
         VkStencilOp   convertReshadeStencilOp(reshadefx::pass_stencil_op stencilOp);
@@ -0,0 +1,109 @@
+#include "effect_scaled.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "effect_resample.hpp"
+#include "fake_swapchain.hpp"
+#include "logger.hpp"
+
+namespace vkBasalt
+{
+    ScaledEffect::ScaledEffect(LogicalDevice*           pLogicalDevice,
+                               VkSwapchainCreateInfoKHR swapchainCreateInfo,
+                               VkFormat                 format,
+                               float                    scale,
+                               std::vector<VkImage>     inputImages,
+                               std::vector<VkImage>     outputImages,
+                               Config*                  pConfig)
+    {
+        this->pLogicalDevice = pLogicalDevice;
+        this->imageCount     = inputImages.size();
+
+        imageExtent            = swapchainCreateInfo.imageExtent;
+        scaledExtent.width     = std::max(1u, (uint32_t) std::lround(imageExtent.width * scale));
+        scaledExtent.height    = std::max(1u, (uint32_t) std::lround(imageExtent.height * scale));
+        Logger::debug("scaled extent " + std::to_string(scaledExtent.width) + "x" + std::to_string(scaledExtent.height));
+
+        // the smaller images need the same formats and usage as the fake swapchain images the effect would have used
+        swapchainCreateInfo.imageExtent = scaledExtent;
+        scaledImages = createFakeSwapchainImages(pLogicalDevice, swapchainCreateInfo, 2, scaledImageMemory);
+
+        downsampleEffect =
+            std::shared_ptr<Effect>(new ResampleEffect(pLogicalDevice, format, scaledExtent, inputImages, getScaledInputImages(), pConfig));
+        upsampleEffect =
+            std::shared_ptr<Effect>(new ResampleEffect(pLogicalDevice, format, imageExtent, getScaledOutputImages(), outputImages, pConfig));
+        Logger::debug("created ScaledEffect");
+    }
+
+    void ScaledEffect::setEffect(std::shared_ptr<Effect> effect)
+    {
+        this->effect = effect;
+    }
+
+    VkExtent2D ScaledEffect::getScaledExtent()
+    {
+        return scaledExtent;
+    }
+
+    // the effects index their images per swapchain image, so the shared images get repeated
+    std::vector<VkImage> ScaledEffect::getScaledInputImages()
+    {
+        return std::vector<VkImage>(imageCount, scaledImages[0]);
+    }
+
+    std::vector<VkImage> ScaledEffect::getScaledOutputImages()
+    {
+        return std::vector<VkImage>(imageCount, scaledImages[1]);
+    }
+
+    void ScaledEffect::applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer)
+    {
+        downsampleEffect->applyEffect(imageIndex, commandBuffer);
+        effect->applyEffect(imageIndex, commandBuffer);
+        upsampleEffect->applyEffect(imageIndex, commandBuffer);
+    }
+
+    void ScaledEffect::updateEffect(uint32_t imageIndex)
+    {
+        effect->updateEffect(imageIndex);
+    }
+
+    void ScaledEffect::useDepthImage(uint32_t imageIndex, VkImageView depthImageView)
+    {
+        effect->useDepthImage(imageIndex, depthImageView);
+    }
+
+    bool ScaledEffect::rebindsDepthImageInPlace()
+    {
+        return effect->rebindsDepthImageInPlace();
+    }
+
+    void ScaledEffect::setContentRect(VkRect2D contentRect)
+    {
+        // rounded outwards, so that the smaller rectangle still covers all of the content
+        int32_t  left   = contentRect.offset.x * scaledExtent.width / imageExtent.width;
+        int32_t  top    = contentRect.offset.y * scaledExtent.height / imageExtent.height;
+        uint32_t right  = ((contentRect.offset.x + contentRect.extent.width) * scaledExtent.width + imageExtent.width - 1) / imageExtent.width;
+        uint32_t bottom = ((contentRect.offset.y + contentRect.extent.height) * scaledExtent.height + imageExtent.height - 1) / imageExtent.height;
+
+        VkRect2D scaledRect = {{left, top}, {std::min(right, scaledExtent.width) - left, std::min(bottom, scaledExtent.height) - top}};
+
+        downsampleEffect->setContentRect(scaledRect);
+        effect->setContentRect(scaledRect);
+        upsampleEffect->setContentRect(contentRect);
+    }
+
+    ScaledEffect::~ScaledEffect()
+    {
+        // the effects have views of the images
+        downsampleEffect.reset();
+        effect.reset();
+        upsampleEffect.reset();
+        for (auto& image : scaledImages)
+        {
+            pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, image, nullptr);
+        }
+        pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, scaledImageMemory, nullptr);
+    }
+} // namespace vkBasalt
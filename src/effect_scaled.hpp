@@ -0,0 +1,61 @@
+#ifndef EFFECT_SCALED_HPP_INCLUDED
+#define EFFECT_SCALED_HPP_INCLUDED
+#include <vector>
+#include <fstream>
+#include <string>
+#include <iostream>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+
+#include "vulkan_include.hpp"
+
+#include "effect.hpp"
+#include "config.hpp"
+
+#include "logical_device.hpp"
+
+namespace vkBasalt
+{
+    // runs an effect at a fraction of the swapchain size
+    // the input images get filtered down into smaller images, the effect renders between those and its output gets filtered back up
+    // the effect has to be created for getScaledExtent, getScaledInputImages and getScaledOutputImages and handed over with setEffect
+    // like the other intermediates, there is only one smaller input and output image that all swapchain images share,
+    // the effect does not keep its output between frames, so nothing has to survive until the same swapchain image comes again
+    class ScaledEffect : public Effect
+    {
+    public:
+        ScaledEffect(LogicalDevice*           pLogicalDevice,
+                     VkSwapchainCreateInfoKHR swapchainCreateInfo,
+                     VkFormat                 format,
+                     float                    scale,
+                     std::vector<VkImage>     inputImages,
+                     std::vector<VkImage>     outputImages,
+                     Config*                  pConfig);
+        void                 setEffect(std::shared_ptr<Effect> effect);
+        VkExtent2D           getScaledExtent();
+        std::vector<VkImage> getScaledInputImages();
+        std::vector<VkImage> getScaledOutputImages();
+
+        void virtual applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer) override;
+        void virtual updateEffect(uint32_t imageIndex) override;
+        void virtual useDepthImage(uint32_t imageIndex, VkImageView depthImageView) override;
+        bool virtual rebindsDepthImageInPlace() override;
+        void virtual setContentRect(VkRect2D contentRect) override;
+        virtual ~ScaledEffect();
+
+    private:
+        LogicalDevice*          pLogicalDevice;
+        VkExtent2D              imageExtent;
+        VkExtent2D              scaledExtent;
+        uint32_t                imageCount;
+        // the scaled input image followed by the scaled output image, in one allocation
+        std::vector<VkImage>    scaledImages;
+        VkDeviceMemory          scaledImageMemory;
+        std::shared_ptr<Effect> downsampleEffect;
+        std::shared_ptr<Effect> effect;
+        std::shared_ptr<Effect> upsampleEffect;
+    };
+} // namespace vkBasalt
+
+#endif // EFFECT_SCALED_HPP_INCLUDED
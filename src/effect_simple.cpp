@@ -10,10 +10,18 @@
 #include "framebuffer.hpp"
 #include "shader.hpp"
 #include "sampler.hpp"
+#include "object_cache.hpp"
+#include "letterbox.hpp"
 #include "util.hpp"
 
 namespace vkBasalt
 {
+    namespace
+    {
+        // the largest minUniformBufferOffsetAlignment that the spec allows
+        constexpr VkDeviceSize damageRectStride = 256;
+    } // namespace
+
     SimpleEffect::SimpleEffect()
     {
     }
@@ -29,10 +37,20 @@ namespace vkBasalt
         this->pLogicalDevice = pLogicalDevice;
         this->format         = format;
         this->imageExtent    = imageExtent;
+        this->contentRect    = {{0, 0}, imageExtent};
+        this->keepOutput     = false;
         this->inputImages    = inputImages;
         this->outputImages   = outputImages;
         this->pConfig        = pConfig;
 
+        shadingRateImageView = VK_NULL_HANDLE;
+        if (pFragmentSpecInfo != nullptr)
+        {
+            fragmentSpecMapEntries.assign(pFragmentSpecInfo->pMapEntries, pFragmentSpecInfo->pMapEntries + pFragmentSpecInfo->mapEntryCount);
+            const uint8_t* pData = static_cast<const uint8_t*>(pFragmentSpecInfo->pData);
+            fragmentSpecData.assign(pData, pData + pFragmentSpecInfo->dataSize);
+        }
+
         inputImageViews = createImageViews(pLogicalDevice, format, inputImages);
         Logger::debug("created input ImageViews");
         outputImageViews = createImageViews(pLogicalDevice, format, outputImages);
@@ -40,41 +58,196 @@ namespace vkBasalt
         sampler = createSampler(pLogicalDevice);
         Logger::debug("created sampler");
 
-        imageSamplerDescriptorSetLayout = createImageSamplerDescriptorSetLayout(pLogicalDevice, 1);
+        // the vertex stage reads the damage rectangle of the image from the same set as the input image
+        imageSamplerDescriptorSetLayout = createImageSamplerUniformDescriptorSetLayout(pLogicalDevice);
         Logger::debug("created descriptorSetLayouts");
 
         VkDescriptorPoolSize imagePoolSize;
         imagePoolSize.type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
         imagePoolSize.descriptorCount = inputImages.size() + 10;
 
-        std::vector<VkDescriptorPoolSize> poolSizes = {imagePoolSize};
+        VkDescriptorPoolSize damagePoolSize;
+        damagePoolSize.type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        damagePoolSize.descriptorCount = inputImages.size();
+
+        std::vector<VkDescriptorPoolSize> poolSizes = {imagePoolSize, damagePoolSize};
 
         descriptorPool = createDescriptorPool(pLogicalDevice, poolSizes);
         Logger::debug("created descriptorPool");
 
-        createShaderModule(pLogicalDevice, vertexCode, &vertexModule);
         createShaderModule(pLogicalDevice, fragmentCode, &fragmentModule);
 
-        renderPass = createRenderPass(pLogicalDevice, format);
+        // with dynamic rendering the output views get rendered to directly
+        VkPipelineRenderingCreateInfoKHR  renderingCreateInfo  = getPipelineRenderingCreateInfo({format});
+        VkPipelineRenderingCreateInfoKHR* pRenderingCreateInfo = nullptr;
+        if (pLogicalDevice->supportsDynamicRendering)
+        {
+            renderPass           = VK_NULL_HANDLE;
+            loadRenderPass       = VK_NULL_HANDLE;
+            pRenderingCreateInfo = &renderingCreateInfo;
+        }
+        else
+        {
+            renderPass     = createRenderPass(pLogicalDevice, format);
+            loadRenderPass = createRenderPass(pLogicalDevice, format, VK_FORMAT_UNDEFINED, VK_ATTACHMENT_LOAD_OP_LOAD, VK_ATTACHMENT_LOAD_OP_LOAD);
+        }
 
         descriptorSetLayouts.insert(descriptorSetLayouts.begin(), imageSamplerDescriptorSetLayout);
-        pipelineLayout = createGraphicsPipelineLayout(pLogicalDevice, descriptorSetLayouts);
-
-        graphicsPipeline = createGraphicsPipeline(pLogicalDevice,
-                                                  vertexModule,
-                                                  pVertexSpecInfo,
-                                                  "main",
-                                                  fragmentModule,
-                                                  pFragmentSpecInfo,
-                                                  "main",
-                                                  imageExtent,
-                                                  renderPass,
-                                                  pipelineLayout);
+
+        // with pipeline libraries only the fragment stage needs to be compiled, the rest is shared with the other effects
+        if (pLogicalDevice->supportsPipelineLibrary && pVertexSpecInfo == nullptr)
+        {
+            vertexModule   = VK_NULL_HANDLE;
+            pipelineLayout = createGraphicsPipelineLayout(pLogicalDevice, descriptorSetLayouts, VK_PIPELINE_LAYOUT_CREATE_INDEPENDENT_SETS_BIT_EXT);
+
+            graphicsPipeline = createLinkedGraphicsPipeline(pLogicalDevice,
+                                                            vertexCode,
+                                                            imageSamplerDescriptorSetLayout,
+                                                            fragmentModule,
+                                                            pFragmentSpecInfo,
+                                                            "main",
+                                                            imageExtent,
+                                                            renderPass,
+                                                            pipelineLayout,
+                                                            sharedPipelineLibraries,
+                                                            fragmentPipelineLibrary,
+                                                            pRenderingCreateInfo);
+        }
+        else
+        {
+            createShaderModule(pLogicalDevice, vertexCode, &vertexModule);
+            pipelineLayout = createGraphicsPipelineLayout(pLogicalDevice, descriptorSetLayouts);
+
+            graphicsPipeline = createGraphicsPipeline(pLogicalDevice,
+                                                      vertexModule,
+                                                      pVertexSpecInfo,
+                                                      "main",
+                                                      fragmentModule,
+                                                      pFragmentSpecInfo,
+                                                      "main",
+                                                      imageExtent,
+                                                      renderPass,
+                                                      pipelineLayout,
+                                                      false,
+                                                      pRenderingCreateInfo);
+        }
 
         imageDescriptorSets = allocateAndWriteImageSamplerDescriptorSets(
             pLogicalDevice, descriptorPool, imageSamplerDescriptorSetLayout, {sampler}, std::vector<std::vector<VkImageView>>(1, inputImageViews));
 
-        framebuffers = createFramebuffers(pLogicalDevice, renderPass, imageExtent, {outputImageViews});
+        // the damage rectangles are data, so that the command buffers stay the same while they change
+        createBuffer(pLogicalDevice,
+                     inputImages.size() * damageRectStride,
+                     VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     damageBuffer,
+                     damageMemory);
+
+        void*    data;
+        VkResult result = pLogicalDevice->vkd.MapMemory(pLogicalDevice->device, damageMemory, 0, VK_WHOLE_SIZE, 0, &data);
+        ASSERT_VULKAN(result);
+        pDamageRects = static_cast<uint8_t*>(data);
+
+        for (uint32_t i = 0; i < inputImages.size(); i++)
+        {
+            setDamageRect(i, {{0, 0}, imageExtent});
+
+            VkDescriptorBufferInfo damageBufferInfo;
+            damageBufferInfo.buffer = damageBuffer;
+            damageBufferInfo.offset = i * damageRectStride;
+            damageBufferInfo.range  = 4 * sizeof(float);
+
+            VkWriteDescriptorSet writeDescriptorSet;
+            writeDescriptorSet.sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writeDescriptorSet.pNext            = nullptr;
+            writeDescriptorSet.dstSet           = imageDescriptorSets[i];
+            writeDescriptorSet.dstBinding       = 1;
+            writeDescriptorSet.dstArrayElement  = 0;
+            writeDescriptorSet.descriptorCount  = 1;
+            writeDescriptorSet.descriptorType   = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            writeDescriptorSet.pImageInfo       = nullptr;
+            writeDescriptorSet.pBufferInfo      = &damageBufferInfo;
+            writeDescriptorSet.pTexelBufferView = nullptr;
+
+            pLogicalDevice->vkd.UpdateDescriptorSets(pLogicalDevice->device, 1, &writeDescriptorSet, 0, nullptr);
+        }
+
+        if (renderPass != VK_NULL_HANDLE)
+        {
+            framebuffers = createFramebuffers(pLogicalDevice, renderPass, imageExtent, {outputImageViews});
+        }
+    }
+    void SimpleEffect::setContentRect(VkRect2D contentRect)
+    {
+        this->contentRect = contentRect;
+    }
+    void SimpleEffect::setDamageRect(uint32_t imageIndex, VkRect2D damageRect)
+    {
+        // left, top, right and bottom, see shader/damage_rect.vert.glsl
+        float* pRect = reinterpret_cast<float*>(pDamageRects + imageIndex * damageRectStride);
+        pRect[0]     = (float) damageRect.offset.x / imageExtent.width;
+        pRect[1]     = (float) damageRect.offset.y / imageExtent.height;
+        pRect[2]     = (float) (damageRect.offset.x + damageRect.extent.width) / imageExtent.width;
+        pRect[3]     = (float) (damageRect.offset.y + damageRect.extent.height) / imageExtent.height;
+    }
+    bool SimpleEffect::isSkippable()
+    {
+        return true;
+    }
+    void SimpleEffect::setKeepOutput(bool keepOutput)
+    {
+        this->keepOutput = keepOutput;
+    }
+    bool SimpleEffect::useShadingRateImage(VkImageView shadingRateImageView, uint32_t maxShadingRate)
+    {
+        // the shading rate image is only an attachment of dynamic rendering, the specialization of the vertex stage is gone after init
+        if (renderPass != VK_NULL_HANDLE || !pLogicalDevice->supportsShadingRate || pVertexSpecInfo != nullptr)
+        {
+            return false;
+        }
+
+        VkSpecializationInfo  fragmentSpecializationInfo;
+        VkSpecializationInfo* pFragmentSpecializationInfo = nullptr;
+        if (!fragmentSpecData.empty())
+        {
+            fragmentSpecializationInfo.mapEntryCount = fragmentSpecMapEntries.size();
+            fragmentSpecializationInfo.pMapEntries   = fragmentSpecMapEntries.data();
+            fragmentSpecializationInfo.dataSize      = fragmentSpecData.size();
+            fragmentSpecializationInfo.pData         = fragmentSpecData.data();
+            pFragmentSpecializationInfo              = &fragmentSpecializationInfo;
+        }
+
+        // pipeline libraries cannot take the shading rate state, so the pipeline gets compiled in full with a layout without independent sets
+        if (vertexModule == VK_NULL_HANDLE)
+        {
+            createShaderModule(pLogicalDevice, vertexCode, &vertexModule);
+        }
+        VkPipelineLayout newPipelineLayout = createGraphicsPipelineLayout(pLogicalDevice, descriptorSetLayouts);
+
+        VkPipelineRenderingCreateInfoKHR renderingCreateInfo = getPipelineRenderingCreateInfo({format});
+
+        VkPipeline newGraphicsPipeline = createGraphicsPipeline(pLogicalDevice,
+                                                                vertexModule,
+                                                                nullptr,
+                                                                "main",
+                                                                fragmentModule,
+                                                                pFragmentSpecializationInfo,
+                                                                "main",
+                                                                imageExtent,
+                                                                VK_NULL_HANDLE,
+                                                                newPipelineLayout,
+                                                                false,
+                                                                &renderingCreateInfo,
+                                                                nullptr,
+                                                                maxShadingRate);
+
+        pLogicalDevice->vkd.DestroyPipeline(pLogicalDevice->device, graphicsPipeline, nullptr);
+        releaseCachedObject<VK_OBJECT_TYPE_PIPELINE_LAYOUT>(pLogicalDevice, pipelineLayout);
+        graphicsPipeline = newGraphicsPipeline;
+        pipelineLayout   = newPipelineLayout;
+
+        this->shadingRateImageView = shadingRateImageView;
+        return true;
     }
     void SimpleEffect::applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer)
     {
@@ -119,19 +292,40 @@ namespace vkBasalt
             commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarrier);
         Logger::debug("after the first pipeline barrier");
 
-        VkRenderPassBeginInfo renderPassBeginInfo;
-        renderPassBeginInfo.sType             = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        renderPassBeginInfo.pNext             = nullptr;
-        renderPassBeginInfo.renderPass        = renderPass;
-        renderPassBeginInfo.framebuffer       = framebuffers[imageIndex];
-        renderPassBeginInfo.renderArea.offset = {0, 0};
-        renderPassBeginInfo.renderArea.extent = imageExtent;
-        VkClearValue clearValue               = {0.0f, 0.0f, 0.0f, 1.0f};
-        renderPassBeginInfo.clearValueCount   = 1;
-        renderPassBeginInfo.pClearValues      = &clearValue;
+        VkClearValue clearValue = {0.0f, 0.0f, 0.0f, 1.0f};
 
+        // the draw only covers the damage rectangle of the image, so with keepOutput the rest of the output has to be loaded,
+        // a skipped draw has to leave the whole output alone, so the borders get cleared with a command that gets skipped as well
         Logger::debug("before beginn renderpass");
-        pLogicalDevice->vkd.CmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+        if (renderPass == VK_NULL_HANDLE)
+        {
+            beginRendering(pLogicalDevice,
+                           commandBuffer,
+                           {{0, 0}, imageExtent},
+                           {outputImages[imageIndex]},
+                           {outputImageViews[imageIndex]},
+                           {keepOutput ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR},
+                           keepOutput ? VK_IMAGE_LAYOUT_PRESENT_SRC_KHR : VK_IMAGE_LAYOUT_UNDEFINED,
+                           clearValue,
+                           VK_NULL_HANDLE,
+                           VK_ATTACHMENT_LOAD_OP_LOAD,
+                           {},
+                           VK_ATTACHMENT_STORE_OP_STORE,
+                           shadingRateImageView);
+        }
+        else
+        {
+            VkRenderPassBeginInfo renderPassBeginInfo;
+            renderPassBeginInfo.sType           = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+            renderPassBeginInfo.pNext           = nullptr;
+            renderPassBeginInfo.renderPass      = keepOutput ? loadRenderPass : renderPass;
+            renderPassBeginInfo.framebuffer     = framebuffers[imageIndex];
+            renderPassBeginInfo.renderArea      = {{0, 0}, imageExtent};
+            renderPassBeginInfo.clearValueCount = 1;
+            renderPassBeginInfo.pClearValues    = &clearValue;
+
+            pLogicalDevice->vkd.CmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+        }
         Logger::debug("after beginn renderpass");
 
         pLogicalDevice->vkd.CmdBindDescriptorSets(
@@ -141,10 +335,41 @@ namespace vkBasalt
         pLogicalDevice->vkd.CmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
         Logger::debug("after bind pipeliene");
 
-        pLogicalDevice->vkd.CmdDraw(commandBuffer, 3, 1, 0, 0);
+        // the clear load op or the attachment clear below take care of the borders
+        pLogicalDevice->vkd.CmdSetScissor(commandBuffer, 0, 1, &contentRect);
+
+        if (keepOutput)
+        {
+            std::vector<VkClearRect> borderClearRects;
+            for (auto& borderRect : getBorderRects(imageExtent, contentRect))
+            {
+                if (borderRect.extent.width > 0 && borderRect.extent.height > 0)
+                {
+                    borderClearRects.push_back({borderRect, 0, 1});
+                }
+            }
+            if (!borderClearRects.empty())
+            {
+                VkClearAttachment clearAttachment;
+                clearAttachment.aspectMask      = VK_IMAGE_ASPECT_COLOR_BIT;
+                clearAttachment.colorAttachment = 0;
+                clearAttachment.clearValue      = clearValue;
+                pLogicalDevice->vkd.CmdClearAttachments(commandBuffer, 1, &clearAttachment, borderClearRects.size(), borderClearRects.data());
+            }
+        }
+
+        // two triangles that cover the damage rectangle of the image
+        pLogicalDevice->vkd.CmdDraw(commandBuffer, 6, 1, 0, 0);
         Logger::debug("after draw");
 
-        pLogicalDevice->vkd.CmdEndRenderPass(commandBuffer);
+        if (renderPass == VK_NULL_HANDLE)
+        {
+            endRendering(pLogicalDevice, commandBuffer, {outputImages[imageIndex]}, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+        }
+        else
+        {
+            pLogicalDevice->vkd.CmdEndRenderPass(commandBuffer);
+        }
         Logger::debug("after end renderpass");
 
         pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer,
@@ -163,9 +388,18 @@ namespace vkBasalt
     {
         Logger::debug("destroying SimpleEffect " + convertToString(this));
         pLogicalDevice->vkd.DestroyPipeline(pLogicalDevice->device, graphicsPipeline, nullptr);
-        pLogicalDevice->vkd.DestroyPipelineLayout(pLogicalDevice->device, pipelineLayout, nullptr);
-        pLogicalDevice->vkd.DestroyRenderPass(pLogicalDevice->device, renderPass, nullptr);
-        pLogicalDevice->vkd.DestroyDescriptorSetLayout(pLogicalDevice->device, imageSamplerDescriptorSetLayout, nullptr);
+        pLogicalDevice->vkd.DestroyPipeline(pLogicalDevice->device, fragmentPipelineLibrary, nullptr);
+        for (auto& library : sharedPipelineLibraries)
+        {
+            releaseCachedObject<VK_OBJECT_TYPE_PIPELINE>(pLogicalDevice, library);
+        }
+        releaseCachedObject<VK_OBJECT_TYPE_PIPELINE_LAYOUT>(pLogicalDevice, pipelineLayout);
+        if (renderPass != VK_NULL_HANDLE)
+        {
+            releaseCachedObject<VK_OBJECT_TYPE_RENDER_PASS>(pLogicalDevice, renderPass);
+            releaseCachedObject<VK_OBJECT_TYPE_RENDER_PASS>(pLogicalDevice, loadRenderPass);
+        }
+        releaseCachedObject<VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT>(pLogicalDevice, imageSamplerDescriptorSetLayout);
         pLogicalDevice->vkd.DestroyShaderModule(pLogicalDevice->device, vertexModule, nullptr);
         pLogicalDevice->vkd.DestroyShaderModule(pLogicalDevice->device, fragmentModule, nullptr);
 
@@ -173,10 +407,15 @@ namespace vkBasalt
         for (unsigned int i = 0; i < framebuffers.size(); i++)
         {
             pLogicalDevice->vkd.DestroyFramebuffer(pLogicalDevice->device, framebuffers[i], nullptr);
+        }
+        for (unsigned int i = 0; i < inputImageViews.size(); i++)
+        {
             pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, inputImageViews[i], nullptr);
             pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, outputImageViews[i], nullptr);
         }
         Logger::debug("after DestroyImageView");
-        pLogicalDevice->vkd.DestroySampler(pLogicalDevice->device, sampler, nullptr);
+        releaseCachedObject<VK_OBJECT_TYPE_SAMPLER>(pLogicalDevice, sampler);
+        pLogicalDevice->vkd.DestroyBuffer(pLogicalDevice->device, damageBuffer, nullptr);
+        pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, damageMemory, nullptr);
     }
 } // namespace vkBasalt
@@ -22,6 +22,11 @@ namespace vkBasalt
     public:
         SimpleEffect();
         void virtual applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer) override;
+        void virtual setContentRect(VkRect2D contentRect) override;
+        void virtual setDamageRect(uint32_t imageIndex, VkRect2D damageRect) override;
+        bool virtual isSkippable() override;
+        void virtual setKeepOutput(bool keepOutput) override;
+        bool virtual useShadingRateImage(VkImageView shadingRateImageView, uint32_t maxShadingRate) override;
         virtual ~SimpleEffect();
 
     protected:
@@ -37,9 +42,19 @@ namespace vkBasalt
         VkShaderModule               vertexModule;
         VkShaderModule               fragmentModule;
         VkRenderPass                 renderPass;
+        // keeps the output, for damage rectangles and skipped submissions
+        VkRenderPass                 loadRenderPass;
         VkPipelineLayout             pipelineLayout;
         VkPipeline                   graphicsPipeline;
+        std::vector<VkPipeline>      sharedPipelineLibraries;
+        VkPipeline                   fragmentPipelineLibrary = VK_NULL_HANDLE;
         VkExtent2D                   imageExtent;
+        VkRect2D                     contentRect;
+        bool                         keepOutput;
+        // the damage rectangle of every image in texture coordinates for the vertex stage, persistently mapped
+        VkBuffer                     damageBuffer;
+        VkDeviceMemory               damageMemory;
+        uint8_t*                     pDamageRects;
         VkFormat                     format;
         VkSampler                    sampler;
         Config*                      pConfig;
@@ -47,6 +62,11 @@ namespace vkBasalt
         std::vector<uint32_t>        fragmentCode;
         VkSpecializationInfo*        pVertexSpecInfo;
         VkSpecializationInfo*        pFragmentSpecInfo;
+        VkImageView                  shadingRateImageView;
+
+        // copies of the fragment specialization, the info of the subclasses only lives until init returns
+        std::vector<VkSpecializationMapEntry> fragmentSpecMapEntries;
+        std::vector<uint8_t>                  fragmentSpecData;
 
         // subclasses can put DescriptorSets in here, but the first one will be the input image descriptorSet
         std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
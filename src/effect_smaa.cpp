@@ -10,7 +10,9 @@
 #include "framebuffer.hpp"
 #include "shader.hpp"
 #include "sampler.hpp"
+#include "object_cache.hpp"
 #include "image.hpp"
+#include "format.hpp"
 #include "util.hpp"
 
 #include "AreaTex.h"
@@ -19,6 +21,12 @@
 
 namespace vkBasalt
 {
+    namespace
+    {
+        constexpr VkFormat edgeFormat  = VK_FORMAT_R8G8_UNORM;
+        constexpr VkFormat blendFormat = VK_FORMAT_B8G8R8A8_UNORM;
+    } // namespace
+
     SmaaEffect::SmaaEffect(LogicalDevice*       pLogicalDevice,
                            VkFormat             format,
                            VkExtent2D           imageExtent,
@@ -31,61 +39,66 @@ namespace vkBasalt
         this->pLogicalDevice = pLogicalDevice;
         this->format         = format;
         this->imageExtent    = imageExtent;
+        this->contentRect    = {{0, 0}, imageExtent};
         this->inputImages    = inputImages;
         this->outputImages   = outputImages;
         this->pConfig        = pConfig;
 
-        // create Images for the first and second pass at once -> less memory fragmentation
-        std::vector<VkImage> edgeAndBlendImages = createImages(pLogicalDevice,
-                                                               inputImages.size() * 2,
-                                                               {imageExtent.width, imageExtent.height, 1},
-                                                               VK_FORMAT_B8G8R8A8_UNORM, // TODO search for format and save it
-                                                               VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
-                                                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                                                               imageMemory);
-
-        edgeImages  = std::vector<VkImage>(edgeAndBlendImages.begin(), edgeAndBlendImages.begin() + edgeAndBlendImages.size() / 2);
-        blendImages = std::vector<VkImage>(edgeAndBlendImages.begin() + edgeAndBlendImages.size() / 2, edgeAndBlendImages.end());
+        // the edges only have two channels, the blending weights need all four
+        edgeImage  = createImages(pLogicalDevice,
+                                 1,
+                                 {imageExtent.width, imageExtent.height, 1},
+                                 edgeFormat,
+                                 VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+                                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                 edgeImageMemory)[0];
+        blendImage = createImages(pLogicalDevice,
+                                  1,
+                                  {imageExtent.width, imageExtent.height, 1},
+                                  blendFormat,
+                                  VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+                                  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                  blendImageMemory)[0];
+
+        // the edge pass marks the pixels with edges in the stencil, so that the blend pass only runs for those
+        stencilFormat    = getStencilFormat(pLogicalDevice);
+        stencilImage     = createImages(pLogicalDevice,
+                                    1,
+                                    {imageExtent.width, imageExtent.height, 1},
+                                    stencilFormat,
+                                    VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+                                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                    stencilImageMemory)[0];
+        stencilImageView = createImageViews(
+            pLogicalDevice, stencilFormat, {stencilImage}, VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT)[0];
 
         inputImageViews = createImageViews(pLogicalDevice, format, inputImages);
         Logger::debug("created input ImageViews");
-        edgeImageViews = createImageViews(pLogicalDevice, VK_FORMAT_B8G8R8A8_UNORM, edgeImages);
+        edgeImageView = createImageViews(pLogicalDevice, edgeFormat, {edgeImage})[0];
         Logger::debug("created edge  ImageViews");
-        blendImageViews = createImageViews(pLogicalDevice, VK_FORMAT_B8G8R8A8_UNORM, blendImages);
+        blendImageView = createImageViews(pLogicalDevice, blendFormat, {blendImage})[0];
         Logger::debug("created blend ImageViews");
         outputImageViews = createImageViews(pLogicalDevice, format, outputImages);
         Logger::debug("created output ImageViews");
         sampler = createSampler(pLogicalDevice);
         Logger::debug("created sampler");
 
-        VkExtent3D areaImageExtent = {AREATEX_WIDTH, AREATEX_HEIGHT, 1};
-
-        areaImage = createImages(pLogicalDevice,
-                                 1,
-                                 areaImageExtent,
-                                 VK_FORMAT_R8G8_UNORM, // TODO search for format and save it
-                                 VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
-                                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                                 areaMemory)[0];
-
-        VkExtent3D searchImageExtent = {SEARCHTEX_WIDTH, SEARCHTEX_HEIGHT, 1};
-
-        searchImage = createImages(pLogicalDevice,
-                                   1,
-                                   searchImageExtent,
-                                   VK_FORMAT_R8_UNORM, // TODO search for format and save it
-                                   VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
-                                   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                                   searchMemory)[0];
-
-        uploadToImage(pLogicalDevice, areaImage, areaImageExtent, AREATEX_SIZE, areaTexBytes);
-
-        uploadToImage(pLogicalDevice, searchImage, searchImageExtent, SEARCHTEX_SIZE, searchTexBytes);
+        // the lookup textures are the same for every smaa effect, so upload them only once per device
+        areaTexture = getCachedTexture(pLogicalDevice, "smaa:AreaTex");
+        if (!areaTexture)
+        {
+            areaTexture = createCachedTexture(pLogicalDevice, "smaa:AreaTex", {AREATEX_WIDTH, AREATEX_HEIGHT, 1}, VK_FORMAT_R8G8_UNORM);
+            uploadToImage(pLogicalDevice, areaTexture->image, areaTexture->extent, AREATEX_SIZE, areaTexBytes);
+        }
+        areaImageView = areaTexture->imageViewUNORM;
 
-        areaImageView = createImageViews(pLogicalDevice, VK_FORMAT_R8G8_UNORM, std::vector<VkImage>(1, areaImage))[0];
-        Logger::debug("after creating area ImageView");
-        searchImageView = createImageViews(pLogicalDevice, VK_FORMAT_R8_UNORM, std::vector<VkImage>(1, searchImage))[0];
-        Logger::debug("created search ImageView");
+        searchTexture = getCachedTexture(pLogicalDevice, "smaa:SearchTex");
+        if (!searchTexture)
+        {
+            searchTexture = createCachedTexture(pLogicalDevice, "smaa:SearchTex", {SEARCHTEX_WIDTH, SEARCHTEX_HEIGHT, 1}, VK_FORMAT_R8_UNORM);
+            uploadToImage(pLogicalDevice, searchTexture->image, searchTexture->extent, SEARCHTEX_SIZE, searchTexBytes);
+        }
+        searchImageView = searchTexture->imageViewUNORM;
 
         imageSamplerDescriptorSetLayout = createImageSamplerDescriptorSetLayout(pLogicalDevice, 5);
         Logger::debug("created descriptorSetLayouts");
@@ -133,8 +146,54 @@ namespace vkBasalt
 
         createShaderModule(pLogicalDevice, smaa_neighbor_frag, &neignborFragmentModule);
 
-        renderPass      = createRenderPass(pLogicalDevice, format);
-        unormRenderPass = createRenderPass(pLogicalDevice, VK_FORMAT_B8G8R8A8_UNORM);
+        // with dynamic rendering the edge, blend and output views get rendered to directly
+        VkPipelineRenderingCreateInfoKHR  renderingCreateInfo       = getPipelineRenderingCreateInfo({format});
+        VkPipelineRenderingCreateInfoKHR  edgeRenderingCreateInfo   = getPipelineRenderingCreateInfo({edgeFormat}, stencilFormat);
+        VkPipelineRenderingCreateInfoKHR  blendRenderingCreateInfo  = getPipelineRenderingCreateInfo({blendFormat}, stencilFormat);
+        VkPipelineRenderingCreateInfoKHR* pRenderingCreateInfo      = nullptr;
+        VkPipelineRenderingCreateInfoKHR* pEdgeRenderingCreateInfo  = nullptr;
+        VkPipelineRenderingCreateInfoKHR* pBlendRenderingCreateInfo = nullptr;
+        if (pLogicalDevice->supportsDynamicRendering)
+        {
+            renderPass                = VK_NULL_HANDLE;
+            edgeRenderPass            = VK_NULL_HANDLE;
+            blendRenderPass           = VK_NULL_HANDLE;
+            pRenderingCreateInfo      = &renderingCreateInfo;
+            pEdgeRenderingCreateInfo  = &edgeRenderingCreateInfo;
+            pBlendRenderingCreateInfo = &blendRenderingCreateInfo;
+        }
+        else
+        {
+            renderPass      = createRenderPass(pLogicalDevice, format);
+            edgeRenderPass  = createRenderPass(pLogicalDevice, edgeFormat, stencilFormat, VK_ATTACHMENT_LOAD_OP_CLEAR);
+            // the stencil mask is not needed after the blend pass
+            blendRenderPass = createRenderPass(
+                pLogicalDevice, blendFormat, stencilFormat, VK_ATTACHMENT_LOAD_OP_LOAD, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_DONT_CARE);
+        }
+
+        // the edge pass discards pixels without edges, every other pixel sets the stencil to 1
+        VkPipelineDepthStencilStateCreateInfo edgeStencilState = {};
+        edgeStencilState.sType                                 = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+        edgeStencilState.depthTestEnable                       = VK_FALSE;
+        edgeStencilState.depthWriteEnable                      = VK_FALSE;
+        edgeStencilState.depthCompareOp                        = VK_COMPARE_OP_ALWAYS;
+        edgeStencilState.stencilTestEnable                     = VK_TRUE;
+        edgeStencilState.front.failOp                          = VK_STENCIL_OP_KEEP;
+        edgeStencilState.front.passOp                          = VK_STENCIL_OP_REPLACE;
+        edgeStencilState.front.depthFailOp                     = VK_STENCIL_OP_KEEP;
+        edgeStencilState.front.compareOp                       = VK_COMPARE_OP_ALWAYS;
+        edgeStencilState.front.compareMask                     = 0xff;
+        edgeStencilState.front.writeMask                       = 0xff;
+        edgeStencilState.front.reference                       = 1;
+        edgeStencilState.back                                  = edgeStencilState.front;
+        edgeStencilState.maxDepthBounds                        = 1.0f;
+
+        // and the blend pass only runs where the stencil is 1
+        VkPipelineDepthStencilStateCreateInfo blendStencilState = edgeStencilState;
+        blendStencilState.front.passOp                          = VK_STENCIL_OP_KEEP;
+        blendStencilState.front.compareOp                       = VK_COMPARE_OP_EQUAL;
+        blendStencilState.front.writeMask                       = 0;
+        blendStencilState.back                                  = blendStencilState.front;
 
         std::vector<VkDescriptorSetLayout> descriptorSetLayouts = {imageSamplerDescriptorSetLayout};
         pipelineLayout                                          = createGraphicsPipelineLayout(pLogicalDevice, descriptorSetLayouts);
@@ -164,8 +223,11 @@ namespace vkBasalt
                                               &specializationInfo,
                                               "main",
                                               imageExtent,
-                                              unormRenderPass,
-                                              pipelineLayout);
+                                              edgeRenderPass,
+                                              pipelineLayout,
+                                              false,
+                                              pEdgeRenderingCreateInfo,
+                                              &edgeStencilState);
 
         blendPipeline = createGraphicsPipeline(pLogicalDevice,
                                                blendVertexModule,
@@ -175,8 +237,11 @@ namespace vkBasalt
                                                &specializationInfo,
                                                "main",
                                                imageExtent,
-                                               unormRenderPass,
-                                               pipelineLayout);
+                                               blendRenderPass,
+                                               pipelineLayout,
+                                               false,
+                                               pBlendRenderingCreateInfo,
+                                               &blendStencilState);
 
         neighborPipeline = createGraphicsPipeline(pLogicalDevice,
                                                   neighborVertexModule,
@@ -187,13 +252,15 @@ namespace vkBasalt
                                                   "main",
                                                   imageExtent,
                                                   renderPass,
-                                                  pipelineLayout);
+                                                  pipelineLayout,
+                                                  false,
+                                                  pRenderingCreateInfo);
 
         std::vector<std::vector<VkImageView>> imageViewsVector = {inputImageViews,
-                                                                  edgeImageViews,
+                                                                  std::vector<VkImageView>(inputImageViews.size(), edgeImageView),
                                                                   std::vector<VkImageView>(inputImageViews.size(), areaImageView),
                                                                   std::vector<VkImageView>(inputImageViews.size(), searchImageView),
-                                                                  blendImageViews};
+                                                                  std::vector<VkImageView>(inputImageViews.size(), blendImageView)};
 
         imageDescriptorSets = allocateAndWriteImageSamplerDescriptorSets(pLogicalDevice,
                                                                          descriptorPool,
@@ -201,9 +268,16 @@ namespace vkBasalt
                                                                          std::vector<VkSampler>(imageViewsVector.size(), sampler),
                                                                          imageViewsVector);
 
-        edgeFramebuffers     = createFramebuffers(pLogicalDevice, unormRenderPass, imageExtent, {edgeImageViews});
-        blendFramebuffers    = createFramebuffers(pLogicalDevice, unormRenderPass, imageExtent, {blendImageViews});
-        neignborFramebuffers = createFramebuffers(pLogicalDevice, renderPass, imageExtent, {outputImageViews});
+        if (renderPass != VK_NULL_HANDLE)
+        {
+            edgeFramebuffer      = createFramebuffers(pLogicalDevice, edgeRenderPass, imageExtent, {{edgeImageView}, {stencilImageView}})[0];
+            blendFramebuffer     = createFramebuffers(pLogicalDevice, blendRenderPass, imageExtent, {{blendImageView}, {stencilImageView}})[0];
+            neignborFramebuffers = createFramebuffers(pLogicalDevice, renderPass, imageExtent, {outputImageViews});
+        }
+    }
+    void SmaaEffect::setContentRect(VkRect2D contentRect)
+    {
+        this->contentRect = contentRect;
     }
     void SmaaEffect::applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer)
     {
@@ -244,23 +318,102 @@ namespace vkBasalt
         secondBarrier.subresourceRange.baseArrayLayer = 0;
         secondBarrier.subresourceRange.layerCount     = 1;
 
+        // bottom of pipe as source waits for every earlier command on the queue,
+        // so the last frame is done with the shared edge and blend images before they get cleared
         pLogicalDevice->vkd.CmdPipelineBarrier(
             commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarrier);
         Logger::debug("after the first pipeline barrier");
 
+        // the stencil mask of the last frame is not needed anymore,
+        // the store op of the blend pass still writes it even with don't care
+        VkImageMemoryBarrier stencilBarrier;
+        stencilBarrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        stencilBarrier.pNext               = nullptr;
+        stencilBarrier.srcAccessMask       = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        stencilBarrier.dstAccessMask       = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        stencilBarrier.oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED;
+        stencilBarrier.newLayout           = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        stencilBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        stencilBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        stencilBarrier.image               = stencilImage;
+
+        stencilBarrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+        stencilBarrier.subresourceRange.baseMipLevel   = 0;
+        stencilBarrier.subresourceRange.levelCount     = 1;
+        stencilBarrier.subresourceRange.baseArrayLayer = 0;
+        stencilBarrier.subresourceRange.layerCount     = 1;
+
+        pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer,
+                                               VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                                               VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+                                               0,
+                                               0,
+                                               nullptr,
+                                               0,
+                                               nullptr,
+                                               1,
+                                               &stencilBarrier);
+
+        // pixels that the edge and blend passes skip have to be zero
+        VkClearValue clearValues[2];
+        clearValues[0].color        = {{0.0f, 0.0f, 0.0f, 0.0f}};
+        clearValues[1].depthStencil = {0.0f, 0};
+
         VkRenderPassBeginInfo renderPassBeginInfo;
         renderPassBeginInfo.sType             = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
         renderPassBeginInfo.pNext             = nullptr;
-        renderPassBeginInfo.renderPass        = unormRenderPass;
-        renderPassBeginInfo.framebuffer       = edgeFramebuffers[imageIndex];
+        renderPassBeginInfo.renderPass        = VK_NULL_HANDLE;
+        renderPassBeginInfo.framebuffer       = VK_NULL_HANDLE;
         renderPassBeginInfo.renderArea.offset = {0, 0};
         renderPassBeginInfo.renderArea.extent = imageExtent;
-        VkClearValue clearValue               = {0.0f, 0.0f, 0.0f, 1.0f};
-        renderPassBeginInfo.clearValueCount   = 1;
-        renderPassBeginInfo.pClearValues      = &clearValue;
+        renderPassBeginInfo.clearValueCount   = 2;
+        renderPassBeginInfo.pClearValues      = clearValues;
+
+        // every pass leaves its image in the present layout, like the render passes do
+        auto beginPass = [&](VkRenderPass        pass,
+                             VkFramebuffer       framebuffer,
+                             VkImage             image,
+                             VkImageView         imageView,
+                             bool                useStencil,
+                             VkAttachmentLoadOp  stencilLoadOp,
+                             VkAttachmentStoreOp stencilStoreOp) {
+            if (renderPass == VK_NULL_HANDLE)
+            {
+                beginRendering(pLogicalDevice,
+                               commandBuffer,
+                               renderPassBeginInfo.renderArea,
+                               {image},
+                               {imageView},
+                               {VK_ATTACHMENT_LOAD_OP_CLEAR},
+                               VK_IMAGE_LAYOUT_UNDEFINED,
+                               clearValues[0],
+                               useStencil ? stencilImageView : VK_NULL_HANDLE,
+                               stencilLoadOp,
+                               {},
+                               stencilStoreOp);
+            }
+            else
+            {
+                renderPassBeginInfo.renderPass      = pass;
+                renderPassBeginInfo.framebuffer     = framebuffer;
+                renderPassBeginInfo.clearValueCount = useStencil ? 2 : 1;
+                pLogicalDevice->vkd.CmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+            }
+        };
+        auto endPass = [&](VkImage image) {
+            if (renderPass == VK_NULL_HANDLE)
+            {
+                endRendering(pLogicalDevice, commandBuffer, {image}, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+            }
+            else
+            {
+                pLogicalDevice->vkd.CmdEndRenderPass(commandBuffer);
+            }
+        };
+
         // edge renderPass
         Logger::debug("before beginn edge renderpass");
-        pLogicalDevice->vkd.CmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+        beginPass(edgeRenderPass, edgeFramebuffer, edgeImage, edgeImageView, true, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE);
         Logger::debug("after beginn renderpass");
 
         pLogicalDevice->vkd.CmdBindDescriptorSets(
@@ -269,52 +422,74 @@ namespace vkBasalt
 
         pLogicalDevice->vkd.CmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, edgePipeline);
         Logger::debug("after bind pipeliene");
+        pLogicalDevice->vkd.CmdSetScissor(commandBuffer, 0, 1, &contentRect);
 
         pLogicalDevice->vkd.CmdDraw(commandBuffer, 3, 1, 0, 0);
         Logger::debug("after draw");
 
-        pLogicalDevice->vkd.CmdEndRenderPass(commandBuffer);
+        endPass(edgeImage);
         Logger::debug("after end renderpass");
 
-        memoryBarrier.image             = edgeImages[imageIndex];
-        renderPassBeginInfo.framebuffer = blendFramebuffers[imageIndex];
+        memoryBarrier.image = edgeImage;
         // blend renderPass
         pLogicalDevice->vkd.CmdPipelineBarrier(
             commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarrier);
         Logger::debug("after the first pipeline barrier");
 
+        // the blend pass tests against the stencil that the edge pass wrote, its store op writes it as well
+        stencilBarrier.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        stencilBarrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        stencilBarrier.oldLayout     = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer,
+                                               VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                                               VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+                                               0,
+                                               0,
+                                               nullptr,
+                                               0,
+                                               nullptr,
+                                               1,
+                                               &stencilBarrier);
+
         Logger::debug("before beginn blend renderpass");
-        pLogicalDevice->vkd.CmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+        beginPass(blendRenderPass, blendFramebuffer, blendImage, blendImageView, true, VK_ATTACHMENT_LOAD_OP_LOAD, VK_ATTACHMENT_STORE_OP_DONT_CARE);
         Logger::debug("after beginn renderpass");
 
         pLogicalDevice->vkd.CmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, blendPipeline);
         Logger::debug("after bind pipeliene");
+        pLogicalDevice->vkd.CmdSetScissor(commandBuffer, 0, 1, &contentRect);
 
         pLogicalDevice->vkd.CmdDraw(commandBuffer, 3, 1, 0, 0);
         Logger::debug("after draw");
 
-        pLogicalDevice->vkd.CmdEndRenderPass(commandBuffer);
+        endPass(blendImage);
         Logger::debug("after end renderpass");
 
-        memoryBarrier.image             = blendImages[imageIndex];
-        renderPassBeginInfo.framebuffer = neignborFramebuffers[imageIndex];
-        renderPassBeginInfo.renderPass  = renderPass;
+        memoryBarrier.image = blendImage;
         // neighbor renderPass
         pLogicalDevice->vkd.CmdPipelineBarrier(
             commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarrier);
         Logger::debug("after the first pipeline barrier");
 
         Logger::debug("before beginn neighbor renderpass");
-        pLogicalDevice->vkd.CmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+        beginPass(renderPass,
+                  neignborFramebuffers.empty() ? VK_NULL_HANDLE : neignborFramebuffers[imageIndex],
+                  outputImages[imageIndex],
+                  outputImageViews[imageIndex],
+                  false,
+                  VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+                  VK_ATTACHMENT_STORE_OP_DONT_CARE);
         Logger::debug("after beginn renderpass");
 
         pLogicalDevice->vkd.CmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, neighborPipeline);
         Logger::debug("after bind pipeliene");
+        // the output gets cleared as a whole, the borders outside of the scissor stay black
+        pLogicalDevice->vkd.CmdSetScissor(commandBuffer, 0, 1, &contentRect);
 
         pLogicalDevice->vkd.CmdDraw(commandBuffer, 3, 1, 0, 0);
         Logger::debug("after draw");
 
-        pLogicalDevice->vkd.CmdEndRenderPass(commandBuffer);
+        endPass(outputImages[imageIndex]);
         Logger::debug("after end renderpass");
 
         pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer,
@@ -336,10 +511,14 @@ namespace vkBasalt
         pLogicalDevice->vkd.DestroyPipeline(pLogicalDevice->device, blendPipeline, nullptr);
         pLogicalDevice->vkd.DestroyPipeline(pLogicalDevice->device, neighborPipeline, nullptr);
 
-        pLogicalDevice->vkd.DestroyPipelineLayout(pLogicalDevice->device, pipelineLayout, nullptr);
-        pLogicalDevice->vkd.DestroyRenderPass(pLogicalDevice->device, renderPass, nullptr);
-        pLogicalDevice->vkd.DestroyRenderPass(pLogicalDevice->device, unormRenderPass, nullptr);
-        pLogicalDevice->vkd.DestroyDescriptorSetLayout(pLogicalDevice->device, imageSamplerDescriptorSetLayout, nullptr);
+        releaseCachedObject<VK_OBJECT_TYPE_PIPELINE_LAYOUT>(pLogicalDevice, pipelineLayout);
+        if (renderPass != VK_NULL_HANDLE)
+        {
+            releaseCachedObject<VK_OBJECT_TYPE_RENDER_PASS>(pLogicalDevice, renderPass);
+            releaseCachedObject<VK_OBJECT_TYPE_RENDER_PASS>(pLogicalDevice, edgeRenderPass);
+            releaseCachedObject<VK_OBJECT_TYPE_RENDER_PASS>(pLogicalDevice, blendRenderPass);
+        }
+        releaseCachedObject<VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT>(pLogicalDevice, imageSamplerDescriptorSetLayout);
 
         pLogicalDevice->vkd.DestroyShaderModule(pLogicalDevice->device, edgeVertexModule, nullptr);
         pLogicalDevice->vkd.DestroyShaderModule(pLogicalDevice->device, edgeFragmentModule, nullptr);
@@ -349,27 +528,28 @@ namespace vkBasalt
         pLogicalDevice->vkd.DestroyShaderModule(pLogicalDevice->device, neignborFragmentModule, nullptr);
 
         pLogicalDevice->vkd.DestroyDescriptorPool(pLogicalDevice->device, descriptorPool, nullptr);
-        pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, imageMemory, nullptr);
-        pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, areaMemory, nullptr);
-        pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, searchMemory, nullptr);
-        for (unsigned int i = 0; i < edgeFramebuffers.size(); i++)
+        pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, stencilImageView, nullptr);
+        pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, stencilImage, nullptr);
+        pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, stencilImageMemory, nullptr);
+        pLogicalDevice->vkd.DestroyFramebuffer(pLogicalDevice->device, edgeFramebuffer, nullptr);
+        pLogicalDevice->vkd.DestroyFramebuffer(pLogicalDevice->device, blendFramebuffer, nullptr);
+        for (unsigned int i = 0; i < neignborFramebuffers.size(); i++)
         {
-            pLogicalDevice->vkd.DestroyFramebuffer(pLogicalDevice->device, edgeFramebuffers[i], nullptr);
-            pLogicalDevice->vkd.DestroyFramebuffer(pLogicalDevice->device, blendFramebuffers[i], nullptr);
             pLogicalDevice->vkd.DestroyFramebuffer(pLogicalDevice->device, neignborFramebuffers[i], nullptr);
+        }
+        for (unsigned int i = 0; i < inputImageViews.size(); i++)
+        {
             pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, inputImageViews[i], nullptr);
-            pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, edgeImageViews[i], nullptr);
-            pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, blendImageViews[i], nullptr);
             pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, outputImageViews[i], nullptr);
-            pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, edgeImages[i], nullptr);
-            pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, blendImages[i], nullptr);
         }
+        pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, edgeImageView, nullptr);
+        pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, blendImageView, nullptr);
+        pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, edgeImage, nullptr);
+        pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, blendImage, nullptr);
+        pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, edgeImageMemory, nullptr);
+        pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, blendImageMemory, nullptr);
         Logger::debug("after DestroyImageView");
-        pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, areaImageView, nullptr);
-        pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, areaImage, nullptr);
-        pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, searchImageView, nullptr);
-        pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, searchImage, nullptr);
 
-        pLogicalDevice->vkd.DestroySampler(pLogicalDevice->device, sampler, nullptr);
+        releaseCachedObject<VK_OBJECT_TYPE_SAMPLER>(pLogicalDevice, sampler);
     }
 } // namespace vkBasalt
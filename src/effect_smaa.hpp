@@ -14,6 +14,7 @@
 #include "config.hpp"
 
 #include "logical_device.hpp"
+#include "texture_cache.hpp"
 
 namespace vkBasalt
 {
@@ -27,25 +28,29 @@ namespace vkBasalt
                    std::vector<VkImage> outputImages,
                    Config*              pConfig);
         void applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer) override;
+        void setContentRect(VkRect2D contentRect) override;
         ~SmaaEffect();
 
     private:
         LogicalDevice*               pLogicalDevice;
         std::vector<VkImage>         inputImages;
-        std::vector<VkImage>         edgeImages;
-        std::vector<VkImage>         blendImages;
         std::vector<VkImage>         outputImages;
         std::vector<VkImageView>     inputImageViews;
-        std::vector<VkImageView>     edgeImageViews;
-        std::vector<VkImageView>     blendImageViews;
         std::vector<VkImageView>     outputImageViews;
         std::vector<VkDescriptorSet> imageDescriptorSets;
-        std::vector<VkFramebuffer>   edgeFramebuffers;
-        std::vector<VkFramebuffer>   blendFramebuffers;
         std::vector<VkFramebuffer>   neignborFramebuffers;
-        VkImage                      areaImage;
-        VkImage                      searchImage;
+        // the edge and blend images are only used while the effect gets applied,
+        // so one set is enough for all swapchain images
+        VkImage                      edgeImage;
+        VkImage                      blendImage;
+        VkImageView                  edgeImageView;
+        VkImageView                  blendImageView;
+        VkFramebuffer                edgeFramebuffer  = VK_NULL_HANDLE;
+        VkFramebuffer                blendFramebuffer = VK_NULL_HANDLE;
         VkImageView                  areaImageView;
+        VkImage                      stencilImage;
+        VkImageView                  stencilImageView;
+        VkFormat                     stencilFormat;
         VkImageView                  searchImageView;
         VkDescriptorSetLayout        imageSamplerDescriptorSetLayout;
         VkDescriptorPool             descriptorPool;
@@ -56,18 +61,23 @@ namespace vkBasalt
         VkShaderModule               neighborVertexModule;
         VkShaderModule               neignborFragmentModule;
         VkRenderPass                 renderPass;
-        VkRenderPass                 unormRenderPass;
+        VkRenderPass                 edgeRenderPass;
+        VkRenderPass                 blendRenderPass;
         VkPipelineLayout             pipelineLayout;
         VkPipeline                   edgePipeline;
         VkPipeline                   blendPipeline;
         VkPipeline                   neighborPipeline;
         VkExtent2D                   imageExtent;
+        VkRect2D                     contentRect;
         VkFormat                     format;
-        VkDeviceMemory               imageMemory;
-        VkDeviceMemory               areaMemory;
-        VkDeviceMemory               searchMemory;
+        VkDeviceMemory               edgeImageMemory;
+        VkDeviceMemory               blendImageMemory;
+        VkDeviceMemory               stencilImageMemory;
         VkSampler                    sampler;
 
+        std::shared_ptr<CachedTexture> areaTexture;
+        std::shared_ptr<CachedTexture> searchTexture;
+
         Config* pConfig;
     };
 } // namespace vkBasalt
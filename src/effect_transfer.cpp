@@ -81,6 +81,17 @@ namespace vkBasalt
             commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarrier);
     }
 
+    uint32_t TransferEffect::getDamageRadius()
+    {
+        return 0;
+    }
+
+    bool TransferEffect::isSkippable()
+    {
+        // skipped effects in front of it leave its input as it was the last time, so copying it again changes nothing
+        return true;
+    }
+
     TransferEffect::~TransferEffect()
     {
     }
@@ -27,6 +27,8 @@ namespace vkBasalt
                        std::vector<VkImage> outputImages,
                        Config*              pConfig);
         void virtual applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer) override;
+        uint32_t virtual getDamageRadius() override;
+        bool virtual isSkippable() override;
         virtual ~TransferEffect();
 
     private:
@@ -0,0 +1,48 @@
+#include "effect_upscale.hpp"
+
+#include "image.hpp"
+#include "effect_easu.hpp"
+#include "effect_rcas.hpp"
+#include "logger.hpp"
+
+namespace vkBasalt
+{
+    UpscaleEffect::UpscaleEffect(LogicalDevice*       pLogicalDevice,
+                                 VkFormat             format,
+                                 VkExtent2D           imageExtent,
+                                 std::vector<VkImage> inputImages,
+                                 std::vector<VkImage> outputImages,
+                                 Config*              pConfig)
+    {
+        this->pLogicalDevice = pLogicalDevice;
+
+        upscaledImage = createImages(pLogicalDevice,
+                                     1,
+                                     {imageExtent.width, imageExtent.height, 1},
+                                     format,
+                                     VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+                                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                     upscaledImageMemory)[0];
+
+        std::vector<VkImage> upscaledImages(outputImages.size(), upscaledImage);
+
+        easuEffect = std::shared_ptr<Effect>(new EasuEffect(pLogicalDevice, format, imageExtent, inputImages, upscaledImages, pConfig));
+        rcasEffect = std::shared_ptr<Effect>(new RcasEffect(pLogicalDevice, format, imageExtent, upscaledImages, outputImages, pConfig));
+        Logger::debug("created UpscaleEffect");
+    }
+
+    void UpscaleEffect::applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer)
+    {
+        easuEffect->applyEffect(imageIndex, commandBuffer);
+        rcasEffect->applyEffect(imageIndex, commandBuffer);
+    }
+
+    UpscaleEffect::~UpscaleEffect()
+    {
+        // the passes have views of the image
+        easuEffect.reset();
+        rcasEffect.reset();
+        pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, upscaledImage, nullptr);
+        pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, upscaledImageMemory, nullptr);
+    }
+} // namespace vkBasalt
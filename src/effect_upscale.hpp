@@ -0,0 +1,44 @@
+#ifndef EFFECT_UPSCALE_HPP_INCLUDED
+#define EFFECT_UPSCALE_HPP_INCLUDED
+#include <vector>
+#include <fstream>
+#include <string>
+#include <iostream>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+
+#include "vulkan_include.hpp"
+
+#include "effect.hpp"
+#include "config.hpp"
+
+#include "logical_device.hpp"
+
+namespace vkBasalt
+{
+    // scales the smaller images the application renders to up to the swapchain images
+    // EASU does the edge adaptive upscaling into an image of the output size, RCAS sharpens that into the output images
+    class UpscaleEffect : public Effect
+    {
+    public:
+        UpscaleEffect(LogicalDevice*       pLogicalDevice,
+                      VkFormat             format,
+                      VkExtent2D           imageExtent,
+                      std::vector<VkImage> inputImages,
+                      std::vector<VkImage> outputImages,
+                      Config*              pConfig);
+        void virtual applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer) override;
+        virtual ~UpscaleEffect();
+
+    private:
+        LogicalDevice*          pLogicalDevice;
+        // like the back buffer of the reshade effects, one image serves every swapchain image
+        VkImage                 upscaledImage;
+        VkDeviceMemory          upscaledImageMemory;
+        std::shared_ptr<Effect> easuEffect;
+        std::shared_ptr<Effect> rcasEffect;
+    };
+} // namespace vkBasalt
+
+#endif // EFFECT_UPSCALE_HPP_INCLUDED
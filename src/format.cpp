@@ -113,6 +113,13 @@ namespace vkBasalt
         return VK_FORMAT_UNDEFINED;
     }
 
+    bool isFormatSupported(LogicalDevice* pLogicalDevice, VkFormat format, VkFormatFeatureFlags features)
+    {
+        VkFormatProperties properties;
+        pLogicalDevice->vki.GetPhysicalDeviceFormatProperties(pLogicalDevice->physicalDevice, format, &properties);
+        return (properties.optimalTilingFeatures & features) == features;
+    }
+
     VkFormat getStencilFormat(LogicalDevice* pLogicalDevice)
     {
         std::vector<VkFormat> stencilFormats = {VK_FORMAT_D24_UNORM_S8_UINT, VK_FORMAT_D32_SFLOAT_S8_UINT};
@@ -28,6 +28,9 @@ namespace vkBasalt
                                 VkFormatFeatureFlags  features,
                                 VkImageTiling         tiling = VK_IMAGE_TILING_OPTIMAL);
 
+    // Returns true if format supports all features with optimal tiling
+    bool isFormatSupported(LogicalDevice* pLogicalDevice, VkFormat format, VkFormatFeatureFlags features);
+
     VkFormat getStencilFormat(LogicalDevice* pLogicalDevice);
 
     bool isDepthFormat(VkFormat format);
@@ -0,0 +1,264 @@
+#include "frame_compare.hpp"
+
+#include <cstring>
+
+#include "image_view.hpp"
+#include "buffer.hpp"
+#include "sampler.hpp"
+#include "object_cache.hpp"
+#include "shader.hpp"
+#include "format.hpp"
+#include "util.hpp"
+
+#include "shader_sources.hpp"
+
+namespace vkBasalt
+{
+    namespace
+    {
+        // has to match shader/frame_compare.comp.glsl
+        constexpr uint32_t groupSize = 16;
+
+        // the largest minStorageBufferOffsetAlignment that the spec allows
+        constexpr VkDeviceSize hashAlignment = 256;
+    } // namespace
+
+    FrameComparer::FrameComparer(LogicalDevice* pLogicalDevice, VkFormat format, VkExtent2D imageExtent, std::vector<VkImage> images)
+    {
+        Logger::debug("in creating FrameComparer");
+
+        this->pLogicalDevice = pLogicalDevice;
+        this->imageExtent    = imageExtent;
+        this->images         = images;
+
+        // the bits that the application wrote get hashed, not linear values
+        imageViews = createImageViews(pLogicalDevice, convertToUNORM(format), images);
+        sampler    = createSampler(pLogicalDevice);
+        createShaderModule(pLogicalDevice, frame_compare_comp, &shaderModule);
+
+        VkDescriptorSetLayoutBinding bindings[2];
+        bindings[0].binding            = 0;
+        bindings[0].descriptorType     = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[0].descriptorCount    = 1;
+        bindings[0].stageFlags         = VK_SHADER_STAGE_COMPUTE_BIT;
+        bindings[0].pImmutableSamplers = nullptr;
+
+        bindings[1]                = bindings[0];
+        bindings[1].binding        = 1;
+        bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+
+        VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo;
+        descriptorSetLayoutCreateInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        descriptorSetLayoutCreateInfo.pNext        = nullptr;
+        descriptorSetLayoutCreateInfo.flags        = 0;
+        descriptorSetLayoutCreateInfo.bindingCount = 2;
+        descriptorSetLayoutCreateInfo.pBindings    = bindings;
+
+        descriptorSetLayout = getCachedDescriptorSetLayout(pLogicalDevice, descriptorSetLayoutCreateInfo);
+
+        VkDescriptorPoolSize poolSizes[2];
+        poolSizes[0].type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        poolSizes[0].descriptorCount = images.size();
+        poolSizes[1].type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSizes[1].descriptorCount = images.size();
+
+        VkDescriptorPoolCreateInfo descriptorPoolCreateInfo;
+        descriptorPoolCreateInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        descriptorPoolCreateInfo.pNext         = nullptr;
+        descriptorPoolCreateInfo.flags         = 0;
+        descriptorPoolCreateInfo.maxSets       = images.size();
+        descriptorPoolCreateInfo.poolSizeCount = 2;
+        descriptorPoolCreateInfo.pPoolSizes    = poolSizes;
+
+        VkResult result = pLogicalDevice->vkd.CreateDescriptorPool(pLogicalDevice->device, &descriptorPoolCreateInfo, nullptr, &descriptorPool);
+        ASSERT_VULKAN(result);
+
+        VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo;
+        pipelineLayoutCreateInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutCreateInfo.pNext                  = nullptr;
+        pipelineLayoutCreateInfo.flags                  = 0;
+        pipelineLayoutCreateInfo.setLayoutCount         = 1;
+        pipelineLayoutCreateInfo.pSetLayouts            = &descriptorSetLayout;
+        pipelineLayoutCreateInfo.pushConstantRangeCount = 0;
+        pipelineLayoutCreateInfo.pPushConstantRanges    = nullptr;
+
+        pipelineLayout = getCachedPipelineLayout(pLogicalDevice, pipelineLayoutCreateInfo);
+
+        VkComputePipelineCreateInfo pipelineCreateInfo;
+        pipelineCreateInfo.sType                     = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineCreateInfo.pNext                     = nullptr;
+        pipelineCreateInfo.flags                     = 0;
+        pipelineCreateInfo.stage.sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineCreateInfo.stage.pNext               = nullptr;
+        pipelineCreateInfo.stage.flags               = 0;
+        pipelineCreateInfo.stage.stage               = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineCreateInfo.stage.module              = shaderModule;
+        pipelineCreateInfo.stage.pName               = "main";
+        pipelineCreateInfo.stage.pSpecializationInfo = nullptr;
+        pipelineCreateInfo.layout                    = pipelineLayout;
+        pipelineCreateInfo.basePipelineHandle        = VK_NULL_HANDLE;
+        pipelineCreateInfo.basePipelineIndex         = -1;
+
+        result = pLogicalDevice->vkd.CreateComputePipelines(pLogicalDevice->device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &pipeline);
+        ASSERT_VULKAN(result);
+
+        // the changed flag comes first, then one hash per tile
+        VkDeviceSize tileCount = ((imageExtent.width + groupSize - 1) / groupSize) * ((imageExtent.height + groupSize - 1) / groupSize);
+        hashStride            = ((1 + tileCount) * sizeof(uint32_t) + hashAlignment - 1) / hashAlignment * hashAlignment;
+        createBuffer(pLogicalDevice,
+                     images.size() * hashStride,
+                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_CONDITIONAL_RENDERING_BIT_EXT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     hashBuffer,
+                     hashMemory);
+
+        void* data;
+        result = pLogicalDevice->vkd.MapMemory(pLogicalDevice->device, hashMemory, 0, VK_WHOLE_SIZE, 0, &data);
+        ASSERT_VULKAN(result);
+        pHashes = static_cast<uint8_t*>(data);
+        std::memset(pHashes, 0, images.size() * hashStride);
+
+        // nothing got processed yet
+        forced = std::vector<bool>(images.size(), true);
+
+        descriptorSets = std::vector<VkDescriptorSet>(images.size());
+        std::vector<VkDescriptorSetLayout> descriptorSetLayouts(images.size(), descriptorSetLayout);
+
+        VkDescriptorSetAllocateInfo descriptorSetAllocateInfo;
+        descriptorSetAllocateInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        descriptorSetAllocateInfo.pNext              = nullptr;
+        descriptorSetAllocateInfo.descriptorPool     = descriptorPool;
+        descriptorSetAllocateInfo.descriptorSetCount = descriptorSets.size();
+        descriptorSetAllocateInfo.pSetLayouts        = descriptorSetLayouts.data();
+
+        result = pLogicalDevice->vkd.AllocateDescriptorSets(pLogicalDevice->device, &descriptorSetAllocateInfo, descriptorSets.data());
+        ASSERT_VULKAN(result);
+
+        for (uint32_t i = 0; i < images.size(); i++)
+        {
+            VkDescriptorImageInfo imageInfo;
+            imageInfo.sampler     = sampler;
+            imageInfo.imageView   = imageViews[i];
+            imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+            VkDescriptorBufferInfo hashBufferInfo;
+            hashBufferInfo.buffer = hashBuffer;
+            hashBufferInfo.offset = i * hashStride;
+            hashBufferInfo.range  = hashStride;
+
+            VkWriteDescriptorSet writeDescriptorSets[2];
+            writeDescriptorSets[0].sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writeDescriptorSets[0].pNext            = nullptr;
+            writeDescriptorSets[0].dstSet           = descriptorSets[i];
+            writeDescriptorSets[0].dstBinding       = 0;
+            writeDescriptorSets[0].dstArrayElement  = 0;
+            writeDescriptorSets[0].descriptorCount  = 1;
+            writeDescriptorSets[0].descriptorType   = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            writeDescriptorSets[0].pImageInfo       = &imageInfo;
+            writeDescriptorSets[0].pBufferInfo      = nullptr;
+            writeDescriptorSets[0].pTexelBufferView = nullptr;
+
+            writeDescriptorSets[1]                = writeDescriptorSets[0];
+            writeDescriptorSets[1].dstBinding     = 1;
+            writeDescriptorSets[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writeDescriptorSets[1].pImageInfo     = nullptr;
+            writeDescriptorSets[1].pBufferInfo    = &hashBufferInfo;
+
+            pLogicalDevice->vkd.UpdateDescriptorSets(pLogicalDevice->device, 2, writeDescriptorSets, 0, nullptr);
+        }
+        Logger::debug("created FrameComparer");
+    }
+
+    void FrameComparer::applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer)
+    {
+        Logger::debug("applying FrameComparer to cb " + convertToString(commandBuffer));
+
+        VkImageMemoryBarrier memoryBarrier;
+        memoryBarrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        memoryBarrier.pNext               = nullptr;
+        memoryBarrier.srcAccessMask       = VK_ACCESS_MEMORY_WRITE_BIT;
+        memoryBarrier.dstAccessMask       = VK_ACCESS_SHADER_READ_BIT;
+        memoryBarrier.oldLayout           = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        memoryBarrier.newLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        memoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        memoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        memoryBarrier.image               = images[imageIndex];
+
+        memoryBarrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        memoryBarrier.subresourceRange.baseMipLevel   = 0;
+        memoryBarrier.subresourceRange.levelCount     = 1;
+        memoryBarrier.subresourceRange.baseArrayLayer = 0;
+        memoryBarrier.subresourceRange.layerCount     = 1;
+
+        pLogicalDevice->vkd.CmdPipelineBarrier(
+            commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarrier);
+
+        pLogicalDevice->vkd.CmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+        pLogicalDevice->vkd.CmdBindDescriptorSets(
+            commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSets[imageIndex], 0, nullptr);
+        pLogicalDevice->vkd.CmdDispatch(
+            commandBuffer, (imageExtent.width + groupSize - 1) / groupSize, (imageExtent.height + groupSize - 1) / groupSize, 1);
+
+        // the changed flag is the predicate of the effects that follow
+        VkMemoryBarrier changedBarrier;
+        changedBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        changedBarrier.pNext         = nullptr;
+        changedBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        changedBarrier.dstAccessMask = VK_ACCESS_CONDITIONAL_RENDERING_READ_BIT_EXT;
+
+        memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        memoryBarrier.dstAccessMask = 0;
+        memoryBarrier.oldLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        memoryBarrier.newLayout     = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+        pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer,
+                                               VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                               VK_PIPELINE_STAGE_CONDITIONAL_RENDERING_BIT_EXT | VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                                               0,
+                                               1,
+                                               &changedBarrier,
+                                               0,
+                                               nullptr,
+                                               1,
+                                               &memoryBarrier);
+    }
+
+    void FrameComparer::updateEffect(uint32_t imageIndex)
+    {
+        // the shader only ever sets the flag, the present waited on the fence of the image so nothing on the gpu uses it right now
+        *reinterpret_cast<uint32_t*>(pHashes + imageIndex * hashStride) = forced[imageIndex] ? 1 : 0;
+        forced[imageIndex]                                              = false;
+    }
+
+    void FrameComparer::forceChanges()
+    {
+        forced.assign(images.size(), true);
+    }
+
+    VkBuffer FrameComparer::getChangedBuffer()
+    {
+        return hashBuffer;
+    }
+
+    VkDeviceSize FrameComparer::getChangedOffset(uint32_t imageIndex)
+    {
+        return imageIndex * hashStride;
+    }
+
+    FrameComparer::~FrameComparer()
+    {
+        Logger::debug("destroying FrameComparer " + convertToString(this));
+        pLogicalDevice->vkd.DestroyPipeline(pLogicalDevice->device, pipeline, nullptr);
+        releaseCachedObject<VK_OBJECT_TYPE_PIPELINE_LAYOUT>(pLogicalDevice, pipelineLayout);
+        pLogicalDevice->vkd.DestroyDescriptorPool(pLogicalDevice->device, descriptorPool, nullptr);
+        releaseCachedObject<VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT>(pLogicalDevice, descriptorSetLayout);
+        pLogicalDevice->vkd.DestroyShaderModule(pLogicalDevice->device, shaderModule, nullptr);
+        releaseCachedObject<VK_OBJECT_TYPE_SAMPLER>(pLogicalDevice, sampler);
+        for (auto& imageView : imageViews)
+        {
+            pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, imageView, nullptr);
+        }
+        pLogicalDevice->vkd.DestroyBuffer(pLogicalDevice->device, hashBuffer, nullptr);
+        pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, hashMemory, nullptr);
+    }
+} // namespace vkBasalt
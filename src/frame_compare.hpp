@@ -0,0 +1,52 @@
+#ifndef FRAME_COMPARE_HPP_INCLUDED
+#define FRAME_COMPARE_HPP_INCLUDED
+#include <vector>
+
+#include "vulkan_include.hpp"
+
+#include "effect.hpp"
+
+#include "logical_device.hpp"
+
+namespace vkBasalt
+{
+    // Finds out on the gpu if an image of the application is the same as the last time it got submitted, see shader/frame_compare.comp.glsl.
+    // It gets submitted in front of the effects, which run inside of conditional rendering on its result,
+    // so identical frames leave the outputs of the last time for the swapchain image alone.
+    class FrameComparer : public Effect
+    {
+    public:
+        FrameComparer(LogicalDevice* pLogicalDevice, VkFormat format, VkExtent2D imageExtent, std::vector<VkImage> images);
+        void virtual applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer) override;
+        // resets the result of the image, only after the fence of the last submission for it signaled,
+        // that submission may still read the result as predicate or write it from the shader
+        void virtual updateEffect(uint32_t imageIndex) override;
+        // the next submission of every image counts as changed, for when the outputs of the last time are not valid anymore
+        void forceChanges();
+        // one uint32_t per image that is not 0 if the image changed, it can be the predicate of conditional rendering
+        VkBuffer     getChangedBuffer();
+        VkDeviceSize getChangedOffset(uint32_t imageIndex);
+        virtual ~FrameComparer();
+
+    private:
+        LogicalDevice*               pLogicalDevice;
+        VkExtent2D                   imageExtent;
+        std::vector<VkImage>         images;
+        std::vector<VkImageView>     imageViews;
+        VkSampler                    sampler;
+        VkShaderModule               shaderModule;
+        VkDescriptorSetLayout        descriptorSetLayout;
+        VkDescriptorPool             descriptorPool;
+        std::vector<VkDescriptorSet> descriptorSets;
+        VkPipelineLayout             pipelineLayout;
+        VkPipeline                   pipeline;
+        // the changed flag and the tile hashes of every image, persistently mapped
+        VkBuffer                     hashBuffer;
+        VkDeviceMemory               hashMemory;
+        uint8_t*                     pHashes;
+        VkDeviceSize                 hashStride;
+        std::vector<bool>            forced;
+    };
+} // namespace vkBasalt
+
+#endif // FRAME_COMPARE_HPP_INCLUDED
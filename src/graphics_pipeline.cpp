@@ -1,35 +1,72 @@
 #include "graphics_pipeline.hpp"
 
+#include "object_cache.hpp"
+#include "shader.hpp"
+
 namespace vkBasalt
 {
-    VkPipelineLayout createGraphicsPipelineLayout(LogicalDevice* pLogicalDevice, std::vector<VkDescriptorSetLayout> descriptorSetLayouts)
+    namespace
+    {
+        VkGraphicsPipelineCreateInfo getEmptyPipelineCreateInfo()
+        {
+            VkGraphicsPipelineCreateInfo pipelineCreateInfo = {};
+            pipelineCreateInfo.sType                        = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+            pipelineCreateInfo.basePipelineHandle           = VK_NULL_HANDLE;
+            pipelineCreateInfo.basePipelineIndex            = -1;
+            return pipelineCreateInfo;
+        }
+
+        VkPipeline createPipelineLibrary(LogicalDevice*                    pLogicalDevice,
+                                         VkGraphicsPipelineLibraryFlagsEXT libraryFlags,
+                                         VkGraphicsPipelineCreateInfo      pipelineCreateInfo)
+        {
+            VkGraphicsPipelineLibraryCreateInfoEXT libraryCreateInfo;
+            libraryCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT;
+            libraryCreateInfo.pNext = const_cast<void*>(pipelineCreateInfo.pNext);
+            libraryCreateInfo.flags = libraryFlags;
+
+            pipelineCreateInfo.pNext = &libraryCreateInfo;
+            pipelineCreateInfo.flags |= VK_PIPELINE_CREATE_LIBRARY_BIT_KHR;
+
+            VkPipeline library;
+            VkResult   result =
+                pLogicalDevice->vkd.CreateGraphicsPipelines(pLogicalDevice->device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &library);
+            ASSERT_VULKAN(result);
+            return library;
+        }
+    } // namespace
+
+    VkPipelineLayout createGraphicsPipelineLayout(LogicalDevice*                          pLogicalDevice,
+                                                  std::vector<VkDescriptorSetLayout>      descriptorSetLayouts,
+                                                  VkPipelineLayoutCreateFlags             flags,
+                                                  const std::vector<VkPushConstantRange>& pushConstantRanges)
     {
         VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo;
         pipelineLayoutCreateInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
         pipelineLayoutCreateInfo.pNext                  = nullptr;
-        pipelineLayoutCreateInfo.flags                  = 0;
+        pipelineLayoutCreateInfo.flags                  = flags;
         pipelineLayoutCreateInfo.setLayoutCount         = descriptorSetLayouts.size();
         pipelineLayoutCreateInfo.pSetLayouts            = descriptorSetLayouts.data();
-        pipelineLayoutCreateInfo.pushConstantRangeCount = 0;
-        pipelineLayoutCreateInfo.pPushConstantRanges    = nullptr;
+        pipelineLayoutCreateInfo.pushConstantRangeCount = pushConstantRanges.size();
+        pipelineLayoutCreateInfo.pPushConstantRanges    = pushConstantRanges.data();
 
-        VkPipelineLayout pipelineLayout;
-        VkResult result = pLogicalDevice->vkd.CreatePipelineLayout(pLogicalDevice->device, &pipelineLayoutCreateInfo, nullptr, &pipelineLayout);
-        ASSERT_VULKAN(result);
-        return pipelineLayout;
+        return getCachedPipelineLayout(pLogicalDevice, pipelineLayoutCreateInfo);
     }
 
-    VkPipeline createGraphicsPipeline(LogicalDevice*        pLogicalDevice,
-                                      VkShaderModule        vertexModule,
-                                      VkSpecializationInfo* vertexSpecializationInfo,
-                                      std::string           vertexEntryPoint,
-                                      VkShaderModule        fragmentModule,
-                                      VkSpecializationInfo* fragmentSpecializationInfo,
-                                      std::string           fragmentEntryPoint,
-                                      VkExtent2D            extent,
-                                      VkRenderPass          renderPass,
-                                      VkPipelineLayout      pipelineLayout,
-                                      bool                  flip)
+    VkPipeline createGraphicsPipeline(LogicalDevice*                               pLogicalDevice,
+                                      VkShaderModule                               vertexModule,
+                                      VkSpecializationInfo*                        vertexSpecializationInfo,
+                                      std::string                                  vertexEntryPoint,
+                                      VkShaderModule                               fragmentModule,
+                                      VkSpecializationInfo*                        fragmentSpecializationInfo,
+                                      std::string                                  fragmentEntryPoint,
+                                      VkExtent2D                                   extent,
+                                      VkRenderPass                                 renderPass,
+                                      VkPipelineLayout                             pipelineLayout,
+                                      bool                                         flip,
+                                      const VkPipelineRenderingCreateInfoKHR*      pRenderingCreateInfo,
+                                      const VkPipelineDepthStencilStateCreateInfo* pDepthStencilState,
+                                      uint32_t                                     maxShadingRate)
     {
         VkResult result;
 
@@ -79,10 +116,7 @@ namespace vkBasalt
         viewport.minDepth = 0.0f;
         viewport.maxDepth = 1.0f;
 
-        VkRect2D scissor;
-        scissor.offset = {0, 0};
-        scissor.extent = {extent.width, extent.height};
-
+        // the scissor is dynamic, so that effects can limit themselves to the content of letterboxed images
         VkPipelineViewportStateCreateInfo viewportStateCreateInfo;
         viewportStateCreateInfo.sType         = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
         viewportStateCreateInfo.pNext         = nullptr;
@@ -90,7 +124,7 @@ namespace vkBasalt
         viewportStateCreateInfo.viewportCount = 1;
         viewportStateCreateInfo.pViewports    = &viewport;
         viewportStateCreateInfo.scissorCount  = 1;
-        viewportStateCreateInfo.pScissors     = &scissor;
+        viewportStateCreateInfo.pScissors     = nullptr;
 
         VkPipelineRasterizationStateCreateInfo rasterizationCreateInfo;
         rasterizationCreateInfo.sType                   = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
@@ -143,19 +177,29 @@ namespace vkBasalt
         colorBlendCreateInfo.blendConstants[2] = 0.0f;
         colorBlendCreateInfo.blendConstants[3] = 0.0f;
 
-        VkDynamicState dynamicStates[] = {};
+        VkDynamicState dynamicStates[] = {VK_DYNAMIC_STATE_SCISSOR};
 
         VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo;
         dynamicStateCreateInfo.sType             = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
         dynamicStateCreateInfo.pNext             = nullptr;
         dynamicStateCreateInfo.flags             = 0;
-        dynamicStateCreateInfo.dynamicStateCount = 0;
+        dynamicStateCreateInfo.dynamicStateCount = 1;
         dynamicStateCreateInfo.pDynamicStates    = dynamicStates;
 
+        // the rate of the pipeline is the upper limit for the rate of the shading rate image
+        VkPipelineFragmentShadingRateStateCreateInfoKHR shadingRateCreateInfo;
+        shadingRateCreateInfo.sType          = VK_STRUCTURE_TYPE_PIPELINE_FRAGMENT_SHADING_RATE_STATE_CREATE_INFO_KHR;
+        shadingRateCreateInfo.pNext          = pRenderingCreateInfo;
+        shadingRateCreateInfo.fragmentSize   = {maxShadingRate, maxShadingRate};
+        shadingRateCreateInfo.combinerOps[0] = VK_FRAGMENT_SHADING_RATE_COMBINER_OP_KEEP_KHR;
+        shadingRateCreateInfo.combinerOps[1] = VK_FRAGMENT_SHADING_RATE_COMBINER_OP_MIN_KHR;
+
+        bool useShadingRate = maxShadingRate > 1;
+
         VkGraphicsPipelineCreateInfo pipelineCreateInfo;
         pipelineCreateInfo.sType               = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-        pipelineCreateInfo.pNext               = nullptr;
-        pipelineCreateInfo.flags               = 0;
+        pipelineCreateInfo.pNext               = useShadingRate ? &shadingRateCreateInfo : static_cast<const void*>(pRenderingCreateInfo);
+        pipelineCreateInfo.flags               = useShadingRate ? VK_PIPELINE_CREATE_RENDERING_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR : 0;
         pipelineCreateInfo.stageCount          = 2;
         pipelineCreateInfo.pStages             = shaderStages;
         pipelineCreateInfo.pVertexInputState   = &vertexInputCreateInfo;
@@ -164,7 +208,7 @@ namespace vkBasalt
         pipelineCreateInfo.pViewportState      = &viewportStateCreateInfo;
         pipelineCreateInfo.pRasterizationState = &rasterizationCreateInfo;
         pipelineCreateInfo.pMultisampleState   = &multisampleCreateInfo;
-        pipelineCreateInfo.pDepthStencilState  = nullptr;
+        pipelineCreateInfo.pDepthStencilState  = pDepthStencilState;
         pipelineCreateInfo.pColorBlendState    = &colorBlendCreateInfo;
         pipelineCreateInfo.pDynamicState       = &dynamicStateCreateInfo;
         pipelineCreateInfo.layout              = pipelineLayout;
@@ -178,4 +222,231 @@ namespace vkBasalt
 
         return pipeline;
     }
+
+    VkPipeline createLinkedGraphicsPipeline(LogicalDevice*                          pLogicalDevice,
+                                            const std::vector<uint32_t>&            vertexCode,
+                                            VkDescriptorSetLayout                   vertexDescriptorSetLayout,
+                                            VkShaderModule                          fragmentModule,
+                                            VkSpecializationInfo*                   fragmentSpecializationInfo,
+                                            std::string                             fragmentEntryPoint,
+                                            VkExtent2D                              extent,
+                                            VkRenderPass                            renderPass,
+                                            VkPipelineLayout                        pipelineLayout,
+                                            std::vector<VkPipeline>&                sharedLibraries,
+                                            VkPipeline&                             fragmentLibrary,
+                                            const VkPipelineRenderingCreateInfoKHR* pRenderingCreateInfo)
+    {
+        // without a render pass the libraries depend on the attachment formats instead
+        std::vector<uint64_t> renderingKey = {(uint64_t) renderPass};
+        if (pRenderingCreateInfo)
+        {
+            renderingKey.push_back(pRenderingCreateInfo->stencilAttachmentFormat);
+            renderingKey.insert(renderingKey.end(),
+                                pRenderingCreateInfo->pColorAttachmentFormats,
+                                pRenderingCreateInfo->pColorAttachmentFormats + pRenderingCreateInfo->colorAttachmentCount);
+        }
+
+        VkPipelineVertexInputStateCreateInfo vertexInputCreateInfo;
+        vertexInputCreateInfo.sType                           = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+        vertexInputCreateInfo.pNext                           = nullptr;
+        vertexInputCreateInfo.flags                           = 0;
+        vertexInputCreateInfo.vertexBindingDescriptionCount   = 0;
+        vertexInputCreateInfo.pVertexBindingDescriptions      = nullptr;
+        vertexInputCreateInfo.vertexAttributeDescriptionCount = 0;
+        vertexInputCreateInfo.pVertexAttributeDescriptions    = nullptr;
+
+        VkPipelineInputAssemblyStateCreateInfo inputAssemblyCreateInfo;
+        inputAssemblyCreateInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+        inputAssemblyCreateInfo.pNext                  = nullptr;
+        inputAssemblyCreateInfo.flags                  = 0;
+        inputAssemblyCreateInfo.topology               = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        inputAssemblyCreateInfo.primitiveRestartEnable = VK_FALSE;
+
+        VkViewport viewport;
+        viewport.x        = 0.0f;
+        viewport.y        = 0.0f;
+        viewport.width    = static_cast<float>(extent.width);
+        viewport.height   = static_cast<float>(extent.height);
+        viewport.minDepth = 0.0f;
+        viewport.maxDepth = 1.0f;
+
+        // the scissor is dynamic, so that effects can limit themselves to the content of letterboxed images
+        VkPipelineViewportStateCreateInfo viewportStateCreateInfo;
+        viewportStateCreateInfo.sType         = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+        viewportStateCreateInfo.pNext         = nullptr;
+        viewportStateCreateInfo.flags         = 0;
+        viewportStateCreateInfo.viewportCount = 1;
+        viewportStateCreateInfo.pViewports    = &viewport;
+        viewportStateCreateInfo.scissorCount  = 1;
+        viewportStateCreateInfo.pScissors     = nullptr;
+
+        VkPipelineRasterizationStateCreateInfo rasterizationCreateInfo;
+        rasterizationCreateInfo.sType                   = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+        rasterizationCreateInfo.pNext                   = nullptr;
+        rasterizationCreateInfo.flags                   = 0;
+        rasterizationCreateInfo.depthClampEnable        = VK_FALSE;
+        rasterizationCreateInfo.rasterizerDiscardEnable = VK_FALSE;
+        rasterizationCreateInfo.polygonMode             = VK_POLYGON_MODE_FILL;
+        rasterizationCreateInfo.cullMode                = VK_CULL_MODE_NONE;
+        rasterizationCreateInfo.frontFace               = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+        rasterizationCreateInfo.depthBiasEnable         = VK_FALSE;
+        rasterizationCreateInfo.depthBiasConstantFactor = 0.0f;
+        rasterizationCreateInfo.depthBiasClamp          = 0.0f;
+        rasterizationCreateInfo.depthBiasSlopeFactor    = 0.0f;
+        rasterizationCreateInfo.lineWidth               = 1.0f;
+
+        VkPipelineMultisampleStateCreateInfo multisampleCreateInfo;
+        multisampleCreateInfo.sType                 = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+        multisampleCreateInfo.pNext                 = nullptr;
+        multisampleCreateInfo.flags                 = 0;
+        multisampleCreateInfo.rasterizationSamples  = VK_SAMPLE_COUNT_1_BIT;
+        multisampleCreateInfo.sampleShadingEnable   = VK_FALSE;
+        multisampleCreateInfo.minSampleShading      = 1.0f;
+        multisampleCreateInfo.pSampleMask           = nullptr;
+        multisampleCreateInfo.alphaToCoverageEnable = VK_FALSE;
+        multisampleCreateInfo.alphaToOneEnable      = VK_FALSE;
+
+        VkPipelineColorBlendAttachmentState colorBlendAttachment;
+        colorBlendAttachment.blendEnable         = VK_FALSE;
+        colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+        colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        colorBlendAttachment.colorBlendOp        = VK_BLEND_OP_ADD;
+        colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+        colorBlendAttachment.alphaBlendOp        = VK_BLEND_OP_ADD;
+        colorBlendAttachment.colorWriteMask =
+            VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+        VkPipelineColorBlendStateCreateInfo colorBlendCreateInfo;
+        colorBlendCreateInfo.sType             = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+        colorBlendCreateInfo.pNext             = nullptr;
+        colorBlendCreateInfo.flags             = 0;
+        colorBlendCreateInfo.logicOpEnable     = VK_FALSE;
+        colorBlendCreateInfo.logicOp           = VK_LOGIC_OP_NO_OP;
+        colorBlendCreateInfo.attachmentCount   = 1;
+        colorBlendCreateInfo.pAttachments      = &colorBlendAttachment;
+        colorBlendCreateInfo.blendConstants[0] = 0.0f;
+        colorBlendCreateInfo.blendConstants[1] = 0.0f;
+        colorBlendCreateInfo.blendConstants[2] = 0.0f;
+        colorBlendCreateInfo.blendConstants[3] = 0.0f;
+
+        VkDynamicState dynamicStates[] = {VK_DYNAMIC_STATE_SCISSOR};
+
+        VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo;
+        dynamicStateCreateInfo.sType             = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+        dynamicStateCreateInfo.pNext             = nullptr;
+        dynamicStateCreateInfo.flags             = 0;
+        dynamicStateCreateInfo.dynamicStateCount = 1;
+        dynamicStateCreateInfo.pDynamicStates    = dynamicStates;
+
+        // the vertex input interface is the same for every full screen pass
+        VkPipeline vertexInputLibrary = getCachedPipelineLibrary(pLogicalDevice, {VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT}, [&]() {
+            VkGraphicsPipelineCreateInfo pipelineCreateInfo = getEmptyPipelineCreateInfo();
+            pipelineCreateInfo.pVertexInputState            = &vertexInputCreateInfo;
+            pipelineCreateInfo.pInputAssemblyState          = &inputAssemblyCreateInfo;
+            return createPipelineLibrary(pLogicalDevice, VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT, pipelineCreateInfo);
+        });
+
+        // the library of the vertex stage gets created with a layout of only the set it reads
+        // and can be linked with every fragment stage that uses the same set 0, as long as both use independent sets
+        std::vector<uint64_t> preRasterizationKey = {VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+                                                     extent.width,
+                                                     extent.height,
+                                                     (uint64_t) vertexDescriptorSetLayout};
+        preRasterizationKey.insert(preRasterizationKey.end(), renderingKey.begin(), renderingKey.end());
+        preRasterizationKey.insert(preRasterizationKey.end(), vertexCode.begin(), vertexCode.end());
+
+        VkPipeline preRasterizationLibrary = getCachedPipelineLibrary(pLogicalDevice, preRasterizationKey, [&]() {
+            VkShaderModule vertexModule;
+            createShaderModule(pLogicalDevice, vertexCode, &vertexModule);
+            std::vector<VkDescriptorSetLayout> vertexDescriptorSetLayouts;
+            if (vertexDescriptorSetLayout != VK_NULL_HANDLE)
+            {
+                vertexDescriptorSetLayouts.push_back(vertexDescriptorSetLayout);
+            }
+            VkPipelineLayout vertexPipelineLayout =
+                createGraphicsPipelineLayout(pLogicalDevice, vertexDescriptorSetLayouts, VK_PIPELINE_LAYOUT_CREATE_INDEPENDENT_SETS_BIT_EXT);
+
+            VkPipelineShaderStageCreateInfo shaderStageCreateInfoVert;
+            shaderStageCreateInfoVert.sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+            shaderStageCreateInfoVert.pNext               = nullptr;
+            shaderStageCreateInfoVert.flags               = 0;
+            shaderStageCreateInfoVert.stage               = VK_SHADER_STAGE_VERTEX_BIT;
+            shaderStageCreateInfoVert.module              = vertexModule;
+            shaderStageCreateInfoVert.pName               = "main";
+            shaderStageCreateInfoVert.pSpecializationInfo = nullptr;
+
+            VkGraphicsPipelineCreateInfo pipelineCreateInfo = getEmptyPipelineCreateInfo();
+            pipelineCreateInfo.pNext                        = pRenderingCreateInfo;
+            pipelineCreateInfo.stageCount                   = 1;
+            pipelineCreateInfo.pStages                      = &shaderStageCreateInfoVert;
+            pipelineCreateInfo.pViewportState               = &viewportStateCreateInfo;
+            pipelineCreateInfo.pRasterizationState          = &rasterizationCreateInfo;
+            pipelineCreateInfo.pDynamicState                = &dynamicStateCreateInfo;
+            pipelineCreateInfo.layout                       = vertexPipelineLayout;
+            pipelineCreateInfo.renderPass                   = renderPass;
+            pipelineCreateInfo.subpass                      = 0;
+
+            VkPipeline library = createPipelineLibrary(pLogicalDevice, VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT, pipelineCreateInfo);
+
+            // neither is needed after the library is created
+            pLogicalDevice->vkd.DestroyShaderModule(pLogicalDevice->device, vertexModule, nullptr);
+            releaseCachedObject<VK_OBJECT_TYPE_PIPELINE_LAYOUT>(pLogicalDevice, vertexPipelineLayout);
+            return library;
+        });
+
+        std::vector<uint64_t> outputKey = {VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT};
+        outputKey.insert(outputKey.end(), renderingKey.begin(), renderingKey.end());
+
+        VkPipeline outputLibrary = getCachedPipelineLibrary(pLogicalDevice, outputKey, [&]() {
+            VkGraphicsPipelineCreateInfo pipelineCreateInfo = getEmptyPipelineCreateInfo();
+            pipelineCreateInfo.pNext                        = pRenderingCreateInfo;
+            pipelineCreateInfo.pMultisampleState            = &multisampleCreateInfo;
+            pipelineCreateInfo.pColorBlendState             = &colorBlendCreateInfo;
+            pipelineCreateInfo.renderPass                   = renderPass;
+            pipelineCreateInfo.subpass                      = 0;
+            return createPipelineLibrary(pLogicalDevice, VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT, pipelineCreateInfo);
+        });
+
+        sharedLibraries = {vertexInputLibrary, preRasterizationLibrary, outputLibrary};
+
+        VkPipelineShaderStageCreateInfo shaderStageCreateInfoFrag;
+        shaderStageCreateInfoFrag.sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        shaderStageCreateInfoFrag.pNext               = nullptr;
+        shaderStageCreateInfoFrag.flags               = 0;
+        shaderStageCreateInfoFrag.stage               = VK_SHADER_STAGE_FRAGMENT_BIT;
+        shaderStageCreateInfoFrag.module              = fragmentModule;
+        shaderStageCreateInfoFrag.pName               = fragmentEntryPoint.c_str();
+        shaderStageCreateInfoFrag.pSpecializationInfo = fragmentSpecializationInfo;
+
+        VkGraphicsPipelineCreateInfo fragmentCreateInfo = getEmptyPipelineCreateInfo();
+        fragmentCreateInfo.pNext                        = pRenderingCreateInfo;
+        fragmentCreateInfo.stageCount                   = 1;
+        fragmentCreateInfo.pStages                      = &shaderStageCreateInfoFrag;
+        fragmentCreateInfo.pMultisampleState            = &multisampleCreateInfo;
+        fragmentCreateInfo.layout                       = pipelineLayout;
+        fragmentCreateInfo.renderPass                   = renderPass;
+        fragmentCreateInfo.subpass                      = 0;
+
+        fragmentLibrary = createPipelineLibrary(pLogicalDevice, VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT, fragmentCreateInfo);
+
+        VkPipeline libraries[] = {vertexInputLibrary, preRasterizationLibrary, fragmentLibrary, outputLibrary};
+
+        VkPipelineLibraryCreateInfoKHR libraryCreateInfo;
+        libraryCreateInfo.sType        = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+        libraryCreateInfo.pNext        = nullptr;
+        libraryCreateInfo.libraryCount = 4;
+        libraryCreateInfo.pLibraries   = libraries;
+
+        VkGraphicsPipelineCreateInfo pipelineCreateInfo = getEmptyPipelineCreateInfo();
+        pipelineCreateInfo.pNext                        = &libraryCreateInfo;
+        pipelineCreateInfo.layout                       = pipelineLayout;
+
+        VkPipeline pipeline;
+        VkResult   result =
+            pLogicalDevice->vkd.CreateGraphicsPipelines(pLogicalDevice->device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &pipeline);
+        ASSERT_VULKAN(result);
+
+        return pipeline;
+    }
 } // namespace vkBasalt
@@ -13,19 +13,49 @@
 
 namespace vkBasalt
 {
-    VkPipelineLayout createGraphicsPipelineLayout(LogicalDevice* pLogicalDevice, std::vector<VkDescriptorSetLayout> descriptorSetLayouts);
+    // the layout is shared through the object cache of the device, release it with releaseCachedObject
+    VkPipelineLayout createGraphicsPipelineLayout(LogicalDevice*                          pLogicalDevice,
+                                                  std::vector<VkDescriptorSetLayout>      descriptorSetLayouts,
+                                                  VkPipelineLayoutCreateFlags             flags              = 0,
+                                                  const std::vector<VkPushConstantRange>& pushConstantRanges = {});
 
-    VkPipeline createGraphicsPipeline(LogicalDevice*        pLogicalDevice,
-                                      VkShaderModule        vertexModule,
-                                      VkSpecializationInfo* vertexSpecializationInfo,
-                                      std::string           vertexEntryPoint,
-                                      VkShaderModule        fragmentModule,
-                                      VkSpecializationInfo* fragmentSpecializationInfo,
-                                      std::string           fragmentEntryPoint,
-                                      VkExtent2D            extent,
-                                      VkRenderPass          renderPass,
-                                      VkPipelineLayout      pipelineLayout,
-                                      bool                  flip = false);
+    // the scissor of the pipelines is dynamic state, it has to be set after binding them
+    // with a maxShadingRate above 1 the pipeline has to be used with a shading rate image in dynamic rendering,
+    // it shades up to maxShadingRate x maxShadingRate pixels at once where the image allows it
+    VkPipeline createGraphicsPipeline(LogicalDevice*                               pLogicalDevice,
+                                      VkShaderModule                               vertexModule,
+                                      VkSpecializationInfo*                        vertexSpecializationInfo,
+                                      std::string                                  vertexEntryPoint,
+                                      VkShaderModule                               fragmentModule,
+                                      VkSpecializationInfo*                        fragmentSpecializationInfo,
+                                      std::string                                  fragmentEntryPoint,
+                                      VkExtent2D                                   extent,
+                                      VkRenderPass                                 renderPass,
+                                      VkPipelineLayout                             pipelineLayout,
+                                      bool                                         flip                 = false,
+                                      const VkPipelineRenderingCreateInfoKHR*      pRenderingCreateInfo = nullptr,
+                                      const VkPipelineDepthStencilStateCreateInfo* pDepthStencilState   = nullptr,
+                                      uint32_t                                     maxShadingRate       = 1);
+
+    // same as createGraphicsPipeline without specialization of the vertex stage, but links the pipeline from pipeline libraries
+    // the libraries of the vertex stage and the output interface are shared by all effects of the device,
+    // only the fragment stage gets compiled for every call
+    // vertexDescriptorSetLayout is set 0 of the pipeline layout if the vertex stage reads descriptors, VK_NULL_HANDLE otherwise
+    // the pipeline layout has to be created with VK_PIPELINE_LAYOUT_CREATE_INDEPENDENT_SETS_BIT_EXT
+    // with pRenderingCreateInfo the pipelines are used for dynamic rendering and renderPass has to be VK_NULL_HANDLE
+    // sharedLibraries need to be released with releaseCachedObject and fragmentLibrary destroyed together with the pipeline
+    VkPipeline createLinkedGraphicsPipeline(LogicalDevice*                          pLogicalDevice,
+                                            const std::vector<uint32_t>&            vertexCode,
+                                            VkDescriptorSetLayout                   vertexDescriptorSetLayout,
+                                            VkShaderModule                          fragmentModule,
+                                            VkSpecializationInfo*                   fragmentSpecializationInfo,
+                                            std::string                             fragmentEntryPoint,
+                                            VkExtent2D                              extent,
+                                            VkRenderPass                            renderPass,
+                                            VkPipelineLayout                        pipelineLayout,
+                                            std::vector<VkPipeline>&                sharedLibraries,
+                                            VkPipeline&                             fragmentLibrary,
+                                            const VkPipelineRenderingCreateInfoKHR* pRenderingCreateInfo = nullptr);
 
 } // namespace vkBasalt
 
@@ -1,4 +1,7 @@
 #include "image.hpp"
+
+#include <algorithm>
+
 #include "memory.hpp"
 #include "buffer.hpp"
 #include "format.hpp"
@@ -86,20 +89,41 @@ namespace vkBasalt
     void
     uploadToImage(LogicalDevice* pLogicalDevice, VkImage image, VkExtent3D extent, uint32_t size, const unsigned char* writeData, uint32_t mipLevels)
     {
+        uploadToImages(pLogicalDevice, {{image, extent, size, writeData, mipLevels}});
+    }
+
+    void uploadToImages(LogicalDevice* pLogicalDevice, const std::vector<ImageUpload>& uploads)
+    {
+        if (uploads.empty())
+        {
+            return;
+        }
+
+        // every upload gets its own aligned region in one staging buffer
+        std::vector<VkDeviceSize> offsets(uploads.size());
+        VkDeviceSize              stagingSize = 0;
+        for (uint32_t i = 0; i < uploads.size(); i++)
+        {
+            offsets[i]  = stagingSize;
+            stagingSize = (stagingSize + uploads[i].size + 15) & ~VkDeviceSize(15);
+        }
 
         VkBuffer       stagingBuffer;
         VkDeviceMemory stagingMemory;
 
         createBuffer(pLogicalDevice,
-                     size,
+                     stagingSize,
                      VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
                      stagingBuffer,
                      stagingMemory);
         void*    data;
-        VkResult result = pLogicalDevice->vkd.MapMemory(pLogicalDevice->device, stagingMemory, 0, size, 0, &data);
+        VkResult result = pLogicalDevice->vkd.MapMemory(pLogicalDevice->device, stagingMemory, 0, stagingSize, 0, &data);
         ASSERT_VULKAN(result);
-        std::memcpy(data, writeData, size);
+        for (uint32_t i = 0; i < uploads.size(); i++)
+        {
+            std::memcpy(static_cast<unsigned char*>(data) + offsets[i], uploads[i].pData, uploads[i].size);
+        }
         pLogicalDevice->vkd.UnmapMemory(pLogicalDevice->device, stagingMemory);
 
         VkCommandBufferAllocateInfo allocInfo = {};
@@ -130,40 +154,96 @@ namespace vkBasalt
         memoryBarrier.newLayout                       = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
         memoryBarrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
         memoryBarrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
-        memoryBarrier.image                           = image;
+        memoryBarrier.image                           = VK_NULL_HANDLE;
         memoryBarrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
         memoryBarrier.subresourceRange.baseMipLevel   = 0;
         memoryBarrier.subresourceRange.levelCount     = 1;
         memoryBarrier.subresourceRange.baseArrayLayer = 0;
         memoryBarrier.subresourceRange.layerCount     = 1;
 
-        pLogicalDevice->vkd.CmdPipelineBarrier(
-            commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarrier);
-
-        VkBufferImageCopy region;
-        region.bufferOffset                    = 0;
-        region.bufferRowLength                 = 0;
-        region.bufferImageHeight               = 0;
-        region.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
-        region.imageSubresource.mipLevel       = 0;
-        region.imageSubresource.baseArrayLayer = 0;
-        region.imageSubresource.layerCount     = 1;
-        region.imageOffset                     = {0, 0, 0};
-        region.imageExtent                     = extent;
+        std::vector<VkImageMemoryBarrier> memoryBarriers(uploads.size(), memoryBarrier);
+        for (uint32_t i = 0; i < uploads.size(); i++)
+        {
+            memoryBarriers[i].image = uploads[i].image;
+            // levels that come with the data get copied instead of generated
+            if (!uploads[i].levelSizes.empty())
+            {
+                memoryBarriers[i].subresourceRange.levelCount = uploads[i].levelSizes.size();
+            }
+        }
 
-        pLogicalDevice->vkd.CmdCopyBufferToImage(commandBuffer, stagingBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+        pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer,
+                                               VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                               VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                               0,
+                                               0,
+                                               nullptr,
+                                               0,
+                                               nullptr,
+                                               memoryBarriers.size(),
+                                               memoryBarriers.data());
+
+        for (uint32_t i = 0; i < uploads.size(); i++)
+        {
+            VkBufferImageCopy region;
+            region.bufferOffset                    = offsets[i];
+            region.bufferRowLength                 = 0;
+            region.bufferImageHeight               = 0;
+            region.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel       = 0;
+            region.imageSubresource.baseArrayLayer = 0;
+            region.imageSubresource.layerCount     = 1;
+            region.imageOffset                     = {0, 0, 0};
+            region.imageExtent                     = uploads[i].extent;
+
+            std::vector<VkBufferImageCopy> regions(std::max<size_t>(uploads[i].levelSizes.size(), 1), region);
+            for (uint32_t level = 1; level < regions.size(); level++)
+            {
+                regions[level].bufferOffset              = regions[level - 1].bufferOffset + uploads[i].levelSizes[level - 1];
+                regions[level].imageSubresource.mipLevel = level;
+                regions[level].imageExtent               = {std::max(uploads[i].extent.width >> level, 1u),
+                                                            std::max(uploads[i].extent.height >> level, 1u),
+                                                            std::max(uploads[i].extent.depth >> level, 1u)};
+            }
+
+            pLogicalDevice->vkd.CmdCopyBufferToImage(
+                commandBuffer, stagingBuffer, uploads[i].image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, regions.size(), regions.data());
+
+            memoryBarriers[i].oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            memoryBarriers[i].newLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            memoryBarriers[i].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            memoryBarriers[i].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        }
 
-        memoryBarrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        memoryBarrier.newLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer,
+                                               VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                               VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                                               0,
+                                               0,
+                                               nullptr,
+                                               0,
+                                               nullptr,
+                                               memoryBarriers.size(),
+                                               memoryBarriers.data());
+
+        for (auto& upload : uploads)
+        {
+            if (upload.levelSizes.empty())
+            {
+                generateMipMaps(pLogicalDevice, commandBuffer, upload.image, upload.extent, upload.mipLevels);
+            }
+        }
 
-        pLogicalDevice->vkd.CmdPipelineBarrier(
-            commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarrier);
+        pLogicalDevice->vkd.EndCommandBuffer(commandBuffer);
 
-        generateMipMaps(pLogicalDevice, commandBuffer, image, extent, mipLevels);
+        VkFenceCreateInfo fenceCreateInfo;
+        fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        fenceCreateInfo.pNext = nullptr;
+        fenceCreateInfo.flags = 0;
 
-        pLogicalDevice->vkd.EndCommandBuffer(commandBuffer);
+        VkFence fence;
+        result = pLogicalDevice->vkd.CreateFence(pLogicalDevice->device, &fenceCreateInfo, nullptr, &fence);
+        ASSERT_VULKAN(result);
 
         VkSubmitInfo submitInfo = {};
 
@@ -171,9 +251,13 @@ namespace vkBasalt
         submitInfo.commandBufferCount = 1;
         submitInfo.pCommandBuffers    = &commandBuffer;
 
-        pLogicalDevice->vkd.QueueSubmit(pLogicalDevice->queue, 1, &submitInfo, VK_NULL_HANDLE);
-        pLogicalDevice->vkd.QueueWaitIdle(pLogicalDevice->queue);
+        result = pLogicalDevice->vkd.QueueSubmit(pLogicalDevice->queue, 1, &submitInfo, fence);
+        ASSERT_VULKAN(result);
+        // only wait for our own work instead of draining the whole application queue
+        result = pLogicalDevice->vkd.WaitForFences(pLogicalDevice->device, 1, &fence, VK_TRUE, UINT64_MAX);
+        ASSERT_VULKAN(result);
 
+        pLogicalDevice->vkd.DestroyFence(pLogicalDevice->device, fence, nullptr);
         pLogicalDevice->vkd.FreeCommandBuffers(pLogicalDevice->device, pLogicalDevice->commandPool, 1, &commandBuffer);
         pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, stagingMemory, nullptr);
         pLogicalDevice->vkd.DestroyBuffer(pLogicalDevice->device, stagingBuffer, nullptr);
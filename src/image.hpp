@@ -14,6 +14,18 @@
 
 namespace vkBasalt
 {
+    struct ImageUpload
+    {
+        VkImage               image;
+        VkExtent3D            extent;
+        uint32_t              size;
+        const unsigned char*  pData;
+        uint32_t              mipLevels;
+        // sizes of the mip levels stored one after another in pData
+        // if empty, pData only holds the first level and the others get generated
+        std::vector<uint32_t> levelSizes;
+    };
+
     std::vector<VkImage> createImages(LogicalDevice*        pLogicalDevice,
                                       uint32_t              count,
                                       VkExtent3D            extent,
@@ -26,6 +38,9 @@ namespace vkBasalt
     void uploadToImage(
         LogicalDevice* pLogicalDevice, VkImage image, VkExtent3D extent, uint32_t size, const unsigned char* writeData, uint32_t mipLevels = 1);
 
+    // uploads all images through one staging buffer with a single submit and waits for it with a fence
+    void uploadToImages(LogicalDevice* pLogicalDevice, const std::vector<ImageUpload>& uploads);
+
     void changeImageLayout(LogicalDevice* pLogicalDevice, std::vector<VkImage> images, uint32_t mipLevels = 1);
 
     void generateMipMaps(LogicalDevice* pLogicalDevice, VkCommandBuffer commandBuffer, VkImage image, VkExtent3D extent, uint32_t mipLevels);
@@ -7,7 +7,8 @@ namespace vkBasalt
                                               std::vector<VkImage> images,
                                               VkImageViewType      viewType,
                                               VkImageAspectFlags   aspectMask,
-                                              uint32_t             mipLevels)
+                                              uint32_t             mipLevels,
+                                              uint32_t             baseMipLevel)
     {
         std::vector<VkImageView> imageViews(images.size());
 
@@ -25,7 +26,7 @@ namespace vkBasalt
         imageViewCreateInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
 
         imageViewCreateInfo.subresourceRange.aspectMask     = aspectMask;
-        imageViewCreateInfo.subresourceRange.baseMipLevel   = 0;
+        imageViewCreateInfo.subresourceRange.baseMipLevel   = baseMipLevel;
         imageViewCreateInfo.subresourceRange.levelCount     = mipLevels;
         imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
         imageViewCreateInfo.subresourceRange.layerCount     = 1;
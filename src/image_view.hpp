@@ -16,9 +16,10 @@ namespace vkBasalt
     std::vector<VkImageView> createImageViews(LogicalDevice*       pLogicalDevice,
                                               VkFormat             format,
                                               std::vector<VkImage> images,
-                                              VkImageViewType      viewType   = VK_IMAGE_VIEW_TYPE_2D,
-                                              VkImageAspectFlags   aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-                                              uint32_t             mipLevels  = 1);
+                                              VkImageViewType      viewType     = VK_IMAGE_VIEW_TYPE_2D,
+                                              VkImageAspectFlags   aspectMask   = VK_IMAGE_ASPECT_COLOR_BIT,
+                                              uint32_t             mipLevels    = 1,
+                                              uint32_t             baseMipLevel = 0);
 }
 
 #endif // IMAGE_VIEW_HPP_INCLUDED
@@ -0,0 +1,369 @@
+#include "letterbox.hpp"
+
+#include <algorithm>
+
+#include "image_view.hpp"
+#include "buffer.hpp"
+#include "sampler.hpp"
+#include "object_cache.hpp"
+#include "shader.hpp"
+#include "format.hpp"
+#include "util.hpp"
+
+#include "shader_sources.hpp"
+
+namespace vkBasalt
+{
+    namespace
+    {
+        // has to match shader/letterbox.comp.glsl
+        constexpr uint32_t groupSize = 16;
+
+        // about two seconds at 60 fps, dark scenes should not shrink the content rectangle on their own
+        constexpr uint32_t shrinkDelay = 120;
+
+        // the content rectangle snaps to a grid, so that it does not change with every frame of a fade
+        constexpr uint32_t rectAlignment = 8;
+
+        // the shader only ever lowers the minimum and raises the maximum
+        void resetResult(uint32_t* pResult)
+        {
+            pResult[0] = UINT32_MAX;
+            pResult[1] = UINT32_MAX;
+            pResult[2] = 0;
+            pResult[3] = 0;
+        }
+
+        VkRect2D uniteRects(VkRect2D first, VkRect2D second)
+        {
+            int32_t left   = std::min(first.offset.x, second.offset.x);
+            int32_t top    = std::min(first.offset.y, second.offset.y);
+            int32_t right  = std::max(first.offset.x + (int32_t) first.extent.width, second.offset.x + (int32_t) second.extent.width);
+            int32_t bottom = std::max(first.offset.y + (int32_t) first.extent.height, second.offset.y + (int32_t) second.extent.height);
+            return {{left, top}, {(uint32_t) (right - left), (uint32_t) (bottom - top)}};
+        }
+
+        bool containsRect(VkRect2D outer, VkRect2D inner)
+        {
+            return isSameRect(uniteRects(outer, inner), outer);
+        }
+    } // namespace
+
+    bool isSameRect(VkRect2D first, VkRect2D second)
+    {
+        return first.offset.x == second.offset.x && first.offset.y == second.offset.y && first.extent.width == second.extent.width
+               && first.extent.height == second.extent.height;
+    }
+
+    std::vector<VkRect2D> getBorderRects(VkExtent2D imageExtent, VkRect2D contentRect)
+    {
+        uint32_t left   = contentRect.offset.x;
+        uint32_t top    = contentRect.offset.y;
+        uint32_t right  = contentRect.offset.x + contentRect.extent.width;
+        uint32_t bottom = contentRect.offset.y + contentRect.extent.height;
+
+        // the rows above and below span the whole width, the columns on the sides only the content
+        std::vector<VkRect2D> borderRects;
+        if (top > 0)
+        {
+            borderRects.push_back({{0, 0}, {imageExtent.width, top}});
+        }
+        if (bottom < imageExtent.height)
+        {
+            borderRects.push_back({{0, (int32_t) bottom}, {imageExtent.width, imageExtent.height - bottom}});
+        }
+        if (left > 0)
+        {
+            borderRects.push_back({{0, (int32_t) top}, {left, contentRect.extent.height}});
+        }
+        if (right < imageExtent.width)
+        {
+            borderRects.push_back({{(int32_t) right, (int32_t) top}, {imageExtent.width - right, contentRect.extent.height}});
+        }
+        return borderRects;
+    }
+
+    LetterboxDetector::LetterboxDetector(
+        LogicalDevice* pLogicalDevice, VkFormat format, VkExtent2D imageExtent, std::vector<VkImage> images, Config* pConfig)
+    {
+        Logger::debug("in creating LetterboxDetector");
+
+        this->pLogicalDevice = pLogicalDevice;
+        this->imageExtent    = imageExtent;
+        this->images         = images;
+
+        // limited range video has its black at 16/255, compressed video adds a bit of noise on top
+        threshold = pConfig->getOption<float>("letterboxThreshold", 0.1f);
+
+        contentRect  = {{0, 0}, imageExtent};
+        shrinkRect   = contentRect;
+        shrinkFrames = 0;
+
+        // the threshold is meant for the values the application wrote, not for linear ones
+        imageViews = createImageViews(pLogicalDevice, convertToUNORM(format), images);
+        sampler    = createSampler(pLogicalDevice);
+        createShaderModule(pLogicalDevice, letterbox_comp, &shaderModule);
+
+        VkDescriptorSetLayoutBinding bindings[2];
+        bindings[0].binding            = 0;
+        bindings[0].descriptorType     = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[0].descriptorCount    = 1;
+        bindings[0].stageFlags         = VK_SHADER_STAGE_COMPUTE_BIT;
+        bindings[0].pImmutableSamplers = nullptr;
+
+        bindings[1]                = bindings[0];
+        bindings[1].binding        = 1;
+        bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+
+        VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo;
+        descriptorSetLayoutCreateInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        descriptorSetLayoutCreateInfo.pNext        = nullptr;
+        descriptorSetLayoutCreateInfo.flags        = 0;
+        descriptorSetLayoutCreateInfo.bindingCount = 2;
+        descriptorSetLayoutCreateInfo.pBindings    = bindings;
+
+        descriptorSetLayout = getCachedDescriptorSetLayout(pLogicalDevice, descriptorSetLayoutCreateInfo);
+
+        VkDescriptorPoolSize poolSizes[2];
+        poolSizes[0].type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        poolSizes[0].descriptorCount = images.size();
+        poolSizes[1].type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSizes[1].descriptorCount = images.size();
+
+        VkDescriptorPoolCreateInfo descriptorPoolCreateInfo;
+        descriptorPoolCreateInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        descriptorPoolCreateInfo.pNext         = nullptr;
+        descriptorPoolCreateInfo.flags         = 0;
+        descriptorPoolCreateInfo.maxSets       = images.size();
+        descriptorPoolCreateInfo.poolSizeCount = 2;
+        descriptorPoolCreateInfo.pPoolSizes    = poolSizes;
+
+        VkResult result = pLogicalDevice->vkd.CreateDescriptorPool(pLogicalDevice->device, &descriptorPoolCreateInfo, nullptr, &descriptorPool);
+        ASSERT_VULKAN(result);
+
+        VkPushConstantRange pushConstantRange;
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.offset     = 0;
+        pushConstantRange.size       = sizeof(float);
+
+        VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo;
+        pipelineLayoutCreateInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutCreateInfo.pNext                  = nullptr;
+        pipelineLayoutCreateInfo.flags                  = 0;
+        pipelineLayoutCreateInfo.setLayoutCount         = 1;
+        pipelineLayoutCreateInfo.pSetLayouts            = &descriptorSetLayout;
+        pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+        pipelineLayoutCreateInfo.pPushConstantRanges    = &pushConstantRange;
+
+        pipelineLayout = getCachedPipelineLayout(pLogicalDevice, pipelineLayoutCreateInfo);
+
+        VkComputePipelineCreateInfo pipelineCreateInfo;
+        pipelineCreateInfo.sType                     = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineCreateInfo.pNext                     = nullptr;
+        pipelineCreateInfo.flags                     = 0;
+        pipelineCreateInfo.stage.sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineCreateInfo.stage.pNext               = nullptr;
+        pipelineCreateInfo.stage.flags               = 0;
+        pipelineCreateInfo.stage.stage               = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineCreateInfo.stage.module              = shaderModule;
+        pipelineCreateInfo.stage.pName               = "main";
+        pipelineCreateInfo.stage.pSpecializationInfo = nullptr;
+        pipelineCreateInfo.layout                    = pipelineLayout;
+        pipelineCreateInfo.basePipelineHandle        = VK_NULL_HANDLE;
+        pipelineCreateInfo.basePipelineIndex         = -1;
+
+        result = pLogicalDevice->vkd.CreateComputePipelines(pLogicalDevice->device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &pipeline);
+        ASSERT_VULKAN(result);
+
+        // every image starts out with nothing found, so the first submissions do not change the content rectangle
+        VkDeviceSize resultSize = images.size() * 4 * sizeof(uint32_t);
+        createBuffer(pLogicalDevice,
+                     resultSize,
+                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     resultBuffer,
+                     resultMemory);
+
+        void* data;
+        result = pLogicalDevice->vkd.MapMemory(pLogicalDevice->device, resultMemory, 0, VK_WHOLE_SIZE, 0, &data);
+        ASSERT_VULKAN(result);
+        pResults = static_cast<uint32_t*>(data);
+        for (uint32_t i = 0; i < images.size(); i++)
+        {
+            resetResult(pResults + i * 4);
+        }
+
+        descriptorSets = std::vector<VkDescriptorSet>(images.size());
+        std::vector<VkDescriptorSetLayout> descriptorSetLayouts(images.size(), descriptorSetLayout);
+
+        VkDescriptorSetAllocateInfo descriptorSetAllocateInfo;
+        descriptorSetAllocateInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        descriptorSetAllocateInfo.pNext              = nullptr;
+        descriptorSetAllocateInfo.descriptorPool     = descriptorPool;
+        descriptorSetAllocateInfo.descriptorSetCount = descriptorSets.size();
+        descriptorSetAllocateInfo.pSetLayouts        = descriptorSetLayouts.data();
+
+        result = pLogicalDevice->vkd.AllocateDescriptorSets(pLogicalDevice->device, &descriptorSetAllocateInfo, descriptorSets.data());
+        ASSERT_VULKAN(result);
+
+        for (uint32_t i = 0; i < images.size(); i++)
+        {
+            VkDescriptorImageInfo imageInfo;
+            imageInfo.sampler     = sampler;
+            imageInfo.imageView   = imageViews[i];
+            imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+            VkDescriptorBufferInfo resultBufferInfo;
+            resultBufferInfo.buffer = resultBuffer;
+            resultBufferInfo.offset = i * 4 * sizeof(uint32_t);
+            resultBufferInfo.range  = 4 * sizeof(uint32_t);
+
+            VkWriteDescriptorSet writeDescriptorSets[2];
+            writeDescriptorSets[0].sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writeDescriptorSets[0].pNext            = nullptr;
+            writeDescriptorSets[0].dstSet           = descriptorSets[i];
+            writeDescriptorSets[0].dstBinding       = 0;
+            writeDescriptorSets[0].dstArrayElement  = 0;
+            writeDescriptorSets[0].descriptorCount  = 1;
+            writeDescriptorSets[0].descriptorType   = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            writeDescriptorSets[0].pImageInfo       = &imageInfo;
+            writeDescriptorSets[0].pBufferInfo      = nullptr;
+            writeDescriptorSets[0].pTexelBufferView = nullptr;
+
+            writeDescriptorSets[1]                = writeDescriptorSets[0];
+            writeDescriptorSets[1].dstBinding     = 1;
+            writeDescriptorSets[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writeDescriptorSets[1].pImageInfo     = nullptr;
+            writeDescriptorSets[1].pBufferInfo    = &resultBufferInfo;
+
+            pLogicalDevice->vkd.UpdateDescriptorSets(pLogicalDevice->device, 2, writeDescriptorSets, 0, nullptr);
+        }
+        Logger::debug("created LetterboxDetector");
+    }
+
+    void LetterboxDetector::applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer)
+    {
+        Logger::debug("applying LetterboxDetector to cb " + convertToString(commandBuffer));
+
+        VkImageMemoryBarrier memoryBarrier;
+        memoryBarrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        memoryBarrier.pNext               = nullptr;
+        memoryBarrier.srcAccessMask       = VK_ACCESS_MEMORY_WRITE_BIT;
+        memoryBarrier.dstAccessMask       = VK_ACCESS_SHADER_READ_BIT;
+        memoryBarrier.oldLayout           = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        memoryBarrier.newLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        memoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        memoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        memoryBarrier.image               = images[imageIndex];
+
+        memoryBarrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        memoryBarrier.subresourceRange.baseMipLevel   = 0;
+        memoryBarrier.subresourceRange.levelCount     = 1;
+        memoryBarrier.subresourceRange.baseArrayLayer = 0;
+        memoryBarrier.subresourceRange.layerCount     = 1;
+
+        pLogicalDevice->vkd.CmdPipelineBarrier(
+            commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarrier);
+
+        pLogicalDevice->vkd.CmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+        pLogicalDevice->vkd.CmdBindDescriptorSets(
+            commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSets[imageIndex], 0, nullptr);
+        pLogicalDevice->vkd.CmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(float), &threshold);
+        pLogicalDevice->vkd.CmdDispatch(
+            commandBuffer, (imageExtent.width + groupSize - 1) / groupSize, (imageExtent.height + groupSize - 1) / groupSize, 1);
+
+        // the result gets read on the host the next time the image is submitted
+        VkMemoryBarrier resultBarrier;
+        resultBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        resultBarrier.pNext         = nullptr;
+        resultBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        resultBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+        memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        memoryBarrier.dstAccessMask = 0;
+        memoryBarrier.oldLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        memoryBarrier.newLayout     = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+        pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer,
+                                               VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                               VK_PIPELINE_STAGE_HOST_BIT | VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                                               0,
+                                               1,
+                                               &resultBarrier,
+                                               0,
+                                               nullptr,
+                                               1,
+                                               &memoryBarrier);
+    }
+
+    void LetterboxDetector::updateEffect(uint32_t imageIndex)
+    {
+        // the present waited on the fence of the last submission for this image, so the shader is done with the result
+        uint32_t* pResult = pResults + imageIndex * 4;
+
+        // black frames say nothing about the borders
+        if (pResult[0] < pResult[2] && pResult[1] < pResult[3])
+        {
+            uint32_t left   = pResult[0] / rectAlignment * rectAlignment;
+            uint32_t top    = pResult[1] / rectAlignment * rectAlignment;
+            uint32_t right  = std::min((pResult[2] + rectAlignment - 1) / rectAlignment * rectAlignment, imageExtent.width);
+            uint32_t bottom = std::min((pResult[3] + rectAlignment - 1) / rectAlignment * rectAlignment, imageExtent.height);
+
+            VkRect2D foundRect = {{(int32_t) left, (int32_t) top}, {right - left, bottom - top}};
+
+            if (!containsRect(contentRect, foundRect))
+            {
+                // content outside of the rectangle would get cut off
+                contentRect  = uniteRects(contentRect, foundRect);
+                shrinkRect   = foundRect;
+                shrinkFrames = 0;
+                Logger::debug("letterbox content rectangle grew");
+            }
+            else
+            {
+                shrinkRect = shrinkFrames == 0 ? foundRect : uniteRects(shrinkRect, foundRect);
+                if (++shrinkFrames >= shrinkDelay)
+                {
+                    contentRect  = shrinkRect;
+                    shrinkFrames = 0;
+                }
+            }
+        }
+
+        resetResult(pResult);
+    }
+
+    uint32_t LetterboxDetector::getDamageRadius()
+    {
+        // it writes nothing that gets presented and always looks at the whole image
+        return 0;
+    }
+
+    bool LetterboxDetector::isSkippable()
+    {
+        // a skipped dispatch finds nothing, which does not change the content rectangle
+        return true;
+    }
+
+    VkRect2D LetterboxDetector::getContentRect()
+    {
+        return contentRect;
+    }
+
+    LetterboxDetector::~LetterboxDetector()
+    {
+        Logger::debug("destroying LetterboxDetector " + convertToString(this));
+        pLogicalDevice->vkd.DestroyPipeline(pLogicalDevice->device, pipeline, nullptr);
+        releaseCachedObject<VK_OBJECT_TYPE_PIPELINE_LAYOUT>(pLogicalDevice, pipelineLayout);
+        pLogicalDevice->vkd.DestroyDescriptorPool(pLogicalDevice->device, descriptorPool, nullptr);
+        releaseCachedObject<VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT>(pLogicalDevice, descriptorSetLayout);
+        pLogicalDevice->vkd.DestroyShaderModule(pLogicalDevice->device, shaderModule, nullptr);
+        releaseCachedObject<VK_OBJECT_TYPE_SAMPLER>(pLogicalDevice, sampler);
+        for (auto& imageView : imageViews)
+        {
+            pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, imageView, nullptr);
+        }
+        pLogicalDevice->vkd.DestroyBuffer(pLogicalDevice->device, resultBuffer, nullptr);
+        pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, resultMemory, nullptr);
+    }
+} // namespace vkBasalt
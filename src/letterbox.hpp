@@ -0,0 +1,59 @@
+#ifndef LETTERBOX_HPP_INCLUDED
+#define LETTERBOX_HPP_INCLUDED
+#include <vector>
+
+#include "vulkan_include.hpp"
+
+#include "effect.hpp"
+#include "config.hpp"
+
+#include "logical_device.hpp"
+
+namespace vkBasalt
+{
+    bool isSameRect(VkRect2D first, VkRect2D second);
+
+    // the parts of the image outside of the content rectangle, empty if the rectangle covers the whole image
+    std::vector<VkRect2D> getBorderRects(VkExtent2D imageExtent, VkRect2D contentRect);
+
+    // Finds the black borders of letterboxed and pillarboxed images with a compute shader, see shader/letterbox.comp.glsl.
+    // It runs after the other effects on the images of the application and reads back the result of the last frame of a swapchain image
+    // when that image gets submitted again, once the fence of that frame signaled, which rarely stalls. The content rectangle grows as soon as content shows up outside of it,
+    // but only shrinks after the borders stayed black for a while, so dark scenes do not make the effects jump around.
+    class LetterboxDetector : public Effect
+    {
+    public:
+        LetterboxDetector(
+            LogicalDevice* pLogicalDevice, VkFormat format, VkExtent2D imageExtent, std::vector<VkImage> images, Config* pConfig);
+        void virtual applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer) override;
+        void virtual updateEffect(uint32_t imageIndex) override;
+        uint32_t virtual getDamageRadius() override;
+        bool virtual isSkippable() override;
+        VkRect2D getContentRect();
+        virtual ~LetterboxDetector();
+
+    private:
+        LogicalDevice*               pLogicalDevice;
+        VkExtent2D                   imageExtent;
+        float                        threshold;
+        std::vector<VkImage>         images;
+        std::vector<VkImageView>     imageViews;
+        VkSampler                    sampler;
+        VkShaderModule               shaderModule;
+        VkDescriptorSetLayout        descriptorSetLayout;
+        VkDescriptorPool             descriptorPool;
+        std::vector<VkDescriptorSet> descriptorSets;
+        VkPipelineLayout             pipelineLayout;
+        VkPipeline                   pipeline;
+        // minX, minY, maxX and maxY of the pixels that are not black for every swapchain image, persistently mapped
+        VkBuffer                     resultBuffer;
+        VkDeviceMemory               resultMemory;
+        uint32_t*                    pResults;
+        VkRect2D                     contentRect;
+        // everything found since the content rectangle last changed, it becomes the content rectangle once the wait is over
+        VkRect2D                     shrinkRect;
+        uint32_t                     shrinkFrames;
+    };
+} // namespace vkBasalt
+
+#endif // LETTERBOX_HPP_INCLUDED
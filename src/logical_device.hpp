@@ -5,11 +5,18 @@
 #include <string>
 #include <iostream>
 #include <vector>
+#include <unordered_map>
+#include <memory>
 
 #include "vulkan_include.hpp"
 
 namespace vkBasalt
 {
+    struct CachedTexture;
+    struct ObjectCache;
+    struct DescriptorHeap;
+    struct DepthTracker;
+
     struct LogicalDevice
     {
         VkLayerDispatchTable         vkd;
@@ -21,9 +28,24 @@ namespace vkBasalt
         uint32_t                     queueFamilyIndex;
         VkCommandPool                commandPool;
         bool                         supportsMutableFormat;
-        std::vector<VkImage>         depthImages;
-        std::vector<VkFormat>        depthFormats;
-        std::vector<VkImageView>     depthImageViews;
+        bool                         supportsComputeMipMaps;
+        bool                         supportsPipelineLibrary;
+        bool                         supportsDynamicRendering;
+        bool                         supportsDescriptorIndexing;
+        bool                         supportsConditionalRendering;
+        // whether the application can call vkBindImageMemory2 and vkBindImageMemory2KHR
+        bool                         supportsBindMemory2;
+        bool                         supportsBindMemory2KHR;
+        // shading rate images, only together with dynamic rendering
+        bool                         supportsShadingRate;
+        VkExtent2D                   shadingRateTexelSize;
+        PFN_vkCmdBeginRenderingKHR   CmdBeginRenderingKHR;
+        PFN_vkCmdEndRenderingKHR     CmdEndRenderingKHR;
+
+        std::unordered_map<std::string, std::shared_ptr<CachedTexture>> textureCache;
+        std::shared_ptr<ObjectCache>                                    objectCache;
+        std::shared_ptr<DescriptorHeap>                                 descriptorHeap;
+        std::shared_ptr<DepthTracker>                                   depthTracker;
     };
 } // namespace vkBasalt
 
@@ -1,18 +1,47 @@
 #include "logical_swapchain.hpp"
 
+#include "depth_tracker.hpp"
+
 namespace vkBasalt
 {
     void LogicalSwapchain::destroy()
     {
         if (imageCount > 0)
         {
+            // the submissions of the last presents may still run
+            pLogicalDevice->vkd.WaitForFences(pLogicalDevice->device, fences.size(), fences.data(), VK_TRUE, UINT64_MAX);
+            for (auto& serial : depthSerials)
+            {
+                releaseDepthImage(pLogicalDevice, serial);
+            }
+
             effects.clear();
+            copyEffects.clear();
+            letterboxDetector.reset();
+            frameComparer.reset();
+            shadingRateGenerator.reset();
             defaultTransfer.reset();
 
+            if (predicateBuffer != VK_NULL_HANDLE)
+            {
+                pLogicalDevice->vkd.DestroyBuffer(pLogicalDevice->device, predicateBuffer, nullptr);
+                pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, predicateMemory, nullptr);
+            }
+
             pLogicalDevice->vkd.FreeCommandBuffers(
                 pLogicalDevice->device, pLogicalDevice->commandPool, commandBuffersEffect.size(), commandBuffersEffect.data());
             pLogicalDevice->vkd.FreeCommandBuffers(
                 pLogicalDevice->device, pLogicalDevice->commandPool, commandBuffersNoEffect.size(), commandBuffersNoEffect.data());
+            if (!commandBuffersCompare.empty())
+            {
+                pLogicalDevice->vkd.FreeCommandBuffers(
+                    pLogicalDevice->device, pLogicalDevice->commandPool, commandBuffersCompare.size(), commandBuffersCompare.data());
+            }
+            if (!commandBuffersShadingRate.empty())
+            {
+                pLogicalDevice->vkd.FreeCommandBuffers(
+                    pLogicalDevice->device, pLogicalDevice->commandPool, commandBuffersShadingRate.size(), commandBuffersShadingRate.data());
+            }
             Logger::debug("after free commandbuffer");
 
             pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, fakeImageMemory, nullptr);
@@ -25,6 +54,7 @@ namespace vkBasalt
             for (unsigned int i = 0; i < imageCount; i++)
             {
                 pLogicalDevice->vkd.DestroySemaphore(pLogicalDevice->device, semaphores[i], nullptr);
+                pLogicalDevice->vkd.DestroyFence(pLogicalDevice->device, fences[i], nullptr);
             }
             Logger::debug("after DestroySemaphore");
         }
@@ -8,6 +8,9 @@
 #include <memory>
 
 #include "effect.hpp"
+#include "letterbox.hpp"
+#include "frame_compare.hpp"
+#include "shading_rate.hpp"
 
 #include "vulkan_include.hpp"
 
@@ -18,19 +21,60 @@ namespace vkBasalt
     // for each swapchain, we have the Images and the other stuff we need to execute the compute shader
     struct LogicalSwapchain
     {
-        LogicalDevice*                       pLogicalDevice;
-        VkSwapchainCreateInfoKHR             swapchainCreateInfo;
-        VkExtent2D                           imageExtent;
-        VkFormat                             format;
-        uint32_t                             imageCount;
-        std::vector<VkImage>                 images;
-        std::vector<VkImage>                 fakeImages;
-        std::vector<VkCommandBuffer>         commandBuffersEffect;
-        std::vector<VkCommandBuffer>         commandBuffersNoEffect;
-        std::vector<VkSemaphore>             semaphores;
-        std::vector<std::shared_ptr<Effect>> effects;
-        std::shared_ptr<Effect>              defaultTransfer;
-        VkDeviceMemory                       fakeImageMemory;
+        LogicalDevice*                        pLogicalDevice;
+        VkSwapchainCreateInfoKHR              swapchainCreateInfo;
+        // the size of the images the application and the effects render to
+        VkExtent2D                            imageExtent;
+        // the size of the real swapchain images, larger than imageExtent with a render scale
+        VkExtent2D                            outputExtent;
+        VkFormat                              format;
+        uint32_t                              imageCount;
+        std::vector<VkImage>                  images;
+        std::vector<VkImage>                  fakeImages;
+        std::vector<VkCommandBuffer>          commandBuffersEffect;
+        std::vector<VkCommandBuffer>          commandBuffersNoEffect;
+        std::vector<VkSemaphore>              semaphores;
+        // signaled once the last submission for every image finished, only then its command buffers and buffers can change
+        std::vector<VkFence>                  fences;
+        std::vector<std::shared_ptr<Effect>>  effects;
+        std::shared_ptr<Effect>               defaultTransfer;
+        VkDeviceMemory                        fakeImageMemory;
+        // a copy for each effect with a toggle key that replaces it while it is switched off
+        std::vector<std::shared_ptr<Effect>>  copyEffects;
+        // the switches of the last present, the command buffers got recorded with them if there is no predicate buffer
+        std::vector<bool>                     effectsEnabled;
+        // one uint32_t per swapchain image and effect, persistently mapped
+        VkBuffer                              predicateBuffer;
+        VkDeviceMemory                        predicateMemory;
+        uint32_t*                             pPredicates;
+        // the serial of the depth image that suits the swapchain best, 0 if none, and the depth tracker generation it got chosen at
+        uint64_t                              depthSerial;
+        uint64_t                              depthGeneration;
+        // the serial of the depth image the effects read for every image, it catches up with depthSerial when the image gets presented
+        std::vector<uint64_t>                 depthSerials;
+        // the layout transitions of those depth images, two per image that are null without one, they belong to the depth tracker
+        std::vector<VkCommandBuffer>          commandBuffersDepth;
+        // the effect command buffers of these images have to be recorded again before their next submission
+        std::vector<bool>                     staleCommandBuffers;
+        // the part of the images the effects process, the command buffers got recorded with it
+        VkRect2D                              contentRect;
+        // also one of the effects, only set with letterboxDetection
+        std::shared_ptr<LetterboxDetector>    letterboxDetector;
+        // the sum of the damage radii of the effects, UINT32_MAX if they always process the whole images
+        uint32_t                              damageRadius;
+        // what changed in every image since it was last presented, from the present regions of the application
+        std::vector<VkRect2D>                 damageRects;
+        // the output changed as a whole since the last present, so the present regions of the application do not apply to it
+        bool                                  damageReset;
+        // whether the effects wrote the outputs of every image at least once, only then the effect command buffer of the image
+        // gets recorded to keep them where the damage rectangles leave them alone and, with a frame comparer, to be skipped
+        std::vector<bool>                     processedImages;
+        // only set with skipIdenticalFrames, its command buffers get submitted in front of the effects
+        std::shared_ptr<FrameComparer>        frameComparer;
+        std::vector<VkCommandBuffer>          commandBuffersCompare;
+        // only set if an effect has a shading rate above 1, its command buffers get submitted in front of the effects
+        std::shared_ptr<ShadingRateGenerator> shadingRateGenerator;
+        std::vector<VkCommandBuffer>          commandBuffersShadingRate;
 
         void destroy();
     };
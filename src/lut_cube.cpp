@@ -1,30 +1,98 @@
 #include "lut_cube.hpp"
 
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <sstream>
+#include <string_view>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "logger.hpp"
+#include "util.hpp"
 
 namespace vkBasalt
 {
-    LutCube::LutCube()
+    namespace
+    {
+        // bump this if the layout of the cache files changes
+        constexpr char cacheMagic[8] = {'v', 'k', 'B', 'L', 'U', 'T', '0', '2'};
+    } // namespace
+
+    LutCube::LutCube() : size(0)
     {
     }
-    LutCube::LutCube(const std::string& file)
+    LutCube::LutCube(const std::string& file) : size(0)
     {
-        std::ifstream cubeStream(file);
-        if (!cubeStream.good())
+        std::string cacheKey = getFileCacheKey(file);
+
+        std::stringstream cacheName;
+        cacheName << std::hex << std::hash<std::string>{}(cacheKey);
+        std::string cacheFile = getCacheDirectory("lut") + "/" + cacheName.str() + ".bin";
+
+        if (readCache(cacheFile, cacheKey))
+        {
+            Logger::debug("loaded lut from cache " + cacheFile);
+            return;
+        }
+
+        int fd = open(file.c_str(), O_RDONLY);
+        if (fd < 0)
         {
             Logger::err("lut cube file does not exist");
+            return;
+        }
+
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
+        {
+            Logger::err("lut cube file is empty");
+            close(fd);
+            return;
+        }
+
+        void* text = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (text == MAP_FAILED)
+        {
+            Logger::err("could not map lut cube file");
+            return;
         }
 
-        std::string line;
+        const char* begin = static_cast<const char*>(text);
+        parse(begin, begin + fileStat.st_size);
+        munmap(text, fileStat.st_size);
 
-        while (std::getline(cubeStream, line))
+        if (size != 0)
         {
-            parseLine(line);
+            writeCache(cacheFile, cacheKey);
         }
     }
-    void LutCube::parseLine(std::string line)
+
+    void LutCube::parse(const char* text, const char* end)
+    {
+        while (text < end)
+        {
+            const char* lineEnd = static_cast<const char*>(std::memchr(text, '\n', end - text));
+            if (lineEnd == nullptr)
+            {
+                lineEnd = end;
+            }
+            parseLine(text, lineEnd);
+            text = lineEnd + 1;
+        }
+    }
+
+    void LutCube::parseLine(const char* line, const char* end)
     {
-        if (line.length() == 0)
+        line = skipWhiteSpace(line, end);
+        if (line == end)
         {
             return;
         }
@@ -32,93 +100,213 @@ namespace vkBasalt
         {
             return;
         }
-        if (line.find("LUT_3D_SIZE") != std::string::npos)
+
+        std::string_view lineView(line, end - line);
+        if (lineView.starts_with("LUT_3D_SIZE"))
         {
-            line = line.substr(line.find("LUT_3D_SIZE") + 11);
-            line = skipWhiteSpace(line);
-            size = std::stoi(line);
+            const char* number = skipWhiteSpace(line + 11, end);
+            std::from_chars(number, end, size);
+            if (size < 2 || size > 256)
+            {
+                Logger::err("bad lut size " + std::to_string(size));
+                size = 0;
+                return;
+            }
 
-            colorCube = std::vector<unsigned char>(size * size * size * 4, 255);
+            colorCube    = std::vector<uint32_t>(size * size * size, packLutColor(1.0f, 1.0f, 1.0f));
+            currentPoint = 0;
             return;
         }
-        if (line.find("DOMAIN_MIN") != std::string::npos)
+        // the keywords come before the points, a domain after them would change the mapping halfway through
+        if (lineView.starts_with("DOMAIN_MIN") && currentPoint == 0)
         {
-            line = line.substr(line.find("DOMAIN_MIN") + 10);
-            splitTripel(line, minX, minY, minZ);
+            splitTripel(line + 10, end, minX, minY, minZ);
             return;
         }
-        if (line.find("DOMAIN_MAX") != std::string::npos)
+        if (lineView.starts_with("DOMAIN_MAX") && currentPoint == 0)
         {
-            line = line.substr(line.find("DOMAIN_MAX") + 10);
-            splitTripel(line, maxX, maxY, maxZ);
+            splitTripel(line + 10, end, maxX, maxY, maxZ);
             return;
         }
-        if (line.find_first_of("0123456789") == 0)
+
+        // the points are ordered with red changing fastest, which matches the memory layout of the cube
+        float x, y, z;
+        if (currentPoint < colorCube.size() && splitTripel(line, end, x, y, z))
         {
-            float         x, y, z;
-            unsigned char outX, outY, outZ;
-            splitTripel(line, x, y, z);
-            clampTripel(x, y, z, outX, outY, outZ);
-            writeColor(currentX, currentY, currentZ, outX, outY, outZ);
-            if (currentX != size - 1)
+            // an empty domain would divide by zero in clampTripel
+            if (currentPoint == 0 && !(maxX > minX && maxY > minY && maxZ > minZ))
             {
-                currentX++;
+                Logger::err("bad lut domain, DOMAIN_MAX has to be larger than DOMAIN_MIN");
+                size = 0;
+                colorCube.clear();
+                return;
             }
-            else if (currentY != size - 1)
+            colorCube[currentPoint] = clampTripel(x, y, z);
+            currentPoint++;
+        }
+    }
+
+    const char* LutCube::skipWhiteSpace(const char* text, const char* end)
+    {
+        while (text != end && (*text == ' ' || *text == '\t' || *text == '\r'))
+        {
+            text++;
+        }
+        return text;
+    }
+
+    bool LutCube::splitTripel(const char* line, const char* end, float& x, float& y, float& z)
+    {
+        for (float* value : {&x, &y, &z})
+        {
+            line = skipWhiteSpace(line, end);
+            // from_chars does not accept a leading plus
+            if (line != end && *line == '+')
             {
-                currentY++;
-                currentX = 0;
+                line++;
             }
-            else if (currentZ != size - 1)
+            auto [next, error] = std::from_chars(line, end, *value);
+            if (error != std::errc())
             {
-                currentZ++;
-                currentX = 0;
-                currentY = 0;
+                return false;
             }
-            return;
+            line = next;
         }
+        return true;
     }
 
-    std::string LutCube::skipWhiteSpace(std::string text)
+    uint32_t LutCube::clampTripel(float x, float y, float z)
     {
-        while (text.size() > 0 && (text[0] == ' ' || text[0] == '\t'))
+        return packLutColor((x - minX) / (maxX - minX), (y - minY) / (maxY - minY), (z - minZ) / (maxZ - minZ));
+    }
+
+    bool LutCube::readCache(const std::string& cacheFile, const std::string& cacheKey)
+    {
+        std::ifstream cacheStream(cacheFile, std::ios::binary | std::ios::ate);
+        if (!cacheStream.good())
         {
-            text = text.substr(1);
+            return false;
         }
-        return text;
+
+        std::vector<char> data(cacheStream.tellg());
+        cacheStream.seekg(0);
+        if (!cacheStream.read(data.data(), data.size()))
+        {
+            return false;
+        }
+
+        // magic, key length, key, size, cube
+        size_t   headerSize = sizeof(cacheMagic) + sizeof(uint32_t);
+        uint32_t keySize;
+        if (data.size() < headerSize || std::memcmp(data.data(), cacheMagic, sizeof(cacheMagic)) != 0)
+        {
+            return false;
+        }
+        std::memcpy(&keySize, data.data() + sizeof(cacheMagic), sizeof(keySize));
+
+        // the file name is only a hash, so make sure that the entry really belongs to the file
+        if (data.size() < headerSize + keySize + sizeof(int32_t)
+            || std::string_view(data.data() + headerSize, keySize) != std::string_view(cacheKey))
+        {
+            return false;
+        }
+
+        int32_t cubeSize;
+        std::memcpy(&cubeSize, data.data() + headerSize + keySize, sizeof(cubeSize));
+        size_t cubeOffset = headerSize + keySize + sizeof(cubeSize);
+        if (cubeSize < 2 || cubeSize > 256 || data.size() != cubeOffset + size_t(cubeSize) * cubeSize * cubeSize * sizeof(uint32_t))
+        {
+            return false;
+        }
+
+        size      = cubeSize;
+        colorCube = std::vector<uint32_t>(size_t(cubeSize) * cubeSize * cubeSize);
+        std::memcpy(colorCube.data(), data.data() + cubeOffset, colorCube.size() * sizeof(uint32_t));
+        return true;
     }
 
-    void LutCube::splitTripel(std::string tripel, float& x, float& y, float& z)
+    void LutCube::writeCache(const std::string& cacheFile, const std::string& cacheKey)
     {
-        tripel       = skipWhiteSpace(tripel);
-        size_t after = tripel.find_first_of(" \n");
-        x            = std::stof(tripel.substr(0, after));
-        tripel       = tripel.substr(after);
-
-        tripel = skipWhiteSpace(tripel);
-        after  = tripel.find_first_of(" \n");
-        y      = std::stof(tripel.substr(0, after));
-        tripel = tripel.substr(after);
-
-        tripel = skipWhiteSpace(tripel);
-        z      = std::stof(tripel);
+        // write to a temporary file first so that other processes never see a half written cache file
+        std::string tmpFile = cacheFile + "." + std::to_string(getpid()) + ".tmp";
+        {
+            std::ofstream cacheStream(tmpFile, std::ios::binary | std::ios::trunc);
+
+            uint32_t keySize  = cacheKey.size();
+            int32_t  cubeSize = size;
+            cacheStream.write(cacheMagic, sizeof(cacheMagic));
+            cacheStream.write(reinterpret_cast<const char*>(&keySize), sizeof(keySize));
+            cacheStream.write(cacheKey.data(), keySize);
+            cacheStream.write(reinterpret_cast<const char*>(&cubeSize), sizeof(cubeSize));
+            cacheStream.write(reinterpret_cast<const char*>(colorCube.data()), colorCube.size() * sizeof(uint32_t));
+            if (!cacheStream.good())
+            {
+                Logger::debug("could not write lut cache " + tmpFile);
+                cacheStream.close();
+                std::remove(tmpFile.c_str());
+                return;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(tmpFile, cacheFile, error);
+        if (error)
+        {
+            Logger::debug("could not write lut cache " + cacheFile + ": " + error.message());
+            std::remove(tmpFile.c_str());
+        }
     }
 
-    void LutCube::clampTripel(float x, float y, float z, unsigned char& outX, unsigned char& outY, unsigned char& outZ)
+    uint32_t packLutColor(float r, float g, float b)
     {
-        outX = (unsigned char) 255 * (x / (maxX - minX));
-        outY = (unsigned char) 255 * (y / (maxY - minY));
-        outZ = (unsigned char) 255 * (z / (maxZ - minZ));
+        auto pack = [](float value) { return static_cast<uint32_t>(std::clamp(value, 0.0f, 1.0f) * 1023.0f + 0.5f); };
+        return (3u << 30) | (pack(b) << 20) | (pack(g) << 10) | pack(r);
     }
 
-    void LutCube::writeColor(int x, int y, int z, unsigned char r, unsigned char g, unsigned char b)
+    std::vector<uint32_t> resampleLut(const std::vector<uint32_t>& lut, int size, int newSize)
     {
-        static const int colorSize = 4; // 4 bytes per point in the cube, rgba
+        auto unpack = [&lut](size_t index, int channel) { return float((lut[index] >> (10 * channel)) & 1023) / 1023.0f; };
+
+        std::vector<uint32_t> result(size_t(newSize) * newSize * newSize);
+
+        // the first and last entries stay at the border of the domain, like the lut gets sampled in the shader
+        float scale = float(size - 1) / float(newSize - 1);
+        for (int z = 0; z < newSize; z++)
+        {
+            float sourceZ = z * scale;
+            int   z0      = std::min(int(sourceZ), size - 2);
+            float fz      = sourceZ - z0;
+            for (int y = 0; y < newSize; y++)
+            {
+                float sourceY = y * scale;
+                int   y0      = std::min(int(sourceY), size - 2);
+                float fy      = sourceY - y0;
+                for (int x = 0; x < newSize; x++)
+                {
+                    float sourceX = x * scale;
+                    int   x0      = std::min(int(sourceX), size - 2);
+                    float fx      = sourceX - x0;
 
-        int locationR = (((z * size) + y) * size + x) * colorSize;
+                    size_t base = (size_t(z0) * size + y0) * size + x0;
 
-        colorCube[locationR + 0] = r;
-        colorCube[locationR + 1] = g;
-        colorCube[locationR + 2] = b;
+                    float color[3];
+                    for (int channel = 0; channel < 3; channel++)
+                    {
+                        float c00 = unpack(base, channel) * (1.0f - fx) + unpack(base + 1, channel) * fx;
+                        float c01 = unpack(base + size, channel) * (1.0f - fx) + unpack(base + size + 1, channel) * fx;
+                        float c10 = unpack(base + size * size, channel) * (1.0f - fx) + unpack(base + size * size + 1, channel) * fx;
+                        float c11 =
+                            unpack(base + size * size + size, channel) * (1.0f - fx) + unpack(base + size * size + size + 1, channel) * fx;
+
+                        float c0       = c00 * (1.0f - fy) + c01 * fy;
+                        float c1       = c10 * (1.0f - fy) + c11 * fy;
+                        color[channel] = c0 * (1.0f - fz) + c1 * fz;
+                    }
+
+                    result[(size_t(z) * newSize + y) * newSize + x] = packLutColor(color[0], color[1], color[2]);
+                }
+            }
+        }
+        return result;
     }
 } // namespace vkBasalt
@@ -8,28 +8,30 @@
 #include <vector>
 #include <unordered_map>
 #include <cstdlib>
+#include <cstdint>
 
 namespace vkBasalt
 {
     /*
        reads .cube files
-       returns a vector of bytes
-       one byte is one color value
-       4 bytes stand for rgba
-       the alpha value is always 255
+       returns a vector of colors packed as VK_FORMAT_A2B10G10R10_UNORM_PACK32
+       so every color channel keeps 10 bits of the float values in the file
+       the alpha value is always 3
 
        size will be set according to the size in the file, which can be in [2,256]
        the cube will have the dimentions size * size * size
 
-       so the vector will have a length of size*size*size*4
+       so the vector will have a length of size*size*size
+
+       the baked cube gets stored in the cache directory, so the next time the same file gets loaded it only needs a single read
 
        See: https://wwwimages2.adobe.com/content/dam/acom/en/products/speedgrade/cc/pdfs/cube-lut-specification-1.0.pdf
     */
     class LutCube
     {
     public:
-        std::vector<unsigned char> colorCube;
-        int                        size;
+        std::vector<uint32_t> colorCube;
+        int                   size;
 
         LutCube(const std::string& file);
         LutCube();
@@ -43,22 +45,31 @@ namespace vkBasalt
         float maxY = 1.0f;
         float maxZ = 1.0f;
 
-        int currentX = 0;
-        int currentY = 0;
-        int currentZ = 0;
+        size_t currentPoint = 0;
 
-        void writeColor(int x, int y, int z, unsigned char r, unsigned char g, unsigned char b);
+        // parses the whole text of a .cube file
+        void parse(const char* text, const char* end);
 
-        void parseLine(std::string line);
+        void parseLine(const char* line, const char* end);
 
-        // splits a tripel of floats
-        void splitTripel(std::string tripel, float& x, float& y, float& z);
+        // parses a tripel of floats, returns false if the line does not start with one
+        bool splitTripel(const char* line, const char* end, float& x, float& y, float& z);
 
-        void clampTripel(float x, float y, float z, unsigned char& outX, unsigned char& outY, unsigned char& outZ);
+        // maps the tripel from the domain of the file to [0,1] and packs it
+        uint32_t clampTripel(float x, float y, float z);
 
         // returns the text without leading whitespace
-        std::string skipWhiteSpace(std::string text);
+        const char* skipWhiteSpace(const char* text, const char* end);
+
+        bool readCache(const std::string& cacheFile, const std::string& cacheKey);
+        void writeCache(const std::string& cacheFile, const std::string& cacheKey);
     };
 
+    // packs a color with channels in [0,1] as VK_FORMAT_A2B10G10R10_UNORM_PACK32
+    uint32_t packLutColor(float r, float g, float b);
+
+    // trilinearly resamples a packed lut of size * size * size colors to newSize * newSize * newSize colors
+    std::vector<uint32_t> resampleLut(const std::vector<uint32_t>& lut, int size, int newSize);
+
 } // namespace vkBasalt
 #endif // LUT_CUBE_HPP_INCLUDED
@@ -0,0 +1,305 @@
+#include "mipmap.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+#include "image_view.hpp"
+#include "buffer.hpp"
+#include "sampler.hpp"
+#include "object_cache.hpp"
+#include "shader.hpp"
+#include "format.hpp"
+
+#include "shader_sources.hpp"
+
+namespace vkBasalt
+{
+    namespace
+    {
+        // has to match shader/mipmap.comp.glsl
+        constexpr uint32_t maxMipLevels      = 13;
+        constexpr uint32_t maxExtent         = 4096;
+        constexpr uint32_t tileSize          = 64;
+        constexpr uint32_t scratchBufferSize = 16 + 64 * 64 * 16;
+
+        struct PushConstants
+        {
+            int32_t width;
+            int32_t height;
+            int32_t mipLevels;
+        };
+    } // namespace
+
+    MipMapGenerator::MipMapGenerator(LogicalDevice* pLogicalDevice, uint32_t maxImages)
+    {
+        this->pLogicalDevice = pLogicalDevice;
+
+        sampler = createSampler(pLogicalDevice);
+        createShaderModule(pLogicalDevice, mipmap_comp, &shaderModule);
+
+        VkDescriptorSetLayoutBinding bindings[3];
+        bindings[0].binding            = 0;
+        bindings[0].descriptorType     = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[0].descriptorCount    = 1;
+        bindings[0].stageFlags         = VK_SHADER_STAGE_COMPUTE_BIT;
+        bindings[0].pImmutableSamplers = nullptr;
+
+        bindings[1]                 = bindings[0];
+        bindings[1].binding         = 1;
+        bindings[1].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        bindings[1].descriptorCount = maxMipLevels - 1;
+
+        bindings[2]                = bindings[0];
+        bindings[2].binding        = 2;
+        bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+
+        VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo;
+        descriptorSetLayoutCreateInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        descriptorSetLayoutCreateInfo.pNext        = nullptr;
+        descriptorSetLayoutCreateInfo.flags        = 0;
+        descriptorSetLayoutCreateInfo.bindingCount = 3;
+        descriptorSetLayoutCreateInfo.pBindings    = bindings;
+
+        descriptorSetLayout = getCachedDescriptorSetLayout(pLogicalDevice, descriptorSetLayoutCreateInfo);
+
+        VkDescriptorPoolSize poolSizes[3];
+        poolSizes[0].type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        poolSizes[0].descriptorCount = maxImages;
+        poolSizes[1].type            = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        poolSizes[1].descriptorCount = maxImages * (maxMipLevels - 1);
+        poolSizes[2].type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSizes[2].descriptorCount = maxImages;
+
+        VkDescriptorPoolCreateInfo descriptorPoolCreateInfo;
+        descriptorPoolCreateInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        descriptorPoolCreateInfo.pNext         = nullptr;
+        descriptorPoolCreateInfo.flags         = 0;
+        descriptorPoolCreateInfo.maxSets       = std::max(maxImages, 1u);
+        descriptorPoolCreateInfo.poolSizeCount = 3;
+        descriptorPoolCreateInfo.pPoolSizes    = poolSizes;
+
+        VkResult result = pLogicalDevice->vkd.CreateDescriptorPool(pLogicalDevice->device, &descriptorPoolCreateInfo, nullptr, &descriptorPool);
+        ASSERT_VULKAN(result);
+
+        VkPushConstantRange pushConstantRange;
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.offset     = 0;
+        pushConstantRange.size       = sizeof(PushConstants);
+
+        VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo;
+        pipelineLayoutCreateInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutCreateInfo.pNext                  = nullptr;
+        pipelineLayoutCreateInfo.flags                  = 0;
+        pipelineLayoutCreateInfo.setLayoutCount         = 1;
+        pipelineLayoutCreateInfo.pSetLayouts            = &descriptorSetLayout;
+        pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+        pipelineLayoutCreateInfo.pPushConstantRanges    = &pushConstantRange;
+
+        pipelineLayout = getCachedPipelineLayout(pLogicalDevice, pipelineLayoutCreateInfo);
+
+        VkComputePipelineCreateInfo pipelineCreateInfo;
+        pipelineCreateInfo.sType                     = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineCreateInfo.pNext                     = nullptr;
+        pipelineCreateInfo.flags                     = 0;
+        pipelineCreateInfo.stage.sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineCreateInfo.stage.pNext               = nullptr;
+        pipelineCreateInfo.stage.flags               = 0;
+        pipelineCreateInfo.stage.stage               = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineCreateInfo.stage.module              = shaderModule;
+        pipelineCreateInfo.stage.pName               = "main";
+        pipelineCreateInfo.stage.pSpecializationInfo = nullptr;
+        pipelineCreateInfo.layout                    = pipelineLayout;
+        pipelineCreateInfo.basePipelineHandle        = VK_NULL_HANDLE;
+        pipelineCreateInfo.basePipelineIndex         = -1;
+
+        result = pLogicalDevice->vkd.CreateComputePipelines(pLogicalDevice->device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &pipeline);
+        ASSERT_VULKAN(result);
+    }
+
+    bool MipMapGenerator::supports(VkFormat format, VkExtent3D extent)
+    {
+        return pLogicalDevice->supportsComputeMipMaps && extent.depth == 1 && extent.width <= maxExtent && extent.height <= maxExtent
+               && isFormatSupported(pLogicalDevice, convertToUNORM(format), VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT);
+    }
+
+    void MipMapGenerator::addImage(VkImage image, VkFormat format, VkExtent3D extent, uint32_t mipLevels)
+    {
+        MipMappedImage& mipMappedImage = images[image];
+        mipMappedImage.extent          = extent;
+        mipMappedImage.mipLevels       = mipLevels;
+
+        for (uint32_t level = 0; level < mipLevels; level++)
+        {
+            mipMappedImage.imageViews.push_back(
+                createImageViews(pLogicalDevice, convertToUNORM(format), {image}, VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_ASPECT_COLOR_BIT, 1, level)[0]);
+        }
+
+        // the counter of finished workgroups has to start at 0, the shader resets it after every dispatch
+        createBuffer(pLogicalDevice,
+                     scratchBufferSize,
+                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     mipMappedImage.scratchBuffer,
+                     mipMappedImage.scratchMemory);
+        void*    data;
+        VkResult result = pLogicalDevice->vkd.MapMemory(pLogicalDevice->device, mipMappedImage.scratchMemory, 0, scratchBufferSize, 0, &data);
+        ASSERT_VULKAN(result);
+        std::memset(data, 0, scratchBufferSize);
+        pLogicalDevice->vkd.UnmapMemory(pLogicalDevice->device, mipMappedImage.scratchMemory);
+
+        VkDescriptorSetAllocateInfo descriptorSetAllocateInfo;
+        descriptorSetAllocateInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        descriptorSetAllocateInfo.pNext              = nullptr;
+        descriptorSetAllocateInfo.descriptorPool     = descriptorPool;
+        descriptorSetAllocateInfo.descriptorSetCount = 1;
+        descriptorSetAllocateInfo.pSetLayouts        = &descriptorSetLayout;
+
+        result = pLogicalDevice->vkd.AllocateDescriptorSets(pLogicalDevice->device, &descriptorSetAllocateInfo, &mipMappedImage.descriptorSet);
+        ASSERT_VULKAN(result);
+
+        VkDescriptorImageInfo sourceImageInfo;
+        sourceImageInfo.sampler     = sampler;
+        sourceImageInfo.imageView   = mipMappedImage.imageViews[0];
+        sourceImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        // every binding of the array needs a valid view, the levels the image does not have are never written
+        std::vector<VkDescriptorImageInfo> mipImageInfos(maxMipLevels - 1);
+        for (uint32_t i = 0; i < mipImageInfos.size(); i++)
+        {
+            mipImageInfos[i].sampler     = VK_NULL_HANDLE;
+            mipImageInfos[i].imageView   = mipMappedImage.imageViews[std::min(i + 1, mipLevels - 1)];
+            mipImageInfos[i].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        }
+
+        VkDescriptorBufferInfo scratchBufferInfo;
+        scratchBufferInfo.buffer = mipMappedImage.scratchBuffer;
+        scratchBufferInfo.offset = 0;
+        scratchBufferInfo.range  = VK_WHOLE_SIZE;
+
+        VkWriteDescriptorSet writeDescriptorSets[3];
+        writeDescriptorSets[0].sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writeDescriptorSets[0].pNext            = nullptr;
+        writeDescriptorSets[0].dstSet           = mipMappedImage.descriptorSet;
+        writeDescriptorSets[0].dstBinding       = 0;
+        writeDescriptorSets[0].dstArrayElement  = 0;
+        writeDescriptorSets[0].descriptorCount  = 1;
+        writeDescriptorSets[0].descriptorType   = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writeDescriptorSets[0].pImageInfo       = &sourceImageInfo;
+        writeDescriptorSets[0].pBufferInfo      = nullptr;
+        writeDescriptorSets[0].pTexelBufferView = nullptr;
+
+        writeDescriptorSets[1]                 = writeDescriptorSets[0];
+        writeDescriptorSets[1].dstBinding      = 1;
+        writeDescriptorSets[1].descriptorCount = mipImageInfos.size();
+        writeDescriptorSets[1].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        writeDescriptorSets[1].pImageInfo      = mipImageInfos.data();
+
+        writeDescriptorSets[2]                = writeDescriptorSets[0];
+        writeDescriptorSets[2].dstBinding     = 2;
+        writeDescriptorSets[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writeDescriptorSets[2].pImageInfo     = nullptr;
+        writeDescriptorSets[2].pBufferInfo    = &scratchBufferInfo;
+
+        pLogicalDevice->vkd.UpdateDescriptorSets(pLogicalDevice->device, 3, writeDescriptorSets, 0, nullptr);
+    }
+
+    void MipMapGenerator::generate(VkCommandBuffer commandBuffer, VkImage image)
+    {
+        const MipMappedImage& mipMappedImage = images.at(image);
+
+        // the first level was just rendered, the other levels get overwritten completely,
+        // but the dispatch can be skipped by conditional rendering while the barriers are not, so they must keep the old levels
+        VkImageMemoryBarrier memoryBarriers[2];
+        memoryBarriers[0].sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        memoryBarriers[0].pNext                           = nullptr;
+        memoryBarriers[0].srcAccessMask                   = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        memoryBarriers[0].dstAccessMask                   = VK_ACCESS_SHADER_READ_BIT;
+        memoryBarriers[0].oldLayout                       = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        memoryBarriers[0].newLayout                       = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        memoryBarriers[0].srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+        memoryBarriers[0].dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+        memoryBarriers[0].image                           = image;
+        memoryBarriers[0].subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        memoryBarriers[0].subresourceRange.baseMipLevel   = 0;
+        memoryBarriers[0].subresourceRange.levelCount     = 1;
+        memoryBarriers[0].subresourceRange.baseArrayLayer = 0;
+        memoryBarriers[0].subresourceRange.layerCount     = 1;
+
+        memoryBarriers[1]                               = memoryBarriers[0];
+        memoryBarriers[1].srcAccessMask                 = 0;
+        memoryBarriers[1].dstAccessMask                 = VK_ACCESS_SHADER_WRITE_BIT;
+        memoryBarriers[1].oldLayout                     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        memoryBarriers[1].newLayout                     = VK_IMAGE_LAYOUT_GENERAL;
+        memoryBarriers[1].subresourceRange.baseMipLevel = 1;
+        memoryBarriers[1].subresourceRange.levelCount   = mipMappedImage.mipLevels - 1;
+
+        // the scratch buffer is still in use by the dispatch of the last frame
+        VkMemoryBarrier scratchBarrier;
+        scratchBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        scratchBarrier.pNext         = nullptr;
+        scratchBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        scratchBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+        pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer,
+                                               VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT
+                                                   | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                               VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                               0,
+                                               1,
+                                               &scratchBarrier,
+                                               0,
+                                               nullptr,
+                                               2,
+                                               memoryBarriers);
+
+        PushConstants pushConstants;
+        pushConstants.width     = mipMappedImage.extent.width;
+        pushConstants.height    = mipMappedImage.extent.height;
+        pushConstants.mipLevels = mipMappedImage.mipLevels;
+
+        pLogicalDevice->vkd.CmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+        pLogicalDevice->vkd.CmdBindDescriptorSets(
+            commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &mipMappedImage.descriptorSet, 0, nullptr);
+        pLogicalDevice->vkd.CmdPushConstants(
+            commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &pushConstants);
+        pLogicalDevice->vkd.CmdDispatch(commandBuffer,
+                                        (mipMappedImage.extent.width + tileSize - 1) / tileSize,
+                                        (mipMappedImage.extent.height + tileSize - 1) / tileSize,
+                                        1);
+
+        memoryBarriers[1].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        memoryBarriers[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        memoryBarriers[1].oldLayout     = VK_IMAGE_LAYOUT_GENERAL;
+        memoryBarriers[1].newLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer,
+                                               VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                               VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                               0,
+                                               0,
+                                               nullptr,
+                                               0,
+                                               nullptr,
+                                               1,
+                                               &memoryBarriers[1]);
+    }
+
+    MipMapGenerator::~MipMapGenerator()
+    {
+        for (auto& [image, mipMappedImage] : images)
+        {
+            for (auto& imageView : mipMappedImage.imageViews)
+            {
+                pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, imageView, nullptr);
+            }
+            pLogicalDevice->vkd.DestroyBuffer(pLogicalDevice->device, mipMappedImage.scratchBuffer, nullptr);
+            pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, mipMappedImage.scratchMemory, nullptr);
+        }
+        pLogicalDevice->vkd.DestroyPipeline(pLogicalDevice->device, pipeline, nullptr);
+        releaseCachedObject<VK_OBJECT_TYPE_PIPELINE_LAYOUT>(pLogicalDevice, pipelineLayout);
+        pLogicalDevice->vkd.DestroyDescriptorPool(pLogicalDevice->device, descriptorPool, nullptr);
+        releaseCachedObject<VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT>(pLogicalDevice, descriptorSetLayout);
+        pLogicalDevice->vkd.DestroyShaderModule(pLogicalDevice->device, shaderModule, nullptr);
+        releaseCachedObject<VK_OBJECT_TYPE_SAMPLER>(pLogicalDevice, sampler);
+    }
+} // namespace vkBasalt
@@ -0,0 +1,53 @@
+#ifndef MIPMAP_HPP_INCLUDED
+#define MIPMAP_HPP_INCLUDED
+#include <vector>
+#include <unordered_map>
+
+#include "vulkan_include.hpp"
+
+#include "logical_device.hpp"
+
+namespace vkBasalt
+{
+    // generates the mip chain of an image in a single compute dispatch instead of one blit per level
+    // see shader/mipmap.comp.glsl
+    class MipMapGenerator
+    {
+    public:
+        MipMapGenerator(LogicalDevice* pLogicalDevice, uint32_t maxImages);
+        ~MipMapGenerator();
+
+        // returns true if the mip maps of such an image can be generated by the compute shader
+        // the image then needs to be created with VK_IMAGE_USAGE_STORAGE_BIT
+        bool supports(VkFormat format, VkExtent3D extent);
+
+        void addImage(VkImage image, VkFormat format, VkExtent3D extent, uint32_t mipLevels);
+
+        // regenerates all levels from the first one, all levels of the image need to be in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+        // inside of conditional rendering the levels stay as they were if the dispatch gets skipped
+        void generate(VkCommandBuffer commandBuffer, VkImage image);
+
+    private:
+        struct MipMappedImage
+        {
+            VkExtent3D               extent;
+            uint32_t                 mipLevels;
+            std::vector<VkImageView> imageViews;
+            VkBuffer                 scratchBuffer;
+            VkDeviceMemory           scratchMemory;
+            VkDescriptorSet          descriptorSet;
+        };
+
+        LogicalDevice*        pLogicalDevice;
+        VkSampler             sampler;
+        VkShaderModule        shaderModule;
+        VkDescriptorSetLayout descriptorSetLayout;
+        VkDescriptorPool      descriptorPool;
+        VkPipelineLayout      pipelineLayout;
+        VkPipeline            pipeline;
+
+        std::unordered_map<VkImage, MipMappedImage> images;
+    };
+} // namespace vkBasalt
+
+#endif // MIPMAP_HPP_INCLUDED
@@ -0,0 +1,365 @@
+#include "object_cache.hpp"
+
+#include <cstring>
+#include <map>
+#include <unordered_map>
+
+#include "vulkan/hash_util.h"
+
+#include "util.hpp"
+
+namespace vkBasalt
+{
+    namespace
+    {
+        // the create info flattened to plain values, pointers are replaced by the values they point to
+        struct ObjectKey
+        {
+            VkObjectType          type;
+            std::vector<uint64_t> values;
+
+            bool operator==(const ObjectKey& other) const
+            {
+                return type == other.type && values == other.values;
+            }
+
+            void add(uint64_t value)
+            {
+                values.push_back(value);
+            }
+
+            void addFloat(float value)
+            {
+                uint32_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                values.push_back(bits);
+            }
+        };
+
+        struct ObjectKeyHash
+        {
+            size_t operator()(const ObjectKey& key) const
+            {
+                hash_util::HashCombiner hashCombiner;
+                hashCombiner << key.type;
+                return hashCombiner.Combine(key.values).Value();
+            }
+        };
+
+        struct CachedObject
+        {
+            uint64_t handle;
+            uint32_t refCount;
+        };
+    } // namespace
+
+    struct ObjectCache
+    {
+        std::unordered_map<ObjectKey, CachedObject, ObjectKeyHash> objects;
+        // by type and handle, objects of different types can have the same handle
+        std::map<std::pair<VkObjectType, uint64_t>, ObjectKey>     keys;
+    };
+
+    namespace
+    {
+        ObjectCache& getObjectCache(LogicalDevice* pLogicalDevice)
+        {
+            if (!pLogicalDevice->objectCache)
+            {
+                pLogicalDevice->objectCache = std::make_shared<ObjectCache>();
+            }
+            return *pLogicalDevice->objectCache;
+        }
+
+        // returns the handle of an existing object with a new reference or VK_NULL_HANDLE
+        uint64_t findObject(LogicalDevice* pLogicalDevice, const ObjectKey& key)
+        {
+            ObjectCache& cache = getObjectCache(pLogicalDevice);
+
+            auto found = cache.objects.find(key);
+            if (found == cache.objects.end())
+            {
+                return 0;
+            }
+            found->second.refCount++;
+            return found->second.handle;
+        }
+
+        void insertObject(LogicalDevice* pLogicalDevice, ObjectKey key, uint64_t handle)
+        {
+            ObjectCache& cache = getObjectCache(pLogicalDevice);
+
+            cache.keys[{key.type, handle}] = key;
+            cache.objects[key]             = {handle, 1};
+        }
+
+        void destroyObject(LogicalDevice* pLogicalDevice, VkObjectType type, uint64_t handle)
+        {
+            Logger::debug("destroying cached object " + convertToString(handle));
+            switch (type)
+            {
+                case VK_OBJECT_TYPE_SAMPLER: pLogicalDevice->vkd.DestroySampler(pLogicalDevice->device, (VkSampler) handle, nullptr); break;
+                case VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT:
+                    pLogicalDevice->vkd.DestroyDescriptorSetLayout(pLogicalDevice->device, (VkDescriptorSetLayout) handle, nullptr);
+                    break;
+                case VK_OBJECT_TYPE_PIPELINE_LAYOUT:
+                    pLogicalDevice->vkd.DestroyPipelineLayout(pLogicalDevice->device, (VkPipelineLayout) handle, nullptr);
+                    break;
+                case VK_OBJECT_TYPE_RENDER_PASS:
+                    pLogicalDevice->vkd.DestroyRenderPass(pLogicalDevice->device, (VkRenderPass) handle, nullptr);
+                    break;
+                case VK_OBJECT_TYPE_PIPELINE: pLogicalDevice->vkd.DestroyPipeline(pLogicalDevice->device, (VkPipeline) handle, nullptr); break;
+                default: Logger::err("unexpected cached object type " + std::to_string(type)); break;
+            }
+        }
+    } // namespace
+
+    VkSampler getCachedSampler(LogicalDevice* pLogicalDevice, const VkSamplerCreateInfo& createInfo)
+    {
+        ObjectKey key = {VK_OBJECT_TYPE_SAMPLER, {}};
+        key.add(createInfo.flags);
+        key.add(createInfo.magFilter);
+        key.add(createInfo.minFilter);
+        key.add(createInfo.mipmapMode);
+        key.add(createInfo.addressModeU);
+        key.add(createInfo.addressModeV);
+        key.add(createInfo.addressModeW);
+        key.addFloat(createInfo.mipLodBias);
+        key.add(createInfo.anisotropyEnable);
+        key.add(createInfo.maxAnisotropy);
+        key.add(createInfo.compareEnable);
+        key.add(createInfo.compareOp);
+        key.addFloat(createInfo.minLod);
+        key.addFloat(createInfo.maxLod);
+        key.add(createInfo.borderColor);
+        key.add(createInfo.unnormalizedCoordinates);
+
+        if (uint64_t handle = findObject(pLogicalDevice, key))
+        {
+            return (VkSampler) handle;
+        }
+
+        VkSampler sampler;
+        VkResult  result = pLogicalDevice->vkd.CreateSampler(pLogicalDevice->device, &createInfo, nullptr, &sampler);
+        ASSERT_VULKAN(result);
+
+        insertObject(pLogicalDevice, key, (uint64_t) sampler);
+        return sampler;
+    }
+
+    VkDescriptorSetLayout getCachedDescriptorSetLayout(LogicalDevice* pLogicalDevice, const VkDescriptorSetLayoutCreateInfo& createInfo)
+    {
+        ObjectKey key = {VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, {}};
+        key.add(createInfo.flags);
+        key.add(createInfo.bindingCount);
+        for (uint32_t i = 0; i < createInfo.bindingCount; i++)
+        {
+            const VkDescriptorSetLayoutBinding& binding = createInfo.pBindings[i];
+            key.add(binding.binding);
+            key.add(binding.descriptorType);
+            key.add(binding.descriptorCount);
+            key.add(binding.stageFlags);
+            key.add(binding.pImmutableSamplers != nullptr);
+            if (binding.pImmutableSamplers)
+            {
+                for (uint32_t j = 0; j < binding.descriptorCount; j++)
+                {
+                    key.add((uint64_t) binding.pImmutableSamplers[j]);
+                }
+            }
+        }
+
+        if (uint64_t handle = findObject(pLogicalDevice, key))
+        {
+            return (VkDescriptorSetLayout) handle;
+        }
+
+        VkDescriptorSetLayout descriptorSetLayout;
+        VkResult result = pLogicalDevice->vkd.CreateDescriptorSetLayout(pLogicalDevice->device, &createInfo, nullptr, &descriptorSetLayout);
+        ASSERT_VULKAN(result);
+
+        insertObject(pLogicalDevice, key, (uint64_t) descriptorSetLayout);
+        return descriptorSetLayout;
+    }
+
+    VkPipelineLayout getCachedPipelineLayout(LogicalDevice* pLogicalDevice, const VkPipelineLayoutCreateInfo& createInfo)
+    {
+        // the set layouts come from the cache as well, so equal layouts have equal handles
+        ObjectKey key = {VK_OBJECT_TYPE_PIPELINE_LAYOUT, {}};
+        key.add(createInfo.flags);
+        key.add(createInfo.setLayoutCount);
+        for (uint32_t i = 0; i < createInfo.setLayoutCount; i++)
+        {
+            key.add((uint64_t) createInfo.pSetLayouts[i]);
+        }
+        key.add(createInfo.pushConstantRangeCount);
+        for (uint32_t i = 0; i < createInfo.pushConstantRangeCount; i++)
+        {
+            key.add(createInfo.pPushConstantRanges[i].stageFlags);
+            key.add(createInfo.pPushConstantRanges[i].offset);
+            key.add(createInfo.pPushConstantRanges[i].size);
+        }
+
+        if (uint64_t handle = findObject(pLogicalDevice, key))
+        {
+            return (VkPipelineLayout) handle;
+        }
+
+        VkPipelineLayout pipelineLayout;
+        VkResult         result = pLogicalDevice->vkd.CreatePipelineLayout(pLogicalDevice->device, &createInfo, nullptr, &pipelineLayout);
+        ASSERT_VULKAN(result);
+
+        insertObject(pLogicalDevice, key, (uint64_t) pipelineLayout);
+        return pipelineLayout;
+    }
+
+    VkRenderPass getCachedRenderPass(LogicalDevice* pLogicalDevice, const VkRenderPassCreateInfo& createInfo)
+    {
+        ObjectKey key = {VK_OBJECT_TYPE_RENDER_PASS, {}};
+        key.add(createInfo.flags);
+
+        key.add(createInfo.attachmentCount);
+        for (uint32_t i = 0; i < createInfo.attachmentCount; i++)
+        {
+            const VkAttachmentDescription& attachment = createInfo.pAttachments[i];
+            key.add(attachment.flags);
+            key.add(attachment.format);
+            key.add(attachment.samples);
+            key.add(attachment.loadOp);
+            key.add(attachment.storeOp);
+            key.add(attachment.stencilLoadOp);
+            key.add(attachment.stencilStoreOp);
+            key.add(attachment.initialLayout);
+            key.add(attachment.finalLayout);
+        }
+
+        auto addReferences = [&key](uint32_t count, const VkAttachmentReference* pReferences) {
+            key.add(pReferences != nullptr ? count : 0);
+            for (uint32_t i = 0; pReferences && i < count; i++)
+            {
+                key.add(pReferences[i].attachment);
+                key.add(pReferences[i].layout);
+            }
+        };
+
+        key.add(createInfo.subpassCount);
+        for (uint32_t i = 0; i < createInfo.subpassCount; i++)
+        {
+            const VkSubpassDescription& subpass = createInfo.pSubpasses[i];
+            key.add(subpass.flags);
+            key.add(subpass.pipelineBindPoint);
+            addReferences(subpass.inputAttachmentCount, subpass.pInputAttachments);
+            addReferences(subpass.colorAttachmentCount, subpass.pColorAttachments);
+            addReferences(subpass.colorAttachmentCount, subpass.pResolveAttachments);
+            addReferences(1, subpass.pDepthStencilAttachment);
+            key.add(subpass.preserveAttachmentCount);
+            for (uint32_t j = 0; j < subpass.preserveAttachmentCount; j++)
+            {
+                key.add(subpass.pPreserveAttachments[j]);
+            }
+        }
+
+        key.add(createInfo.dependencyCount);
+        for (uint32_t i = 0; i < createInfo.dependencyCount; i++)
+        {
+            const VkSubpassDependency& dependency = createInfo.pDependencies[i];
+            key.add(dependency.srcSubpass);
+            key.add(dependency.dstSubpass);
+            key.add(dependency.srcStageMask);
+            key.add(dependency.dstStageMask);
+            key.add(dependency.srcAccessMask);
+            key.add(dependency.dstAccessMask);
+            key.add(dependency.dependencyFlags);
+        }
+
+        if (uint64_t handle = findObject(pLogicalDevice, key))
+        {
+            return (VkRenderPass) handle;
+        }
+
+        VkRenderPass renderPass;
+        VkResult     result = pLogicalDevice->vkd.CreateRenderPass(pLogicalDevice->device, &createInfo, nullptr, &renderPass);
+        ASSERT_VULKAN(result);
+
+        insertObject(pLogicalDevice, key, (uint64_t) renderPass);
+        return renderPass;
+    }
+
+    VkPipeline getCachedPipelineLibrary(LogicalDevice* pLogicalDevice, const std::vector<uint64_t>& values, const std::function<VkPipeline()>& create)
+    {
+        ObjectKey key = {VK_OBJECT_TYPE_PIPELINE, values};
+
+        if (uint64_t handle = findObject(pLogicalDevice, key))
+        {
+            return (VkPipeline) handle;
+        }
+
+        VkPipeline library = create();
+        insertObject(pLogicalDevice, key, (uint64_t) library);
+        return library;
+    }
+
+    void releaseCachedObject(LogicalDevice* pLogicalDevice, VkObjectType type, uint64_t handle)
+    {
+        ObjectCache& cache = getObjectCache(pLogicalDevice);
+
+        auto found = cache.keys.find({type, handle});
+        if (found == cache.keys.end())
+        {
+            Logger::err("released object " + convertToString(handle) + " is not cached");
+            return;
+        }
+
+        CachedObject& object = cache.objects.at(found->second);
+        if (object.refCount == 0)
+        {
+            Logger::err("cached object " + convertToString(handle) + " released too often");
+            return;
+        }
+        object.refCount--;
+    }
+
+    void trimObjectCache(LogicalDevice* pLogicalDevice)
+    {
+        ObjectCache& cache = getObjectCache(pLogicalDevice);
+
+        // pipeline libraries first, since their keys contain the other objects, then pipeline layouts and render passes,
+        // since pipeline layouts reference set layouts and set layouts can reference samplers
+        for (VkObjectType type : {VK_OBJECT_TYPE_PIPELINE,
+                                  VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+                                  VK_OBJECT_TYPE_RENDER_PASS,
+                                  VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT,
+                                  VK_OBJECT_TYPE_SAMPLER})
+        {
+            for (auto it = cache.objects.begin(); it != cache.objects.end();)
+            {
+                if (it->first.type == type && it->second.refCount == 0)
+                {
+                    destroyObject(pLogicalDevice, type, it->second.handle);
+                    cache.keys.erase({type, it->second.handle});
+                    it = cache.objects.erase(it);
+                }
+                else
+                {
+                    it++;
+                }
+            }
+        }
+        Logger::debug("cached objects: " + std::to_string(cache.objects.size()));
+    }
+
+    void clearObjectCache(LogicalDevice* pLogicalDevice)
+    {
+        ObjectCache& cache = getObjectCache(pLogicalDevice);
+
+        for (auto& [key, object] : cache.objects)
+        {
+            if (object.refCount)
+            {
+                Logger::err("cached object " + convertToString(object.handle) + " still in use");
+            }
+            object.refCount = 0;
+        }
+        trimObjectCache(pLogicalDevice);
+    }
+} // namespace vkBasalt
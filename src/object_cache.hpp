@@ -0,0 +1,48 @@
+#ifndef OBJECT_CACHE_HPP_INCLUDED
+#define OBJECT_CACHE_HPP_INCLUDED
+#include <vector>
+#include <memory>
+#include <functional>
+
+#include "vulkan_include.hpp"
+
+#include "logical_device.hpp"
+
+namespace vkBasalt
+{
+    // Samplers, descriptor set layouts, pipeline layouts, render passes and pipeline libraries only depend on their create info,
+    // so every device keeps one object per distinct create info and hands out references to it.
+    // Objects without references stay in the cache until trimObjectCache, so that a new swapchain
+    // can pick up the objects of the old one.
+    // pNext chains are not supported, they have to be nullptr.
+    VkSampler getCachedSampler(LogicalDevice* pLogicalDevice, const VkSamplerCreateInfo& createInfo);
+
+    VkDescriptorSetLayout getCachedDescriptorSetLayout(LogicalDevice* pLogicalDevice, const VkDescriptorSetLayoutCreateInfo& createInfo);
+
+    VkPipelineLayout getCachedPipelineLayout(LogicalDevice* pLogicalDevice, const VkPipelineLayoutCreateInfo& createInfo);
+
+    VkRenderPass getCachedRenderPass(LogicalDevice* pLogicalDevice, const VkRenderPassCreateInfo& createInfo);
+
+    // pipeline libraries only depend on a small part of their create info, so the caller provides the key
+    // the handles in the key have to be cached objects that the library users hold a reference to
+    VkPipeline getCachedPipelineLibrary(LogicalDevice* pLogicalDevice, const std::vector<uint64_t>& key, const std::function<VkPipeline()>& create);
+
+    // drops one reference, the object itself gets destroyed by trimObjectCache
+    // non-dispatchable handles are only unique per object type, so the type is part of the lookup
+    void releaseCachedObject(LogicalDevice* pLogicalDevice, VkObjectType type, uint64_t handle);
+
+    // the type has to be given explicitly, all handles are the same integer type in 32 bit builds
+    template<VkObjectType type, typename T>
+    void releaseCachedObject(LogicalDevice* pLogicalDevice, T handle)
+    {
+        releaseCachedObject(pLogicalDevice, type, (uint64_t) handle);
+    }
+
+    // destroys every object that is no longer referenced
+    void trimObjectCache(LogicalDevice* pLogicalDevice);
+
+    // destroys every object, only to be called when the device gets destroyed
+    void clearObjectCache(LogicalDevice* pLogicalDevice);
+} // namespace vkBasalt
+
+#endif // OBJECT_CACHE_HPP_INCLUDED
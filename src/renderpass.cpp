@@ -1,26 +1,50 @@
 #include "renderpass.hpp"
 
+#include "object_cache.hpp"
+
 namespace vkBasalt
 {
-    VkRenderPass createRenderPass(LogicalDevice* pLogicalDevice, VkFormat format)
+    VkRenderPass createRenderPass(LogicalDevice*      pLogicalDevice,
+                                  VkFormat            format,
+                                  VkFormat            stencilFormat,
+                                  VkAttachmentLoadOp  stencilLoadOp,
+                                  VkAttachmentLoadOp  loadOp,
+                                  VkAttachmentStoreOp stencilStoreOp)
     {
-        VkRenderPass renderPass;
-
         VkAttachmentDescription attachmentDescription;
         attachmentDescription.flags          = 0;
         attachmentDescription.format         = format;
         attachmentDescription.samples        = VK_SAMPLE_COUNT_1_BIT;
-        attachmentDescription.loadOp         = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        attachmentDescription.loadOp         = loadOp;
         attachmentDescription.storeOp        = VK_ATTACHMENT_STORE_OP_STORE;
         attachmentDescription.stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
         attachmentDescription.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-        attachmentDescription.initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED;
+        attachmentDescription.initialLayout  = loadOp == VK_ATTACHMENT_LOAD_OP_LOAD ? VK_IMAGE_LAYOUT_PRESENT_SRC_KHR : VK_IMAGE_LAYOUT_UNDEFINED;
         attachmentDescription.finalLayout    = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
+        VkAttachmentDescription stencilAttachmentDescription;
+        stencilAttachmentDescription.flags          = 0;
+        stencilAttachmentDescription.format         = stencilFormat;
+        stencilAttachmentDescription.samples        = VK_SAMPLE_COUNT_1_BIT;
+        stencilAttachmentDescription.loadOp         = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        stencilAttachmentDescription.storeOp        = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        stencilAttachmentDescription.stencilLoadOp  = stencilLoadOp;
+        stencilAttachmentDescription.stencilStoreOp = stencilStoreOp;
+        stencilAttachmentDescription.initialLayout  = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        stencilAttachmentDescription.finalLayout    = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        VkAttachmentDescription attachmentDescriptions[] = {attachmentDescription, stencilAttachmentDescription};
+
         VkAttachmentReference attachmentReference;
         attachmentReference.attachment = 0;
         attachmentReference.layout     = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
+        VkAttachmentReference stencilAttachmentReference;
+        stencilAttachmentReference.attachment = 1;
+        stencilAttachmentReference.layout     = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        bool useStencil = stencilFormat != VK_FORMAT_UNDEFINED;
+
         VkSubpassDescription subpassDescription;
         subpassDescription.flags                   = 0;
         subpassDescription.pipelineBindPoint       = VK_PIPELINE_BIND_POINT_GRAPHICS;
@@ -29,7 +53,7 @@ namespace vkBasalt
         subpassDescription.colorAttachmentCount    = 1;
         subpassDescription.pColorAttachments       = &attachmentReference;
         subpassDescription.pResolveAttachments     = nullptr;
-        subpassDescription.pDepthStencilAttachment = nullptr;
+        subpassDescription.pDepthStencilAttachment = useStencil ? &stencilAttachmentReference : nullptr;
         subpassDescription.preserveAttachmentCount = 0;
         subpassDescription.pPreserveAttachments    = nullptr;
 
@@ -46,16 +70,165 @@ namespace vkBasalt
         renderPassCreateInfo.sType           = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
         renderPassCreateInfo.pNext           = nullptr;
         renderPassCreateInfo.flags           = 0;
-        renderPassCreateInfo.attachmentCount = 1;
-        renderPassCreateInfo.pAttachments    = &attachmentDescription;
+        renderPassCreateInfo.attachmentCount = useStencil ? 2 : 1;
+        renderPassCreateInfo.pAttachments    = attachmentDescriptions;
         renderPassCreateInfo.subpassCount    = 1;
         renderPassCreateInfo.pSubpasses      = &subpassDescription;
         renderPassCreateInfo.dependencyCount = 1;
         renderPassCreateInfo.pDependencies   = &subpassDependency;
 
-        VkResult result = pLogicalDevice->vkd.CreateRenderPass(pLogicalDevice->device, &renderPassCreateInfo, nullptr, &renderPass);
-        ASSERT_VULKAN(result);
+        return getCachedRenderPass(pLogicalDevice, renderPassCreateInfo);
+    }
+
+    VkPipelineRenderingCreateInfoKHR getPipelineRenderingCreateInfo(const std::vector<VkFormat>& formats, VkFormat stencilFormat)
+    {
+        VkPipelineRenderingCreateInfoKHR renderingCreateInfo;
+        renderingCreateInfo.sType                   = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+        renderingCreateInfo.pNext                   = nullptr;
+        renderingCreateInfo.viewMask                = 0;
+        renderingCreateInfo.colorAttachmentCount    = formats.size();
+        renderingCreateInfo.pColorAttachmentFormats = formats.data();
+        renderingCreateInfo.depthAttachmentFormat   = VK_FORMAT_UNDEFINED;
+        renderingCreateInfo.stencilAttachmentFormat = stencilFormat;
+        return renderingCreateInfo;
+    }
+
+    void beginRendering(LogicalDevice*                          pLogicalDevice,
+                        VkCommandBuffer                         commandBuffer,
+                        VkRect2D                                renderArea,
+                        const std::vector<VkImage>&             images,
+                        const std::vector<VkImageView>&         imageViews,
+                        const std::vector<VkAttachmentLoadOp>&  loadOps,
+                        VkImageLayout                           oldLayout,
+                        VkClearValue                            clearValue,
+                        VkImageView                             stencilImageView,
+                        VkAttachmentLoadOp                      stencilLoadOp,
+                        const std::vector<VkAttachmentStoreOp>& storeOps,
+                        VkAttachmentStoreOp                     stencilStoreOp,
+                        VkImageView                             shadingRateImageView)
+    {
+        // the same dependency that the render passes have on earlier reads and writes of the attachments
+        VkImageMemoryBarrier memoryBarrier;
+        memoryBarrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        memoryBarrier.pNext               = nullptr;
+        memoryBarrier.srcAccessMask       = 0;
+        memoryBarrier.dstAccessMask       = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        memoryBarrier.oldLayout           = oldLayout;
+        memoryBarrier.newLayout           = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        memoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        memoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        memoryBarrier.image               = VK_NULL_HANDLE;
+
+        memoryBarrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        memoryBarrier.subresourceRange.baseMipLevel   = 0;
+        memoryBarrier.subresourceRange.levelCount     = 1;
+        memoryBarrier.subresourceRange.baseArrayLayer = 0;
+        memoryBarrier.subresourceRange.layerCount     = 1;
+
+        std::vector<VkImageMemoryBarrier> memoryBarriers(images.size(), memoryBarrier);
+
+        VkRenderingAttachmentInfoKHR attachmentInfo;
+        attachmentInfo.sType              = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+        attachmentInfo.pNext              = nullptr;
+        attachmentInfo.imageView          = VK_NULL_HANDLE;
+        attachmentInfo.imageLayout        = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        attachmentInfo.resolveMode        = VK_RESOLVE_MODE_NONE;
+        attachmentInfo.resolveImageView   = VK_NULL_HANDLE;
+        attachmentInfo.resolveImageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        attachmentInfo.loadOp             = VK_ATTACHMENT_LOAD_OP_LOAD;
+        attachmentInfo.storeOp            = VK_ATTACHMENT_STORE_OP_STORE;
+        attachmentInfo.clearValue         = clearValue;
+
+        std::vector<VkRenderingAttachmentInfoKHR> colorAttachments(images.size(), attachmentInfo);
+        for (size_t i = 0; i < images.size(); i++)
+        {
+            memoryBarriers[i].image     = images[i];
+            colorAttachments[i].imageView = imageViews[i];
+            colorAttachments[i].loadOp    = loadOps[i];
+            if (!storeOps.empty())
+            {
+                colorAttachments[i].storeOp = storeOps[i];
+            }
+        }
+
+        pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer,
+                                               VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                               VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                               0,
+                                               0,
+                                               nullptr,
+                                               0,
+                                               nullptr,
+                                               memoryBarriers.size(),
+                                               memoryBarriers.data());
+
+        VkRenderingAttachmentInfoKHR stencilAttachment = attachmentInfo;
+        stencilAttachment.imageView                    = stencilImageView;
+        stencilAttachment.imageLayout                  = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        stencilAttachment.loadOp                       = stencilLoadOp;
+        stencilAttachment.storeOp                      = stencilStoreOp;
+        stencilAttachment.clearValue.depthStencil      = {0.0f, 0};
+
+        VkRenderingFragmentShadingRateAttachmentInfoKHR shadingRateAttachment;
+        shadingRateAttachment.sType                          = VK_STRUCTURE_TYPE_RENDERING_FRAGMENT_SHADING_RATE_ATTACHMENT_INFO_KHR;
+        shadingRateAttachment.pNext                          = nullptr;
+        shadingRateAttachment.imageView                      = shadingRateImageView;
+        shadingRateAttachment.imageLayout                    = VK_IMAGE_LAYOUT_FRAGMENT_SHADING_RATE_ATTACHMENT_OPTIMAL_KHR;
+        shadingRateAttachment.shadingRateAttachmentTexelSize = pLogicalDevice->shadingRateTexelSize;
+
+        VkRenderingInfoKHR renderingInfo;
+        renderingInfo.sType                = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+        renderingInfo.pNext                = shadingRateImageView != VK_NULL_HANDLE ? &shadingRateAttachment : nullptr;
+        renderingInfo.flags                = 0;
+        renderingInfo.renderArea           = renderArea;
+        renderingInfo.layerCount           = 1;
+        renderingInfo.viewMask             = 0;
+        renderingInfo.colorAttachmentCount = colorAttachments.size();
+        renderingInfo.pColorAttachments    = colorAttachments.data();
+        renderingInfo.pDepthAttachment     = nullptr;
+        renderingInfo.pStencilAttachment   = stencilImageView != VK_NULL_HANDLE ? &stencilAttachment : nullptr;
+
+        pLogicalDevice->CmdBeginRenderingKHR(commandBuffer, &renderingInfo);
+    }
+
+    void endRendering(LogicalDevice* pLogicalDevice, VkCommandBuffer commandBuffer, const std::vector<VkImage>& images, VkImageLayout newLayout)
+    {
+        pLogicalDevice->CmdEndRenderingKHR(commandBuffer);
+
+        VkImageMemoryBarrier memoryBarrier;
+        memoryBarrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        memoryBarrier.pNext               = nullptr;
+        memoryBarrier.srcAccessMask       = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        memoryBarrier.dstAccessMask       = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+        memoryBarrier.oldLayout           = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        memoryBarrier.newLayout           = newLayout;
+        memoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        memoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        memoryBarrier.image               = VK_NULL_HANDLE;
+
+        memoryBarrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        memoryBarrier.subresourceRange.baseMipLevel   = 0;
+        memoryBarrier.subresourceRange.levelCount     = 1;
+        memoryBarrier.subresourceRange.baseArrayLayer = 0;
+        memoryBarrier.subresourceRange.layerCount     = 1;
+
+        std::vector<VkImageMemoryBarrier> memoryBarriers(images.size(), memoryBarrier);
+        for (size_t i = 0; i < images.size(); i++)
+        {
+            memoryBarriers[i].image = images[i];
+        }
 
-        return renderPass;
+        // mip maps get generated with transfers or a compute shader
+        pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer,
+                                               VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                               VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
+                                                   | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                               0,
+                                               0,
+                                               nullptr,
+                                               0,
+                                               nullptr,
+                                               memoryBarriers.size(),
+                                               memoryBarriers.data());
     }
 } // namespace vkBasalt
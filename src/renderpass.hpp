@@ -13,7 +13,40 @@
 
 namespace vkBasalt
 {
-    VkRenderPass createRenderPass(LogicalDevice* pLogicalDevice, VkFormat format);
-}
+    // the render pass is shared through the object cache of the device, release it with releaseCachedObject
+    // with a stencilFormat the pass gets a stencil attachment that stays in depth stencil attachment optimal
+    // with the load op load the color attachment keeps its content and has to be in the present src layout at the start of the pass
+    VkRenderPass createRenderPass(LogicalDevice*      pLogicalDevice,
+                                  VkFormat            format,
+                                  VkFormat            stencilFormat  = VK_FORMAT_UNDEFINED,
+                                  VkAttachmentLoadOp  stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_LOAD,
+                                  VkAttachmentLoadOp  loadOp         = VK_ATTACHMENT_LOAD_OP_CLEAR,
+                                  VkAttachmentStoreOp stencilStoreOp = VK_ATTACHMENT_STORE_OP_STORE);
+
+    // the pipeline state for rendering into the formats without a render pass, the struct points into formats
+    VkPipelineRenderingCreateInfoKHR getPipelineRenderingCreateInfo(const std::vector<VkFormat>& formats,
+                                                                    VkFormat                     stencilFormat = VK_FORMAT_UNDEFINED);
+
+    // transitions the images from oldLayout to color attachment optimal and begins dynamic rendering into the views,
+    // the stencil attachment is expected in depth stencil attachment optimal already
+    // without storeOps every attachment gets stored
+    // the shading rate image is expected in fragment shading rate attachment optimal, see shading_rate.hpp
+    void beginRendering(LogicalDevice*                          pLogicalDevice,
+                        VkCommandBuffer                         commandBuffer,
+                        VkRect2D                                renderArea,
+                        const std::vector<VkImage>&             images,
+                        const std::vector<VkImageView>&         imageViews,
+                        const std::vector<VkAttachmentLoadOp>&  loadOps,
+                        VkImageLayout                           oldLayout,
+                        VkClearValue                            clearValue,
+                        VkImageView                             stencilImageView     = VK_NULL_HANDLE,
+                        VkAttachmentLoadOp                      stencilLoadOp        = VK_ATTACHMENT_LOAD_OP_LOAD,
+                        const std::vector<VkAttachmentStoreOp>& storeOps             = {},
+                        VkAttachmentStoreOp                     stencilStoreOp       = VK_ATTACHMENT_STORE_OP_STORE,
+                        VkImageView                             shadingRateImageView = VK_NULL_HANDLE);
+
+    // ends dynamic rendering and transitions the images to newLayout, so that following commands can read them
+    void endRendering(LogicalDevice* pLogicalDevice, VkCommandBuffer commandBuffer, const std::vector<VkImage>& images, VkImageLayout newLayout);
+} // namespace vkBasalt
 
 #endif // RENDERPASS_HPP_INCLUDED
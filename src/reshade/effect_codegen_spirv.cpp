@@ -114,8 +114,8 @@ struct spirv_basic_block
 class codegen_spirv final : public codegen
 {
 public:
-	codegen_spirv(bool vulkan_semantics, bool debug_info, bool uniforms_to_spec_constants, bool invert_y)
-		: _invert_y(invert_y), _debug_info(debug_info), _vulkan_semantics(vulkan_semantics), _uniforms_to_spec_constants(uniforms_to_spec_constants)
+	codegen_spirv(bool vulkan_semantics, bool debug_info, bool uniforms_to_spec_constants, bool invert_y, uint32_t bindless_samplers)
+		: _invert_y(invert_y), _debug_info(debug_info), _vulkan_semantics(vulkan_semantics), _uniforms_to_spec_constants(uniforms_to_spec_constants), _bindless_samplers(bindless_samplers)
 	{
 		_glsl_ext = make_id();
 	}
@@ -181,6 +181,11 @@ private:
 	id _global_ubo_type = 0;
 	id _global_ubo_variable = 0;
 	std::vector<spv::Id> _global_ubo_types;
+	uint32_t _bindless_samplers = 0;
+	id _sampler_array_variable = 0;
+	id _sampler_slots_type = 0;
+	id _sampler_slots_variable = 0;
+	std::unordered_map<spv::Id, uint32_t> _sampler_bindings;
 	function_blocks *_current_function = nullptr;
 
 	inline void add_location(const location &loc, spirv_basic_block &block)
@@ -236,6 +241,21 @@ private:
 			define_variable(_global_ubo_variable, {}, { type::t_struct, 0, 0, type::q_uniform, 0, _global_ubo_type }, "$Globals", spv::StorageClassUniform);
 		}
 
+		// Same for the push constant block with the slot of every sampler, now that the number of samplers is known
+		if (_sampler_slots_type != 0)
+		{
+			const spv::Id slots_type = convert_type({ type::t_uint, 1, 1, 0, static_cast<int>(_module.num_sampler_bindings) }, false, spv::StorageClassPushConstant, 4u);
+
+			add_instruction(spv::OpTypeStruct, 0, _types_and_constants)
+				.add(slots_type)
+				.result = _sampler_slots_type;
+
+			add_member_name(_sampler_slots_type, 0, "slots");
+			add_member_decoration(_sampler_slots_type, 0, spv::DecorationOffset, { 0 });
+
+			define_variable(_sampler_slots_variable, {}, { type::t_struct, 0, 0, type::q_uniform, 0, _sampler_slots_type }, "$SamplerSlots", spv::StorageClassPushConstant);
+		}
+
 		module = std::move(_module);
 
 		// Write SPIRV header info
@@ -443,6 +463,14 @@ private:
 
 		return type;
 	}
+	spv::Id convert_param_type(const type &info)
+	{
+		// Samplers are passed by their slot in the sampler array in bindless mode, since pointers into that array cannot be passed to functions
+		if (_bindless_samplers != 0 && info.is_sampler())
+			return convert_type({ type::t_uint, 1, 1 }, true, spv::StorageClassFunction);
+
+		return convert_type(info, true);
+	}
 	spv::Id convert_type(const function_blocks &info)
 	{
 		if (auto it = std::find_if(_function_type_lookup.begin(), _function_type_lookup.end(),
@@ -455,7 +483,7 @@ private:
 		std::vector<spv::Id> param_type_ids;
 		param_type_ids.reserve(info.param_types.size());
 		for (const type &param_type : info.param_types)
-			param_type_ids.push_back(convert_type(param_type, true));
+			param_type_ids.push_back(convert_param_type(param_type));
 
 		spirv_instruction &inst = add_instruction(spv::OpTypeFunction, 0, _types_and_constants);
 		inst.add(return_type);
@@ -563,6 +591,32 @@ private:
 		info.id = make_id();
 		info.binding = _module.num_sampler_bindings++;
 
+		// In bindless mode all samplers share one array of combined image samplers and the binding selects a slot index in the push constants
+		if (_bindless_samplers != 0)
+		{
+			if (_sampler_array_variable == 0)
+			{
+				_sampler_array_variable = make_id();
+				define_variable(_sampler_array_variable, loc, { type::t_sampler, 0, 0, type::q_extern | type::q_uniform, static_cast<int>(_bindless_samplers) },
+					"$Samplers", spv::StorageClassUniformConstant);
+
+				add_decoration(_sampler_array_variable, spv::DecorationDescriptorSet, { 1 });
+				add_decoration(_sampler_array_variable, spv::DecorationBinding, { 0 });
+
+				_sampler_slots_type = make_id();
+				add_decoration(_sampler_slots_type, spv::DecorationBlock);
+				_sampler_slots_variable = make_id();
+
+				add_capability(spv::CapabilitySampledImageArrayDynamicIndexing);
+			}
+
+			_sampler_bindings[info.id] = info.binding;
+
+			_module.samplers.push_back(info);
+
+			return info.id;
+		}
+
 		define_variable(info.id, loc, { type::t_sampler, 0, 0, type::q_extern | type::q_uniform },
 			info.unique_name.c_str(), spv::StorageClassUniformConstant);
 
@@ -781,7 +835,7 @@ private:
 		{
 			add_location(param.location, function.declaration);
 
-			param.definition = add_instruction(spv::OpFunctionParameter, convert_type(param.type, true), function.declaration).result;
+			param.definition = add_instruction(spv::OpFunctionParameter, convert_param_type(param.type), function.declaration).result;
 
 			add_name(param.definition, param.name.c_str());
 		}
@@ -1017,6 +1071,25 @@ private:
 				.add(spv::ExecutionModeOriginUpperLeft);
 	}
 
+	spv::Id load_sampler_slot(spv::Id sampler)
+	{
+		spv::Id pointer = sampler;
+
+		// Global samplers read their slot from the push constants, sampler parameters already point to a slot
+		if (const auto it = _sampler_bindings.find(sampler); it != _sampler_bindings.end())
+		{
+			pointer = add_instruction(spv::OpAccessChain, convert_type({ type::t_uint, 1, 1 }, true, spv::StorageClassPushConstant))
+				.add(_sampler_slots_variable)
+				.add(emit_constant(0u))
+				.add(emit_constant(it->second))
+				.result;
+		}
+
+		return add_instruction(spv::OpLoad, convert_type({ type::t_uint, 1, 1 }))
+			.add(pointer)
+			.result;
+	}
+
 	id   emit_load(const expression &exp, bool) override
 	{
 		if (exp.is_constant) // Constant expressions do not have a complex access chain
@@ -1031,6 +1104,22 @@ private:
 		if (exp.is_lvalue || !exp.chain.empty())
 			add_location(exp.location, *_current_block_data);
 
+		// Samplers are looked up in the sampler array by their slot in bindless mode
+		if (_bindless_samplers != 0 && exp.is_lvalue && exp.type.is_sampler())
+		{
+			assert(exp.chain.empty());
+
+			const spv::Id slot = load_sampler_slot(exp.base);
+			const spv::Id pointer = add_instruction(spv::OpAccessChain, convert_type(exp.type, true, spv::StorageClassUniformConstant))
+				.add(_sampler_array_variable)
+				.add(slot)
+				.result;
+
+			return add_instruction(spv::OpLoad, convert_type(exp.type))
+				.add(pointer)
+				.result;
+		}
+
 		// If a variable is referenced, load the value first
 		if (exp.is_lvalue && _spec_constants.find(exp.base) == _spec_constants.end())
 		{
@@ -1654,11 +1743,33 @@ private:
 
 		add_location(loc, *_current_block_data);
 
+		std::vector<spv::Id> arg_ids;
+		arg_ids.reserve(args.size());
+		for (const auto &arg : args)
+		{
+			// Sampler parameters are pointers to a slot index in bindless mode, so copy the slot into a temporary variable
+			if (_bindless_samplers != 0 && arg.type.is_sampler())
+			{
+				const spv::Id slot = load_sampler_slot(arg.base);
+				const spv::Id variable = make_id();
+				define_variable(variable, {}, { type::t_uint, 1, 1 }, nullptr, spv::StorageClassFunction);
+
+				add_instruction_without_result(spv::OpStore)
+					.add(variable)
+					.add(slot);
+
+				arg_ids.push_back(variable);
+			}
+			else
+			{
+				arg_ids.push_back(arg.base);
+			}
+		}
+
 		// https://www.khronos.org/registry/spir-v/specs/unified1/SPIRV.html#OpFunctionCall
 		spirv_instruction &inst = add_instruction(spv::OpFunctionCall, convert_type(res_type));
 		inst.add(function); // Function
-		for (const auto &arg : args)
-			inst.add(arg.base); // Arguments
+		inst.add(arg_ids.begin(), arg_ids.end()); // Arguments
 
 		return inst.result;
 	}
@@ -1960,7 +2071,7 @@ private:
 	}
 };
 
-codegen *reshadefx::create_codegen_spirv(bool vulkan_semantics, bool debug_info, bool uniforms_to_spec_constants, bool invert_y)
+codegen *reshadefx::create_codegen_spirv(bool vulkan_semantics, bool debug_info, bool uniforms_to_spec_constants, bool invert_y, uint32_t bindless_samplers)
 {
-	return new codegen_spirv(vulkan_semantics, debug_info, uniforms_to_spec_constants, invert_y);
+	return new codegen_spirv(vulkan_semantics, debug_info, uniforms_to_spec_constants, invert_y, bindless_samplers);
 }
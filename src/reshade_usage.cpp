@@ -0,0 +1,274 @@
+#include "reshade_usage.hpp"
+
+#include <algorithm>
+
+#include <spirv.hpp>
+
+#include "logger.hpp"
+
+namespace vkBasalt
+{
+    namespace
+    {
+        // what an entry point can reach through its calls
+        struct EntryPointUsage
+        {
+            std::set<uint32_t> bindings;
+            bool               discards = false;
+        };
+
+        std::unordered_map<std::string, EntryPointUsage> getEntryPointUsage(const std::vector<uint32_t>& spirv)
+        {
+            std::unordered_map<uint32_t, uint32_t>           bindings;
+            std::unordered_map<uint32_t, uint32_t>           descriptorSets;
+            std::unordered_map<uint32_t, std::set<uint32_t>> usedIds;
+            std::unordered_map<uint32_t, std::set<uint32_t>> callees;
+            std::unordered_map<uint32_t, uint32_t>           constants;
+            std::set<uint32_t>                               pushConstants;
+            std::unordered_map<uint32_t, std::set<uint32_t>> slotReads;
+            std::set<uint32_t>                               discardingFunctions;
+            std::vector<std::pair<std::string, uint32_t>>    entryPoints;
+
+            uint32_t function = 0;
+            // the first five words are the header
+            for (size_t i = 5; i < spirv.size();)
+            {
+                const uint32_t* words     = spirv.data() + i;
+                uint32_t        wordCount = words[0] >> 16;
+                if (wordCount == 0 || i + wordCount > spirv.size())
+                {
+                    Logger::err("bad spir-v instruction at word " + std::to_string(i));
+                    break;
+                }
+                switch (words[0] & 0xFFFF)
+                {
+                    case spv::OpEntryPoint: entryPoints.emplace_back(reinterpret_cast<const char*>(words + 3), words[2]); break;
+                    case spv::OpDecorate:
+                        if (words[2] == spv::DecorationBinding)
+                        {
+                            bindings[words[1]] = words[3];
+                        }
+                        else if (words[2] == spv::DecorationDescriptorSet)
+                        {
+                            descriptorSets[words[1]] = words[3];
+                        }
+                        break;
+                    case spv::OpConstant:
+                        if (wordCount == 4)
+                        {
+                            constants[words[2]] = words[3];
+                        }
+                        break;
+                    case spv::OpVariable:
+                        if (words[3] == spv::StorageClassPushConstant)
+                        {
+                            pushConstants.insert(words[2]);
+                        }
+                        break;
+                    case spv::OpFunction: function = words[2]; break;
+                    case spv::OpFunctionEnd: function = 0; break;
+                    case spv::OpFunctionCall:
+                        callees[function].insert(words[3]);
+                        usedIds[function].insert(words + 4, words + wordCount);
+                        break;
+                    case spv::OpAccessChain:
+                        // with a descriptor heap the samplers are slots in the push constants, the last index is the binding
+                        if (pushConstants.count(words[3]) && wordCount > 4 && constants.count(words[wordCount - 1]))
+                        {
+                            slotReads[function].insert(constants[words[wordCount - 1]]);
+                        }
+                        usedIds[function].insert(words[3]);
+                        break;
+                    case spv::OpLoad:
+                    case spv::OpInBoundsAccessChain:
+                    case spv::OpCopyObject: usedIds[function].insert(words[3]); break;
+                    case spv::OpStore: usedIds[function].insert(words[2]); break;
+                    case spv::OpKill: discardingFunctions.insert(function); break;
+                    default: break;
+                }
+                i += wordCount;
+            }
+
+            std::unordered_map<std::string, EntryPointUsage> result;
+            for (auto& [name, entryFunction] : entryPoints)
+            {
+                std::set<uint32_t>    visited   = {entryFunction};
+                std::vector<uint32_t> functions = {entryFunction};
+                while (!functions.empty())
+                {
+                    uint32_t current = functions.back();
+                    functions.pop_back();
+                    result[name].discards |= discardingFunctions.count(current) != 0;
+                    result[name].bindings.insert(slotReads[current].begin(), slotReads[current].end());
+                    for (uint32_t id : usedIds[current])
+                    {
+                        // the samplers are in the second descriptor set
+                        if (descriptorSets.count(id) && descriptorSets[id] == 1 && bindings.count(id))
+                        {
+                            result[name].bindings.insert(bindings[id]);
+                        }
+                    }
+                    for (uint32_t callee : callees[current])
+                    {
+                        if (visited.insert(callee).second)
+                        {
+                            functions.push_back(callee);
+                        }
+                    }
+                }
+            }
+            return result;
+        }
+
+        // true if the pass can leave pixels of its render targets as they were or blends with them
+        // only a single triangle without discards is trusted to cover the whole viewport
+        bool keepsPreviousContent(const reshadefx::pass_info& pass, bool discards)
+        {
+            return pass.blend_enable || pass.color_write_mask != 0xF || pass.stencil_enable || discards || pass.num_vertices != 3
+                   || pass.topology != reshadefx::primitive_topology::triangle_list;
+        }
+
+        bool writesStencil(const reshadefx::pass_info& pass)
+        {
+            return pass.stencil_enable && pass.stencil_write_mask
+                   && (pass.stencil_op_pass != reshadefx::pass_stencil_op::keep || pass.stencil_op_fail != reshadefx::pass_stencil_op::keep
+                       || pass.stencil_op_depth_fail != reshadefx::pass_stencil_op::keep);
+        }
+    } // namespace
+
+    bool ReshadeUsage::isUsed(const std::string& texture) const
+    {
+        return sampledSRGB.count(texture) || sampledUNORM.count(texture) || renderedSRGB.count(texture) || renderedUNORM.count(texture);
+    }
+
+    ReshadeUsage analyzeReshadeModule(const reshadefx::module& module)
+    {
+        ReshadeUsage usage;
+
+        const std::vector<reshadefx::pass_info>& passes      = module.techniques[0].passes;
+        auto                                     entryPoints = getEntryPointUsage(module.spirv);
+
+        std::vector<std::vector<const reshadefx::sampler_info*>> passSamplers(passes.size());
+        std::vector<std::set<std::string>>                       passReads(passes.size());
+        for (size_t i = 0; i < passes.size(); i++)
+        {
+            for (auto& sampler : module.samplers)
+            {
+                if (entryPoints[passes[i].vs_entry_point].bindings.count(sampler.binding)
+                    || entryPoints[passes[i].ps_entry_point].bindings.count(sampler.binding))
+                {
+                    passSamplers[i].push_back(&sampler);
+                    passReads[i].insert(sampler.texture_name);
+                }
+            }
+        }
+
+        // render targets keep their content between frames, so a pass can also feed a pass before it
+        // that is why this runs until nothing changes instead of once from the last pass to the first
+        usage.livePasses = std::vector<bool>(passes.size(), false);
+        std::set<std::string> readTextures;
+        bool                  readsStencil = false;
+        for (bool changed = true; changed;)
+        {
+            changed = false;
+            for (size_t i = 0; i < passes.size(); i++)
+            {
+                if (usage.livePasses[i])
+                {
+                    continue;
+                }
+                bool live = passes[i].render_target_names[0] == "" || (readsStencil && writesStencil(passes[i]));
+                for (auto& target : passes[i].render_target_names)
+                {
+                    live |= readTextures.count(target) != 0;
+                }
+                if (!live)
+                {
+                    continue;
+                }
+
+                usage.livePasses[i] = true;
+                changed             = true;
+                readTextures.insert(passReads[i].begin(), passReads[i].end());
+                readsStencil |= passes[i].stencil_enable != 0;
+            }
+        }
+
+        std::set<std::string> mipMappedTextures;
+        for (size_t i = 0; i < passes.size(); i++)
+        {
+            if (!usage.livePasses[i])
+            {
+                Logger::debug("skipping pass " + std::to_string(i) + ", nothing reads its output");
+                continue;
+            }
+            for (auto sampler : passSamplers[i])
+            {
+                (sampler->srgb ? usage.sampledSRGB : usage.sampledUNORM).insert(sampler->texture_name);
+                if (sampler->max_lod > 0.0f)
+                {
+                    mipMappedTextures.insert(sampler->texture_name);
+                }
+            }
+            for (auto& target : passes[i].render_target_names)
+            {
+                if (target != "")
+                {
+                    (passes[i].srgb_write_enable ? usage.renderedSRGB : usage.renderedUNORM).insert(target);
+                }
+            }
+            usage.usesStencil |= passes[i].stencil_enable != 0;
+        }
+
+        // a pass only has to store a target if a live pass reads it before it gets overwritten completely,
+        // render targets keep their content between frames, so the search wraps around to the first pass
+        usage.loadTargets  = std::vector<std::array<bool, 8>>(passes.size(), std::array<bool, 8>{});
+        usage.storeTargets = std::vector<std::array<bool, 8>>(passes.size(), std::array<bool, 8>{});
+        for (size_t i = 0; i < passes.size(); i++)
+        {
+            if (!usage.livePasses[i])
+            {
+                continue;
+            }
+            for (size_t k = 0; k < 8; k++)
+            {
+                const std::string& target = passes[i].render_target_names[k];
+                if (target == "")
+                {
+                    usage.storeTargets[i][k] = k == 0;
+                }
+                for (size_t step = 1; target != "" && step <= passes.size(); step++)
+                {
+                    size_t j = (i + step) % passes.size();
+                    if (!usage.livePasses[j])
+                    {
+                        continue;
+                    }
+                    if (passReads[j].count(target))
+                    {
+                        usage.storeTargets[i][k] = true;
+                        break;
+                    }
+                    const std::string* targetsEnd = passes[j].render_target_names + 8;
+                    if (std::find(passes[j].render_target_names, targetsEnd, target) != targetsEnd)
+                    {
+                        usage.storeTargets[i][k] = !passes[j].clear_render_targets
+                                                   && keepsPreviousContent(passes[j], entryPoints[passes[j].ps_entry_point].discards);
+                        break;
+                    }
+                }
+                // what a pass leaves untouched only matters if the target gets stored
+                usage.loadTargets[i][k] = usage.storeTargets[i][k] && !passes[i].clear_render_targets
+                                          && keepsPreviousContent(passes[i], entryPoints[passes[i].ps_entry_point].discards);
+            }
+        }
+
+        // levels below the first are only allocated if a sampler can reach them
+        for (auto& texture : module.textures)
+        {
+            usage.mipLevels[texture.unique_name] = mipMappedTextures.count(texture.unique_name) ? texture.levels : 1;
+        }
+
+        return usage;
+    }
+} // namespace vkBasalt
@@ -0,0 +1,41 @@
+#ifndef RESHADE_USAGE_HPP_INCLUDED
+#define RESHADE_USAGE_HPP_INCLUDED
+#include <array>
+#include <vector>
+#include <string>
+#include <set>
+#include <unordered_map>
+
+#include "reshade/effect_module.hpp"
+
+namespace vkBasalt
+{
+    // which passes, textures and views of the first technique of a module contribute to its output
+    struct ReshadeUsage
+    {
+        // per pass of the first technique
+        std::vector<bool> livePasses;
+        // textures that live passes sample through srgb or unorm samplers
+        std::set<std::string> sampledSRGB;
+        std::set<std::string> sampledUNORM;
+        // textures that live passes render to with or without srgb writes
+        std::set<std::string> renderedSRGB;
+        std::set<std::string> renderedUNORM;
+        // the mip levels that are worth allocating per texture
+        std::unordered_map<std::string, uint32_t> mipLevels;
+        // true if a live pass tests against the stencil
+        bool usesStencil = false;
+        // per pass and render target, whether the pass needs the previous content of the target
+        // and whether a later read needs what the pass writes, the back buffer always gets stored
+        std::vector<std::array<bool, 8>> loadTargets;
+        std::vector<std::array<bool, 8>> storeTargets;
+
+        bool isUsed(const std::string& texture) const;
+    };
+
+    // a pass is live if it writes the back buffer or something that a live pass reads, also in the next frame
+    // which samplers a pass reads comes from walking the call graph of its entry points in the spir-v of the module
+    ReshadeUsage analyzeReshadeModule(const reshadefx::module& module);
+} // namespace vkBasalt
+
+#endif // RESHADE_USAGE_HPP_INCLUDED
@@ -1,11 +1,11 @@
 #include "sampler.hpp"
 
+#include "object_cache.hpp"
+
 namespace vkBasalt
 {
     VkSampler createSampler(LogicalDevice* pLogicalDevice)
     {
-        VkSampler sampler;
-
         VkSamplerCreateInfo samplerCreateInfo;
         samplerCreateInfo.sType                   = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
         samplerCreateInfo.pNext                   = nullptr;
@@ -26,15 +26,11 @@ namespace vkBasalt
         samplerCreateInfo.borderColor             = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
         samplerCreateInfo.unnormalizedCoordinates = VK_FALSE;
 
-        VkResult result = pLogicalDevice->vkd.CreateSampler(pLogicalDevice->device, &samplerCreateInfo, nullptr, &sampler);
-        ASSERT_VULKAN(result);
-        return sampler;
+        return getCachedSampler(pLogicalDevice, samplerCreateInfo);
     }
 
     VkSampler createReshadeSampler(LogicalDevice* pLogicalDevice, const reshadefx::sampler_info& samplerInfo)
     {
-        VkSampler sampler;
-
         VkFilter            minFilter;
         VkFilter            magFilter;
         VkSamplerMipmapMode mipmapMode;
@@ -60,9 +56,7 @@ namespace vkBasalt
         samplerCreateInfo.borderColor             = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
         samplerCreateInfo.unnormalizedCoordinates = VK_FALSE;
 
-        VkResult result = pLogicalDevice->vkd.CreateSampler(pLogicalDevice->device, &samplerCreateInfo, nullptr, &sampler);
-        ASSERT_VULKAN(result);
-        return sampler;
+        return getCachedSampler(pLogicalDevice, samplerCreateInfo);
     }
 
     VkSamplerAddressMode convertReshadeAddressMode(const reshadefx::texture_address_mode& addressMode)
@@ -14,6 +14,7 @@
 #include "reshade/effect_module.hpp"
 namespace vkBasalt
 {
+    // the samplers are shared through the object cache of the device, release them with releaseCachedObject
     VkSampler createSampler(LogicalDevice* pLogicalDevice);
 
     VkSampler createReshadeSampler(LogicalDevice* pLogicalDevice, const reshadefx::sampler_info& samplerInfo);
@@ -0,0 +1,10 @@
+#version 450
+
+layout(set=0, binding=0) uniform sampler2D img;
+
+layout(location = 0) out vec4 color;
+
+void main()
+{
+    color = texelFetch(img, ivec2(gl_FragCoord.xy), 0);
+}
@@ -0,0 +1,20 @@
+#version 450
+
+// the part of the image that gets processed in texture coordinates, left, top, right and bottom
+layout(set=0, binding=1) uniform DamageRect
+{
+    vec4 damageRect;
+};
+
+layout(location = 0) out vec2 textureCoord;
+
+void main() {
+    // two triangles that cover the rectangle, an empty rectangle covers no pixel at all
+    bool right  = gl_VertexIndex == 1 || gl_VertexIndex == 4 || gl_VertexIndex == 5;
+    bool bottom = gl_VertexIndex == 2 || gl_VertexIndex == 3 || gl_VertexIndex == 5;
+
+    textureCoord = vec2(right ? damageRect.z : damageRect.x,
+                        bottom ? damageRect.w : damageRect.y);
+
+    gl_Position = vec4(textureCoord * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,170 @@
+// LICENSE
+// =======
+// Copyright (c) 2021 Advanced Micro Devices, Inc. All rights reserved.
+// -------
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// -------
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+// -------
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE
+#version 450
+
+// Edge adaptive spatial upsampling, port of EASU from AMD FidelityFX Super Resolution 1.0
+
+layout(set=0, binding=0) uniform sampler2D img;
+
+layout(constant_id = 0) const float outputWidth = 1920;
+layout(constant_id = 1) const float outputHeight = 1080;
+
+layout(location = 0) out vec4 fragColor;
+
+vec3 load(ivec2 position)
+{
+    return texelFetch(img, clamp(position, ivec2(0), textureSize(img, 0) - 1), 0).rgb;
+}
+
+// luma times 2
+float luma(vec3 color)
+{
+    return color.b * 0.5 + (color.r * 0.5 + color.g);
+}
+
+// Accumulates the direction and length of the edge for one of the four bilinear positions around the pixel.
+//    a
+//  b c d
+//    e
+void easuSet(inout vec2 dir, inout float len, float w, float lA, float lB, float lC, float lD, float lE)
+{
+    float dc   = lD - lC;
+    float cb   = lC - lB;
+    float lenX = max(abs(dc), abs(cb));
+    float dirX = lD - lB;
+    dir.x += dirX * w;
+    lenX = clamp(abs(dirX) / max(lenX, 1.0 / 65536.0), 0.0, 1.0);
+    lenX *= lenX;
+    len += lenX * w;
+
+    float ec   = lE - lC;
+    float ca   = lC - lA;
+    float lenY = max(abs(ec), abs(ca));
+    float dirY = lE - lA;
+    dir.y += dirY * w;
+    lenY = clamp(abs(dirY) / max(lenY, 1.0 / 65536.0), 0.0, 1.0);
+    lenY *= lenY;
+    len += lenY * w;
+}
+
+// Filters one tap with the approximated lanczos 2 kernel, rotated to the edge and stretched along it.
+void easuTap(inout vec3 aC, inout float aW, vec2 off, vec2 dir, vec2 len, float lob, float clp, vec3 c)
+{
+    vec2 v;
+    v.x = (off.x * dir.x) + (off.y * dir.y);
+    v.y = (off.x * (-dir.y)) + (off.y * dir.x);
+    v *= len;
+    float d2 = v.x * v.x + v.y * v.y;
+    d2 = min(d2, clp);
+    // (25/16 * (2/5 * x^2 - 1)^2 - (25/16 - 1)) * (1/4 * x^2 - 1)^2
+    float wB = 2.0 / 5.0 * d2 - 1.0;
+    float wA = lob * d2 - 1.0;
+    wB *= wB;
+    wA *= wA;
+    wB = 25.0 / 16.0 * wB - (25.0 / 16.0 - 1.0);
+    float w = wB * wA;
+    aC += c * w;
+    aW += w;
+}
+
+void main()
+{
+    // position of the output pixel center in the input image, relative to the texel f
+    vec2 pp = gl_FragCoord.xy * vec2(textureSize(img, 0)) / vec2(outputWidth, outputHeight) - 0.5;
+    vec2 fp = floor(pp);
+    pp -= fp;
+    ivec2 p = ivec2(fp);
+
+    // 12 tap kernel
+    //    b c
+    //  e f g h
+    //  i j k l
+    //    n o
+    vec3 b = load(p + ivec2( 0, -1));
+    vec3 c = load(p + ivec2( 1, -1));
+    vec3 e = load(p + ivec2(-1,  0));
+    vec3 f = load(p + ivec2( 0,  0));
+    vec3 g = load(p + ivec2( 1,  0));
+    vec3 h = load(p + ivec2( 2,  0));
+    vec3 i = load(p + ivec2(-1,  1));
+    vec3 j = load(p + ivec2( 0,  1));
+    vec3 k = load(p + ivec2( 1,  1));
+    vec3 l = load(p + ivec2( 2,  1));
+    vec3 n = load(p + ivec2( 0,  2));
+    vec3 o = load(p + ivec2( 1,  2));
+
+    float bL = luma(b);
+    float cL = luma(c);
+    float eL = luma(e);
+    float fL = luma(f);
+    float gL = luma(g);
+    float hL = luma(h);
+    float iL = luma(i);
+    float jL = luma(j);
+    float kL = luma(k);
+    float lL = luma(l);
+    float nL = luma(n);
+    float oL = luma(o);
+
+    // direction and length of the edge, bilinearly interpolated from f, g, j and k
+    vec2  dir = vec2(0.0);
+    float len = 0.0;
+    easuSet(dir, len, (1.0 - pp.x) * (1.0 - pp.y), bL, eL, fL, gL, jL);
+    easuSet(dir, len, pp.x * (1.0 - pp.y), cL, fL, gL, hL, kL);
+    easuSet(dir, len, (1.0 - pp.x) * pp.y, fL, iL, jL, kL, nL);
+    easuSet(dir, len, pp.x * pp.y, gL, jL, kL, lL, oL);
+
+    // normalize, without an edge the kernel stays axis aligned
+    float dirR = dir.x * dir.x + dir.y * dir.y;
+    bool  zro  = dirR < 1.0 / 32768.0;
+    dirR       = zro ? 1.0 : inversesqrt(dirR);
+    dir.x      = zro ? 1.0 : dir.x;
+    dir *= dirR;
+
+    // from {0 to 2} to {0 to 1} and shaped with a square
+    len = len * 0.5;
+    len *= len;
+
+    // the kernel gets stretched from 1.0 on horizontal and vertical edges to sqrt(2.0) on diagonal ones
+    float stretch = (dir.x * dir.x + dir.y * dir.y) / max(abs(dir.x), abs(dir.y));
+    vec2  len2    = vec2(1.0 + (stretch - 1.0) * len, 1.0 - 0.5 * len);
+
+    // the window shifts from +/- sqrt(2.0) to slightly beyond 2.0 the more edge there is
+    float lob = 0.5 + ((1.0 / 4.0 - 0.04) - 0.5) * len;
+    float clp = 1.0 / lob;
+
+    vec3  aC = vec3(0.0);
+    float aW = 0.0;
+    easuTap(aC, aW, vec2( 0.0, -1.0) - pp, dir, len2, lob, clp, b);
+    easuTap(aC, aW, vec2( 1.0, -1.0) - pp, dir, len2, lob, clp, c);
+    easuTap(aC, aW, vec2(-1.0,  1.0) - pp, dir, len2, lob, clp, i);
+    easuTap(aC, aW, vec2( 0.0,  1.0) - pp, dir, len2, lob, clp, j);
+    easuTap(aC, aW, vec2( 0.0,  0.0) - pp, dir, len2, lob, clp, f);
+    easuTap(aC, aW, vec2(-1.0,  0.0) - pp, dir, len2, lob, clp, e);
+    easuTap(aC, aW, vec2( 1.0,  1.0) - pp, dir, len2, lob, clp, k);
+    easuTap(aC, aW, vec2( 2.0,  1.0) - pp, dir, len2, lob, clp, l);
+    easuTap(aC, aW, vec2( 2.0,  0.0) - pp, dir, len2, lob, clp, h);
+    easuTap(aC, aW, vec2( 1.0,  0.0) - pp, dir, len2, lob, clp, g);
+    easuTap(aC, aW, vec2( 1.0,  2.0) - pp, dir, len2, lob, clp, o);
+    easuTap(aC, aW, vec2( 0.0,  2.0) - pp, dir, len2, lob, clp, n);
+
+    // deringing with the min and max of the 4 nearest texels
+    vec3 min4 = min(min(f, g), min(j, k));
+    vec3 max4 = max(max(f, g), max(j, k));
+
+    fragColor = vec4(min(max4, max(min4, aC / aW)), 1.0);
+}
@@ -0,0 +1,54 @@
+#version 450
+
+// Hashes every 16x16 tile of the image and compares it with the hash of the same tile from the last time.
+// The hash of a pixel depends on its bits and its position in the tile, the sum over the tile does not depend on the order of the atomics.
+// changed gets set if any tile differs, the host resets it before every submission.
+
+layout(local_size_x = 16, local_size_y = 16) in;
+
+layout(set = 0, binding = 0) uniform sampler2D image;
+layout(set = 0, binding = 1) buffer Hashes
+{
+    uint changed;
+    uint tileHashes[];
+};
+
+shared uint tileHash;
+
+// lowbias32 by Chris Wellons
+uint hash(uint x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+void main()
+{
+    if (gl_LocalInvocationIndex == 0)
+    {
+        tileHash = 0;
+    }
+    barrier();
+
+    ivec2 coord = ivec2(gl_GlobalInvocationID.xy);
+    if (all(lessThan(coord, textureSize(image, 0))))
+    {
+        uvec4 bits = floatBitsToUint(texelFetch(image, coord, 0));
+        atomicAdd(tileHash, hash(bits.r ^ hash(bits.g ^ hash(bits.b ^ hash(bits.a ^ hash(gl_LocalInvocationIndex))))));
+    }
+    barrier();
+
+    if (gl_LocalInvocationIndex == 0)
+    {
+        uint tile = gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x;
+        if (tileHashes[tile] != tileHash)
+        {
+            tileHashes[tile] = tileHash;
+            changed          = 1;
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#version 450
+
+// Finds the bounding rectangle of all pixels that are brighter than the threshold.
+// Every workgroup reduces its 16x16 tile in shared memory first, so only one invocation per tile touches the result buffer.
+// The maximum is exclusive, a result with the minimum above the maximum means that the image is black.
+
+layout(local_size_x = 16, local_size_y = 16) in;
+
+layout(set = 0, binding = 0) uniform sampler2D image;
+layout(set = 0, binding = 1) buffer Result
+{
+    uint minX;
+    uint minY;
+    uint maxX;
+    uint maxY;
+};
+
+layout(push_constant) uniform PushConstants
+{
+    float threshold;
+};
+
+shared uint tileMinX;
+shared uint tileMinY;
+shared uint tileMaxX;
+shared uint tileMaxY;
+
+void main()
+{
+    if (gl_LocalInvocationIndex == 0)
+    {
+        tileMinX = 0xFFFFFFFFu;
+        tileMinY = 0xFFFFFFFFu;
+        tileMaxX = 0;
+        tileMaxY = 0;
+    }
+    barrier();
+
+    ivec2 coord = ivec2(gl_GlobalInvocationID.xy);
+    if (all(lessThan(coord, textureSize(image, 0))))
+    {
+        vec3 color = texelFetch(image, coord, 0).rgb;
+        if (max(color.r, max(color.g, color.b)) > threshold)
+        {
+            atomicMin(tileMinX, uint(coord.x));
+            atomicMin(tileMinY, uint(coord.y));
+            atomicMax(tileMaxX, uint(coord.x) + 1);
+            atomicMax(tileMaxY, uint(coord.y) + 1);
+        }
+    }
+    barrier();
+
+    if (gl_LocalInvocationIndex == 0 && tileMinX < tileMaxX)
+    {
+        atomicMin(minX, tileMinX);
+        atomicMin(minY, tileMinY);
+        atomicMax(maxX, tileMaxX);
+        atomicMax(maxY, tileMaxY);
+    }
+}
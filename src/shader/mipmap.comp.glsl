@@ -0,0 +1,150 @@
+#version 450
+
+// Generates up to 12 mip levels in a single dispatch, in the style of AMD FidelityFX SPD.
+// Every workgroup reduces a 64x64 tile of mip 0 down to a single texel of mip 6.
+// The last workgroup to finish reduces the up to 64x64 texels of mip 6 to the remaining levels.
+// Every texel is the average of the 2x2 texels above it, edges get clamped like a box filter would.
+
+layout(local_size_x = 16, local_size_y = 16) in;
+
+layout(set = 0, binding = 0) uniform sampler2D source;
+layout(set = 0, binding = 1) uniform writeonly image2D mips[12];
+layout(set = 0, binding = 2) coherent buffer Scratch
+{
+    uint finishedGroups;
+    vec4 mip6[64 * 64];
+};
+
+layout(push_constant) uniform PushConstants
+{
+    ivec2 extent;
+    int   mipLevels;
+};
+
+shared vec4 tile[16 * 16];
+shared bool lastGroup;
+
+ivec2 mipExtent(int level)
+{
+    return max(extent >> level, ivec2(1));
+}
+
+void writeMip(int level, ivec2 coord, vec4 color)
+{
+    if (level >= mipLevels || any(greaterThanEqual(coord, mipExtent(level))))
+    {
+        return;
+    }
+    // constant indices only, so that no dynamic indexing of storage images is needed
+    switch (level)
+    {
+        case 1: imageStore(mips[0], coord, color); break;
+        case 2: imageStore(mips[1], coord, color); break;
+        case 3: imageStore(mips[2], coord, color); break;
+        case 4: imageStore(mips[3], coord, color); break;
+        case 5: imageStore(mips[4], coord, color); break;
+        case 6: imageStore(mips[5], coord, color); break;
+        case 7: imageStore(mips[6], coord, color); break;
+        case 8: imageStore(mips[7], coord, color); break;
+        case 9: imageStore(mips[8], coord, color); break;
+        case 10: imageStore(mips[9], coord, color); break;
+        case 11: imageStore(mips[10], coord, color); break;
+        case 12: imageStore(mips[11], coord, color); break;
+    }
+}
+
+vec4 loadBase(int baseLevel, ivec2 coord)
+{
+    coord = min(coord, mipExtent(baseLevel) - 1);
+    return baseLevel == 0 ? texelFetch(source, coord, 0) : mip6[coord.y * 64 + coord.x];
+}
+
+// reduces the 64x64 texels of baseLevel that belong to group down to one texel of baseLevel + 6
+vec4 downsampleTile(int baseLevel, ivec2 group)
+{
+    ivec2 local = ivec2(gl_LocalInvocationID.xy);
+
+    // every thread reduces 4x4 texels to 2x2 texels of the first level and those to 1 texel of the second
+    ivec2 coord2 = group * 16 + local;
+    vec4  color2 = vec4(0.0);
+    for (int y = 0; y < 2; y++)
+    {
+        for (int x = 0; x < 2; x++)
+        {
+            ivec2 coord1 = min(coord2 * 2 + ivec2(x, y), mipExtent(baseLevel + 1) - 1);
+            vec4  color1 = 0.25
+                          * (loadBase(baseLevel, coord1 * 2) + loadBase(baseLevel, coord1 * 2 + ivec2(1, 0))
+                             + loadBase(baseLevel, coord1 * 2 + ivec2(0, 1)) + loadBase(baseLevel, coord1 * 2 + ivec2(1, 1)));
+            if (coord1 == coord2 * 2 + ivec2(x, y))
+            {
+                writeMip(baseLevel + 1, coord1, color1);
+            }
+            color2 += 0.25 * color1;
+        }
+    }
+    writeMip(baseLevel + 2, coord2, color2);
+    tile[local.y * 16 + local.x] = color2;
+
+    // the remaining levels of the tile are reduced in shared memory
+    vec4 color = color2;
+    for (int level = baseLevel + 3, size = 8; level <= baseLevel + 6; level++, size /= 2)
+    {
+        barrier();
+        if (all(lessThan(local, ivec2(size))))
+        {
+            // source texels in the tile, clamped to the extent of the level above
+            ivec2 origin = group * size * 2;
+            ivec2 last   = mipExtent(level - 1) - 1 - origin;
+            ivec2 coord0 = clamp(local * 2, ivec2(0), last);
+            ivec2 coord1 = clamp(local * 2 + 1, ivec2(0), last);
+
+            color = 0.25
+                    * (tile[coord0.y * 16 + coord0.x] + tile[coord0.y * 16 + coord1.x] + tile[coord1.y * 16 + coord0.x]
+                       + tile[coord1.y * 16 + coord1.x]);
+            writeMip(level, group * size + local, color);
+        }
+        barrier();
+        if (all(lessThan(local, ivec2(size))))
+        {
+            tile[local.y * 16 + local.x] = color;
+        }
+    }
+    return color;
+}
+
+void main()
+{
+    ivec2 group = ivec2(gl_WorkGroupID.xy);
+    vec4  color = downsampleTile(0, group);
+
+    if (mipLevels <= 7)
+    {
+        return;
+    }
+
+    if (gl_LocalInvocationIndex == 0)
+    {
+        if (all(lessThan(group, mipExtent(6))))
+        {
+            mip6[group.y * 64 + group.x] = color;
+        }
+        memoryBarrierBuffer();
+        uint groupCount = gl_NumWorkGroups.x * gl_NumWorkGroups.y;
+        lastGroup       = atomicAdd(finishedGroups, 1) == groupCount - 1;
+    }
+    barrier();
+
+    if (!lastGroup)
+    {
+        return;
+    }
+
+    memoryBarrierBuffer();
+    downsampleTile(6, ivec2(0));
+
+    // reset the counter for the next dispatch
+    if (gl_LocalInvocationIndex == 0)
+    {
+        finishedGroups = 0;
+    }
+}
@@ -0,0 +1,82 @@
+// LICENSE
+// =======
+// Copyright (c) 2021 Advanced Micro Devices, Inc. All rights reserved.
+// -------
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// -------
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+// -------
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE
+#version 450
+
+// Robust contrast adaptive sharpening, port of RCAS from AMD FidelityFX Super Resolution 1.0
+// unlike CAS it never sharpens beyond what the neighborhood allows, so it does not clip
+
+layout(set=0, binding=0) uniform sampler2D img;
+
+// exp2(-stops), 1.0 is the sharpest
+layout(constant_id = 0) const float sharpness = 0.87;
+
+layout(location = 0) out vec4 fragColor;
+
+// the most negative lobe that still keeps the filter from ringing
+#define RCAS_LIMIT (0.25 - (1.0 / 16.0))
+
+vec4 load(ivec2 position)
+{
+    return texelFetch(img, clamp(position, ivec2(0), textureSize(img, 0) - 1), 0);
+}
+
+// luma times 2
+float luma(vec3 color)
+{
+    return color.b * 0.5 + (color.r * 0.5 + color.g);
+}
+
+void main()
+{
+    ivec2 p = ivec2(gl_FragCoord.xy);
+
+    // cross shaped 5 tap filter
+    //    b
+    //  d e f
+    //    h
+    vec4 eColor = load(p);
+    vec3 b      = load(p + ivec2( 0, -1)).rgb;
+    vec3 d      = load(p + ivec2(-1,  0)).rgb;
+    vec3 e      = eColor.rgb;
+    vec3 f      = load(p + ivec2( 1,  0)).rgb;
+    vec3 h      = load(p + ivec2( 0,  1)).rgb;
+
+    float bL = luma(b);
+    float dL = luma(d);
+    float eL = luma(e);
+    float fL = luma(f);
+    float hL = luma(h);
+
+    // less sharpening on noise
+    float mxL = max(max(max(bL, dL), max(eL, fL)), hL);
+    float mnL = min(min(min(bL, dL), min(eL, fL)), hL);
+    float nz  = 0.25 * bL + 0.25 * dL + 0.25 * fL + 0.25 * hL - eL;
+    nz        = clamp(abs(nz) / max(mxL - mnL, 1.0 / 65536.0), 0.0, 1.0);
+    nz        = -0.5 * nz + 1.0;
+
+    // the lobe that brings the ring right to 0 or 1, whichever comes first
+    vec3  mn4     = min(min(b, d), min(f, h));
+    vec3  mx4     = max(max(b, d), max(f, h));
+    vec3  hitMin  = min(mn4, e) / max(4.0 * mx4, 1.0 / 65536.0);
+    vec3  hitMax  = (1.0 - max(mx4, e)) / min(4.0 * mn4 - 4.0, -1.0 / 65536.0);
+    vec3  lobeRGB = max(-hitMin, hitMax);
+    float lobe    = max(-RCAS_LIMIT, min(max(max(lobeRGB.r, lobeRGB.g), lobeRGB.b), 0.0)) * sharpness;
+    lobe *= nz;
+
+    vec3 color = (lobe * (b + d + f + h) + e) / (4.0 * lobe + 1.0);
+    fragColor  = vec4(color, eColor.a);
+}
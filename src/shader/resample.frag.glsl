@@ -0,0 +1,34 @@
+#version 450
+
+layout(set=0, binding=0) uniform sampler2D img;
+
+layout(location = 0) in vec2 textureCoord;
+
+layout(location = 0) out vec4 color;
+
+vec4 load(vec2 coord, vec2 halfTexel)
+{
+    // the sampler repeats, so stay half a texel away from the borders
+    return texture(img, clamp(coord, halfTexel, 1.0 - halfTexel));
+}
+
+void main()
+{
+    vec2 halfTexel   = 0.5 / vec2(textureSize(img, 0));
+    vec2 outputTexel = fwidth(textureCoord);
+
+    // when shrinking by more than a half a single bilinear tap would skip input texels, four taps cover a 4x4 box
+    if (any(greaterThan(outputTexel, 4.0 * halfTexel)))
+    {
+        vec2 offset = 0.25 * outputTexel;
+        color = load(textureCoord + vec2(-offset.x, -offset.y), halfTexel);
+        color += load(textureCoord + vec2(offset.x, -offset.y), halfTexel);
+        color += load(textureCoord + vec2(-offset.x, offset.y), halfTexel);
+        color += load(textureCoord + vec2(offset.x, offset.y), halfTexel);
+        color *= 0.25;
+    }
+    else
+    {
+        color = load(textureCoord, halfTexel);
+    }
+}
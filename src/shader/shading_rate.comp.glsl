@@ -0,0 +1,66 @@
+#version 450
+
+// Builds the shading rate image from the variance of the luma of the image, one workgroup per texel of the shading rate image.
+// Tiles with a standard deviation below the threshold get 2x2, below half of it 4x4, the effects take the minimum of that and their own rate.
+// The rates are stored as (log2(width) << 2) | log2(height).
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(set = 0, binding = 0) uniform sampler2D image;
+layout(set = 0, binding = 1) uniform writeonly uimage2D shadingRateImage;
+
+layout(push_constant) uniform PushConstants
+{
+    uvec2 texelSize;
+    float threshold;
+};
+
+shared uint tileSum;
+shared uint tileSquareSum;
+shared uint tileCount;
+
+void main()
+{
+    if (gl_LocalInvocationIndex == 0)
+    {
+        tileSum       = 0;
+        tileSquareSum = 0;
+        tileCount     = 0;
+    }
+    barrier();
+
+    // the texels are powers of two, smaller ones than the workgroup leave some invocations idle
+    ivec2 tileStart = ivec2(gl_WorkGroupID.xy * texelSize);
+    ivec2 size      = textureSize(image, 0);
+    uint  sum       = 0;
+    uint  squareSum = 0;
+    uint  count     = 0;
+    for (uint y = gl_LocalInvocationID.y; y < texelSize.y; y += gl_WorkGroupSize.y)
+    {
+        for (uint x = gl_LocalInvocationID.x; x < texelSize.x; x += gl_WorkGroupSize.x)
+        {
+            ivec2 coord = tileStart + ivec2(x, y);
+            if (all(lessThan(coord, size)))
+            {
+                // 8 bits are enough to tell flat tiles apart and keep the sums of large texels from overflowing
+                uint luma = uint(dot(texelFetch(image, coord, 0).rgb, vec3(0.299, 0.587, 0.114)) * 255.0 + 0.5);
+                sum += luma;
+                squareSum += luma * luma;
+                count++;
+            }
+        }
+    }
+    atomicAdd(tileSum, sum);
+    atomicAdd(tileSquareSum, squareSum);
+    atomicAdd(tileCount, count);
+    barrier();
+
+    if (gl_LocalInvocationIndex == 0)
+    {
+        float mean      = float(tileSum) / float(tileCount);
+        float deviation = sqrt(max(float(tileSquareSum) / float(tileCount) - mean * mean, 0.0)) / 255.0;
+
+        uint rate = deviation < threshold * 0.5 ? 10u : (deviation < threshold ? 5u : 0u);
+        imageStore(shadingRateImage, ivec2(gl_WorkGroupID.xy), uvec4(rate));
+    }
+}
@@ -9,6 +9,14 @@ namespace vkBasalt
 #include "cas.frag.h"
     };
 
+    const std::vector<uint32_t> copy_frag = {
+#include "copy.frag.h"
+    };
+
+    const std::vector<uint32_t> damage_rect_vert = {
+#include "damage_rect.vert.h"
+    };
+
     const std::vector<uint32_t> deband_frag = {
 #include "deband.frag.h"
     };
@@ -17,18 +25,42 @@ namespace vkBasalt
 #include "dls.frag.h"
     };
 
-    const std::vector<uint32_t> full_screen_triangle_vert = {
-#include "full_screen_triangle.vert.h"
+    const std::vector<uint32_t> easu_frag = {
+#include "easu.frag.h"
+    };
+
+    const std::vector<uint32_t> frame_compare_comp = {
+#include "frame_compare.comp.h"
     };
 
     const std::vector<uint32_t> fxaa_frag = {
 #include "fxaa.frag.h"
     };
 
+    const std::vector<uint32_t> letterbox_comp = {
+#include "letterbox.comp.h"
+    };
+
     const std::vector<uint32_t> lut_frag = {
 #include "lut.frag.h"
     };
 
+    const std::vector<uint32_t> mipmap_comp = {
+#include "mipmap.comp.h"
+    };
+
+    const std::vector<uint32_t> rcas_frag = {
+#include "rcas.frag.h"
+    };
+
+    const std::vector<uint32_t> resample_frag = {
+#include "resample.frag.h"
+    };
+
+    const std::vector<uint32_t> shading_rate_comp = {
+#include "shading_rate.comp.h"
+    };
+
     const std::vector<uint32_t> smaa_blend_frag = {
 #include "smaa_blend.frag.h"
     };
@@ -0,0 +1,264 @@
+#include "shading_rate.hpp"
+
+#include "image.hpp"
+#include "image_view.hpp"
+#include "sampler.hpp"
+#include "object_cache.hpp"
+#include "shader.hpp"
+#include "format.hpp"
+#include "util.hpp"
+
+#include "shader_sources.hpp"
+
+namespace vkBasalt
+{
+    namespace
+    {
+        // has to match shader/shading_rate.comp.glsl
+        struct PushConstants
+        {
+            VkExtent2D texelSize;
+            float      threshold;
+        };
+    } // namespace
+
+    ShadingRateGenerator::ShadingRateGenerator(
+        LogicalDevice* pLogicalDevice, VkFormat format, VkExtent2D imageExtent, std::vector<VkImage> images, Config* pConfig)
+    {
+        Logger::debug("in creating ShadingRateGenerator");
+
+        this->pLogicalDevice = pLogicalDevice;
+        this->images         = images;
+
+        // the standard deviation of the luma below which a tile gets shaded at 2x2, below half of it at 4x4
+        threshold = pConfig->getOption<float>("shadingRateThreshold", 0.02f);
+
+        VkExtent2D texelSize = pLogicalDevice->shadingRateTexelSize;
+        shadingRateExtent    = {(imageExtent.width + texelSize.width - 1) / texelSize.width,
+                                (imageExtent.height + texelSize.height - 1) / texelSize.height};
+
+        shadingRateImage = createImages(pLogicalDevice,
+                                        1,
+                                        {shadingRateExtent.width, shadingRateExtent.height, 1},
+                                        VK_FORMAT_R8_UINT,
+                                        VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR,
+                                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                        shadingRateMemory)[0];
+        shadingRateImageView = createImageViews(pLogicalDevice, VK_FORMAT_R8_UINT, {shadingRateImage})[0];
+
+        // the threshold is meant for the values the application wrote, not for linear ones
+        imageViews = createImageViews(pLogicalDevice, convertToUNORM(format), images);
+        sampler    = createSampler(pLogicalDevice);
+        createShaderModule(pLogicalDevice, shading_rate_comp, &shaderModule);
+
+        VkDescriptorSetLayoutBinding bindings[2];
+        bindings[0].binding            = 0;
+        bindings[0].descriptorType     = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[0].descriptorCount    = 1;
+        bindings[0].stageFlags         = VK_SHADER_STAGE_COMPUTE_BIT;
+        bindings[0].pImmutableSamplers = nullptr;
+
+        bindings[1]                = bindings[0];
+        bindings[1].binding        = 1;
+        bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+
+        VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo;
+        descriptorSetLayoutCreateInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        descriptorSetLayoutCreateInfo.pNext        = nullptr;
+        descriptorSetLayoutCreateInfo.flags        = 0;
+        descriptorSetLayoutCreateInfo.bindingCount = 2;
+        descriptorSetLayoutCreateInfo.pBindings    = bindings;
+
+        descriptorSetLayout = getCachedDescriptorSetLayout(pLogicalDevice, descriptorSetLayoutCreateInfo);
+
+        VkDescriptorPoolSize poolSizes[2];
+        poolSizes[0].type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        poolSizes[0].descriptorCount = images.size();
+        poolSizes[1].type            = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        poolSizes[1].descriptorCount = images.size();
+
+        VkDescriptorPoolCreateInfo descriptorPoolCreateInfo;
+        descriptorPoolCreateInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        descriptorPoolCreateInfo.pNext         = nullptr;
+        descriptorPoolCreateInfo.flags         = 0;
+        descriptorPoolCreateInfo.maxSets       = images.size();
+        descriptorPoolCreateInfo.poolSizeCount = 2;
+        descriptorPoolCreateInfo.pPoolSizes    = poolSizes;
+
+        VkResult result = pLogicalDevice->vkd.CreateDescriptorPool(pLogicalDevice->device, &descriptorPoolCreateInfo, nullptr, &descriptorPool);
+        ASSERT_VULKAN(result);
+
+        VkPushConstantRange pushConstantRange;
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.offset     = 0;
+        pushConstantRange.size       = sizeof(PushConstants);
+
+        VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo;
+        pipelineLayoutCreateInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutCreateInfo.pNext                  = nullptr;
+        pipelineLayoutCreateInfo.flags                  = 0;
+        pipelineLayoutCreateInfo.setLayoutCount         = 1;
+        pipelineLayoutCreateInfo.pSetLayouts            = &descriptorSetLayout;
+        pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+        pipelineLayoutCreateInfo.pPushConstantRanges    = &pushConstantRange;
+
+        pipelineLayout = getCachedPipelineLayout(pLogicalDevice, pipelineLayoutCreateInfo);
+
+        VkComputePipelineCreateInfo pipelineCreateInfo;
+        pipelineCreateInfo.sType                     = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineCreateInfo.pNext                     = nullptr;
+        pipelineCreateInfo.flags                     = 0;
+        pipelineCreateInfo.stage.sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineCreateInfo.stage.pNext               = nullptr;
+        pipelineCreateInfo.stage.flags               = 0;
+        pipelineCreateInfo.stage.stage               = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineCreateInfo.stage.module              = shaderModule;
+        pipelineCreateInfo.stage.pName               = "main";
+        pipelineCreateInfo.stage.pSpecializationInfo = nullptr;
+        pipelineCreateInfo.layout                    = pipelineLayout;
+        pipelineCreateInfo.basePipelineHandle        = VK_NULL_HANDLE;
+        pipelineCreateInfo.basePipelineIndex         = -1;
+
+        result = pLogicalDevice->vkd.CreateComputePipelines(pLogicalDevice->device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &pipeline);
+        ASSERT_VULKAN(result);
+
+        descriptorSets = std::vector<VkDescriptorSet>(images.size());
+        std::vector<VkDescriptorSetLayout> descriptorSetLayouts(images.size(), descriptorSetLayout);
+
+        VkDescriptorSetAllocateInfo descriptorSetAllocateInfo;
+        descriptorSetAllocateInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        descriptorSetAllocateInfo.pNext              = nullptr;
+        descriptorSetAllocateInfo.descriptorPool     = descriptorPool;
+        descriptorSetAllocateInfo.descriptorSetCount = descriptorSets.size();
+        descriptorSetAllocateInfo.pSetLayouts        = descriptorSetLayouts.data();
+
+        result = pLogicalDevice->vkd.AllocateDescriptorSets(pLogicalDevice->device, &descriptorSetAllocateInfo, descriptorSets.data());
+        ASSERT_VULKAN(result);
+
+        for (uint32_t i = 0; i < images.size(); i++)
+        {
+            VkDescriptorImageInfo imageInfo;
+            imageInfo.sampler     = sampler;
+            imageInfo.imageView   = imageViews[i];
+            imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+            VkDescriptorImageInfo shadingRateImageInfo;
+            shadingRateImageInfo.sampler     = VK_NULL_HANDLE;
+            shadingRateImageInfo.imageView   = shadingRateImageView;
+            shadingRateImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+            VkWriteDescriptorSet writeDescriptorSets[2];
+            writeDescriptorSets[0].sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writeDescriptorSets[0].pNext            = nullptr;
+            writeDescriptorSets[0].dstSet           = descriptorSets[i];
+            writeDescriptorSets[0].dstBinding       = 0;
+            writeDescriptorSets[0].dstArrayElement  = 0;
+            writeDescriptorSets[0].descriptorCount  = 1;
+            writeDescriptorSets[0].descriptorType   = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            writeDescriptorSets[0].pImageInfo       = &imageInfo;
+            writeDescriptorSets[0].pBufferInfo      = nullptr;
+            writeDescriptorSets[0].pTexelBufferView = nullptr;
+
+            writeDescriptorSets[1]                = writeDescriptorSets[0];
+            writeDescriptorSets[1].dstBinding     = 1;
+            writeDescriptorSets[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+            writeDescriptorSets[1].pImageInfo     = &shadingRateImageInfo;
+
+            pLogicalDevice->vkd.UpdateDescriptorSets(pLogicalDevice->device, 2, writeDescriptorSets, 0, nullptr);
+        }
+        Logger::debug("created ShadingRateGenerator");
+    }
+
+    void ShadingRateGenerator::applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer)
+    {
+        Logger::debug("applying ShadingRateGenerator to cb " + convertToString(commandBuffer));
+
+        VkImageMemoryBarrier memoryBarriers[2];
+        memoryBarriers[0].sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        memoryBarriers[0].pNext               = nullptr;
+        memoryBarriers[0].srcAccessMask       = VK_ACCESS_MEMORY_WRITE_BIT;
+        memoryBarriers[0].dstAccessMask       = VK_ACCESS_SHADER_READ_BIT;
+        memoryBarriers[0].oldLayout           = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        memoryBarriers[0].newLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        memoryBarriers[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        memoryBarriers[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        memoryBarriers[0].image               = images[imageIndex];
+
+        memoryBarriers[0].subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        memoryBarriers[0].subresourceRange.baseMipLevel   = 0;
+        memoryBarriers[0].subresourceRange.levelCount     = 1;
+        memoryBarriers[0].subresourceRange.baseArrayLayer = 0;
+        memoryBarriers[0].subresourceRange.layerCount     = 1;
+
+        // the effects of the last submission are done reading the old rates, they get overwritten as a whole
+        memoryBarriers[1]               = memoryBarriers[0];
+        memoryBarriers[1].srcAccessMask = 0;
+        memoryBarriers[1].dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        memoryBarriers[1].oldLayout     = VK_IMAGE_LAYOUT_UNDEFINED;
+        memoryBarriers[1].newLayout     = VK_IMAGE_LAYOUT_GENERAL;
+        memoryBarriers[1].image         = shadingRateImage;
+
+        pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer,
+                                               VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR,
+                                               VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                               0,
+                                               0,
+                                               nullptr,
+                                               0,
+                                               nullptr,
+                                               2,
+                                               memoryBarriers);
+
+        PushConstants pushConstants = {pLogicalDevice->shadingRateTexelSize, threshold};
+
+        pLogicalDevice->vkd.CmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+        pLogicalDevice->vkd.CmdBindDescriptorSets(
+            commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSets[imageIndex], 0, nullptr);
+        pLogicalDevice->vkd.CmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &pushConstants);
+        pLogicalDevice->vkd.CmdDispatch(commandBuffer, shadingRateExtent.width, shadingRateExtent.height, 1);
+
+        memoryBarriers[0].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        memoryBarriers[0].dstAccessMask = 0;
+        memoryBarriers[0].oldLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        memoryBarriers[0].newLayout     = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+        memoryBarriers[1].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        memoryBarriers[1].dstAccessMask = VK_ACCESS_FRAGMENT_SHADING_RATE_ATTACHMENT_READ_BIT_KHR;
+        memoryBarriers[1].oldLayout     = VK_IMAGE_LAYOUT_GENERAL;
+        memoryBarriers[1].newLayout     = VK_IMAGE_LAYOUT_FRAGMENT_SHADING_RATE_ATTACHMENT_OPTIMAL_KHR;
+
+        pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer,
+                                               VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                               VK_PIPELINE_STAGE_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR | VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                                               0,
+                                               0,
+                                               nullptr,
+                                               0,
+                                               nullptr,
+                                               2,
+                                               memoryBarriers);
+    }
+
+    VkImageView ShadingRateGenerator::getShadingRateImageView()
+    {
+        return shadingRateImageView;
+    }
+
+    ShadingRateGenerator::~ShadingRateGenerator()
+    {
+        Logger::debug("destroying ShadingRateGenerator " + convertToString(this));
+        pLogicalDevice->vkd.DestroyPipeline(pLogicalDevice->device, pipeline, nullptr);
+        releaseCachedObject<VK_OBJECT_TYPE_PIPELINE_LAYOUT>(pLogicalDevice, pipelineLayout);
+        pLogicalDevice->vkd.DestroyDescriptorPool(pLogicalDevice->device, descriptorPool, nullptr);
+        releaseCachedObject<VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT>(pLogicalDevice, descriptorSetLayout);
+        pLogicalDevice->vkd.DestroyShaderModule(pLogicalDevice->device, shaderModule, nullptr);
+        releaseCachedObject<VK_OBJECT_TYPE_SAMPLER>(pLogicalDevice, sampler);
+        for (auto& imageView : imageViews)
+        {
+            pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, imageView, nullptr);
+        }
+        pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, shadingRateImageView, nullptr);
+        pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, shadingRateImage, nullptr);
+        pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, shadingRateMemory, nullptr);
+    }
+} // namespace vkBasalt
@@ -0,0 +1,46 @@
+#ifndef SHADING_RATE_HPP_INCLUDED
+#define SHADING_RATE_HPP_INCLUDED
+#include <vector>
+
+#include "vulkan_include.hpp"
+
+#include "effect.hpp"
+#include "config.hpp"
+
+#include "logical_device.hpp"
+
+namespace vkBasalt
+{
+    // Writes the shading rate image of a swapchain from the luma variance of the images of the application, see shader/shading_rate.comp.glsl.
+    // It gets submitted in front of the effects and leaves the shading rate image in the fragment shading rate attachment optimal layout.
+    // All images share the one shading rate image, the submissions run one after another on the same queue.
+    class ShadingRateGenerator : public Effect
+    {
+    public:
+        ShadingRateGenerator(
+            LogicalDevice* pLogicalDevice, VkFormat format, VkExtent2D imageExtent, std::vector<VkImage> images, Config* pConfig);
+        void virtual applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer) override;
+        VkImageView getShadingRateImageView();
+        virtual ~ShadingRateGenerator();
+
+    private:
+        LogicalDevice*               pLogicalDevice;
+        // one texel for every texel size pixels of the images
+        VkExtent2D                   shadingRateExtent;
+        float                        threshold;
+        std::vector<VkImage>         images;
+        std::vector<VkImageView>     imageViews;
+        VkImage                      shadingRateImage;
+        VkImageView                  shadingRateImageView;
+        VkDeviceMemory               shadingRateMemory;
+        VkSampler                    sampler;
+        VkShaderModule               shaderModule;
+        VkDescriptorSetLayout        descriptorSetLayout;
+        VkDescriptorPool             descriptorPool;
+        std::vector<VkDescriptorSet> descriptorSets;
+        VkPipelineLayout             pipelineLayout;
+        VkPipeline                   pipeline;
+    };
+} // namespace vkBasalt
+
+#endif // SHADING_RATE_HPP_INCLUDED
@@ -0,0 +1,85 @@
+#include "texture_cache.hpp"
+
+#include "image.hpp"
+#include "image_view.hpp"
+#include "format.hpp"
+#include "util.hpp"
+
+namespace vkBasalt
+{
+    CachedTexture::~CachedTexture()
+    {
+        Logger::debug("destroying cached texture " + convertToString(image));
+        if (imageViewSRGB != imageViewUNORM)
+        {
+            pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, imageViewSRGB, nullptr);
+        }
+        pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, imageViewUNORM, nullptr);
+        pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, image, nullptr);
+        pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, memory, nullptr);
+    }
+
+    std::shared_ptr<CachedTexture> getCachedTexture(LogicalDevice* pLogicalDevice, const std::string& key)
+    {
+        auto found = pLogicalDevice->textureCache.find(key);
+        if (found == pLogicalDevice->textureCache.end())
+        {
+            return nullptr;
+        }
+        Logger::debug("reusing cached texture " + key);
+        return found->second;
+    }
+
+    std::shared_ptr<CachedTexture> createCachedTexture(
+        LogicalDevice* pLogicalDevice, const std::string& key, VkExtent3D extent, VkFormat format, uint32_t mipLevels, VkImageUsageFlags usage)
+    {
+        std::shared_ptr<CachedTexture> texture(new CachedTexture);
+        texture->pLogicalDevice = pLogicalDevice;
+        texture->extent         = extent;
+        texture->format         = format;
+        texture->mipLevels      = mipLevels;
+
+        texture->image = createImages(pLogicalDevice,
+                                      1,
+                                      extent,
+                                      format,
+                                      usage | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                                      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                      texture->memory,
+                                      mipLevels)[0];
+
+        VkImageViewType viewType = extent.depth == 1 ? VK_IMAGE_VIEW_TYPE_2D : VK_IMAGE_VIEW_TYPE_3D;
+
+        texture->imageViewUNORM =
+            createImageViews(pLogicalDevice, convertToUNORM(format), {texture->image}, viewType, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels)[0];
+        if (convertToSRGB(format) != convertToUNORM(format))
+        {
+            texture->imageViewSRGB =
+                createImageViews(pLogicalDevice, convertToSRGB(format), {texture->image}, viewType, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels)[0];
+        }
+        else
+        {
+            texture->imageViewSRGB = texture->imageViewUNORM;
+        }
+
+        pLogicalDevice->textureCache[key] = texture;
+        Logger::debug("created cached texture " + key);
+        return texture;
+    }
+
+    void trimTextureCache(LogicalDevice* pLogicalDevice)
+    {
+        for (auto it = pLogicalDevice->textureCache.begin(); it != pLogicalDevice->textureCache.end();)
+        {
+            // the cache itself holds the last reference
+            if (it->second.use_count() == 1)
+            {
+                it = pLogicalDevice->textureCache.erase(it);
+            }
+            else
+            {
+                it++;
+            }
+        }
+    }
+} // namespace vkBasalt
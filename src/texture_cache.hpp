@@ -0,0 +1,46 @@
+#ifndef TEXTURE_CACHE_HPP_INCLUDED
+#define TEXTURE_CACHE_HPP_INCLUDED
+#include <vector>
+#include <string>
+#include <memory>
+
+#include "vulkan_include.hpp"
+
+#include "logical_device.hpp"
+
+namespace vkBasalt
+{
+    // A read only texture or pooled render target that can be shared between effects and swapchains of the same device
+    // the vulkan objects get destroyed together with the last reference
+    struct CachedTexture
+    {
+        LogicalDevice* pLogicalDevice;
+        VkImage        image;
+        VkDeviceMemory memory;
+        VkImageView    imageViewUNORM;
+        VkImageView    imageViewSRGB;
+        VkExtent3D     extent;
+        VkFormat       format;
+        uint32_t       mipLevels;
+
+        ~CachedTexture();
+    };
+
+    // returns the texture stored under key or nullptr if there is none yet
+    std::shared_ptr<CachedTexture> getCachedTexture(LogicalDevice* pLogicalDevice, const std::string& key);
+
+    // creates an image with an UNORM and a sRGB view and stores it under key
+    // the content is undefined, the caller has to upload it before the texture gets used
+    // usage is added to the sampled and transfer usage that every cached texture has
+    std::shared_ptr<CachedTexture> createCachedTexture(LogicalDevice*     pLogicalDevice,
+                                                       const std::string& key,
+                                                       VkExtent3D         extent,
+                                                       VkFormat           format,
+                                                       uint32_t           mipLevels = 1,
+                                                       VkImageUsageFlags  usage     = 0);
+
+    // releases every texture that is no longer used by any effect
+    void trimTextureCache(LogicalDevice* pLogicalDevice);
+} // namespace vkBasalt
+
+#endif // TEXTURE_CACHE_HPP_INCLUDED
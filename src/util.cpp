@@ -1,7 +1,12 @@
 #include "util.hpp"
 
 #include <iostream>
+#include <cstdlib>
+#include <filesystem>
 #include <unistd.h>
+#include <sys/stat.h>
+
+#include "logger.hpp"
 
 namespace vkBasalt
 {
@@ -63,4 +68,32 @@ namespace vkBasalt
             std::cout << "\033[" << magicString << "m" << output << "\033[0m" << std::endl;
         }
     }
+
+    std::string getFileCacheKey(const std::string& filePath)
+    {
+        struct stat fileStat;
+        if (stat(filePath.c_str(), &fileStat) != 0)
+        {
+            return filePath;
+        }
+        return filePath + ":" + std::to_string(fileStat.st_size) + ":" + std::to_string(fileStat.st_mtim.tv_sec) + "."
+               + std::to_string(fileStat.st_mtim.tv_nsec);
+    }
+
+    std::string getCacheDirectory(const std::string& subDirectory)
+    {
+        const char* tmpCacheEnv = std::getenv("XDG_CACHE_HOME");
+        const char* tmpHomeEnv  = std::getenv("HOME");
+        std::string cacheDirectory =
+            tmpCacheEnv ? std::string(tmpCacheEnv) + "/vkBasalt" : std::string(tmpHomeEnv ? tmpHomeEnv : "/tmp") + "/.cache/vkBasalt";
+        cacheDirectory += "/" + subDirectory;
+
+        std::error_code error;
+        std::filesystem::create_directories(cacheDirectory, error);
+        if (error)
+        {
+            Logger::debug("could not create cache directory " + cacheDirectory + ": " + error.message());
+        }
+        return cacheDirectory;
+    }
 } // namespace vkBasalt
@@ -4,6 +4,9 @@
 #include <string>
 #include <sstream>
 #include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
 
 namespace vkBasalt
 {
@@ -25,6 +28,12 @@ namespace vkBasalt
 
     void outputInColor(std::string output, Color foreground = Color::defaultColor, Color background = Color::defaultColor);
 
+    // returns a key for data derived from filePath, changing the file on disk changes the key
+    std::string getFileCacheKey(const std::string& filePath);
+
+    // returns the directory for files that vkBasalt can recreate at any time, it gets created if it does not exist
+    std::string getCacheDirectory(const std::string& subDirectory);
+
     template<typename T>
     std::string convertToString(T object)
     {
@@ -32,6 +41,33 @@ namespace vkBasalt
         ss << object;
         return ss.str();
     }
+
+    // calls function(i) for every i in [0, count) on a small pool of worker threads
+    template<typename F>
+    void parallelFor(size_t count, F function)
+    {
+        size_t threadCount = std::min<size_t>(count, std::max(1u, std::thread::hardware_concurrency()));
+
+        std::atomic<size_t> next = 0;
+
+        auto worker = [&]() {
+            for (size_t i = next++; i < count; i = next++)
+            {
+                function(i);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < threadCount; i++)
+        {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
 } // namespace vkBasalt
 
 #endif // UTIL_HPP_INCLUDED
@@ -11,6 +11,207 @@
 #include "vulkan/vk_layer_dispatch_table.h"
 #include "vulkan/vk_dispatch_table_helper.h"
 
+// the bundled headers predate the following extensions, so the parts that we use are declared here
+#ifndef VK_KHR_pipeline_library
+#define VK_KHR_pipeline_library 1
+#define VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME "VK_KHR_pipeline_library"
+typedef struct VkPipelineLibraryCreateInfoKHR
+{
+    VkStructureType   sType;
+    const void*       pNext;
+    uint32_t          libraryCount;
+    const VkPipeline* pLibraries;
+} VkPipelineLibraryCreateInfoKHR;
+#endif
+
+#ifndef VK_EXT_graphics_pipeline_library
+#define VK_EXT_graphics_pipeline_library 1
+#define VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME "VK_EXT_graphics_pipeline_library"
+constexpr VkStructureType VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT = VkStructureType(1000320000);
+constexpr VkStructureType VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT            = VkStructureType(1000320002);
+
+constexpr VkPipelineLayoutCreateFlags VK_PIPELINE_LAYOUT_CREATE_INDEPENDENT_SETS_BIT_EXT = 0x00000002;
+
+typedef VkFlags VkGraphicsPipelineLibraryFlagsEXT;
+constexpr VkGraphicsPipelineLibraryFlagsEXT VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT    = 0x00000001;
+constexpr VkGraphicsPipelineLibraryFlagsEXT VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT = 0x00000002;
+constexpr VkGraphicsPipelineLibraryFlagsEXT VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT           = 0x00000004;
+constexpr VkGraphicsPipelineLibraryFlagsEXT VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT = 0x00000008;
+
+typedef struct VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT
+{
+    VkStructureType sType;
+    void*           pNext;
+    VkBool32        graphicsPipelineLibrary;
+} VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT;
+
+typedef struct VkGraphicsPipelineLibraryCreateInfoEXT
+{
+    VkStructureType                   sType;
+    void*                             pNext;
+    VkGraphicsPipelineLibraryFlagsEXT flags;
+} VkGraphicsPipelineLibraryCreateInfoEXT;
+#endif
+
+#ifndef VK_VERSION_1_3
+constexpr VkStructureType VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES = VkStructureType(53);
+
+typedef struct VkPhysicalDeviceVulkan13Features
+{
+    VkStructureType sType;
+    void*           pNext;
+    VkBool32        robustImageAccess;
+    VkBool32        inlineUniformBlock;
+    VkBool32        descriptorBindingInlineUniformBlockUpdateAfterBind;
+    VkBool32        pipelineCreationCacheControl;
+    VkBool32        privateData;
+    VkBool32        shaderDemoteToHelperInvocation;
+    VkBool32        shaderTerminateInvocation;
+    VkBool32        subgroupSizeControl;
+    VkBool32        computeFullSubgroups;
+    VkBool32        synchronization2;
+    VkBool32        textureCompressionASTC_HDR;
+    VkBool32        shaderZeroInitializeWorkgroupMemory;
+    VkBool32        dynamicRendering;
+    VkBool32        shaderIntegerDotProduct;
+    VkBool32        maintenance4;
+} VkPhysicalDeviceVulkan13Features;
+#endif
+
+#ifndef VK_KHR_dynamic_rendering
+#define VK_KHR_dynamic_rendering 1
+#define VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME "VK_KHR_dynamic_rendering"
+constexpr VkStructureType VK_STRUCTURE_TYPE_RENDERING_INFO_KHR                             = VkStructureType(1000044000);
+constexpr VkStructureType VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR                  = VkStructureType(1000044001);
+constexpr VkStructureType VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR             = VkStructureType(1000044002);
+constexpr VkStructureType VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR = VkStructureType(1000044003);
+
+typedef VkFlags VkRenderingFlagsKHR;
+
+typedef struct VkRenderingAttachmentInfoKHR
+{
+    VkStructureType       sType;
+    const void*           pNext;
+    VkImageView           imageView;
+    VkImageLayout         imageLayout;
+    VkResolveModeFlagBits resolveMode;
+    VkImageView           resolveImageView;
+    VkImageLayout         resolveImageLayout;
+    VkAttachmentLoadOp    loadOp;
+    VkAttachmentStoreOp   storeOp;
+    VkClearValue          clearValue;
+} VkRenderingAttachmentInfoKHR;
+
+typedef struct VkRenderingInfoKHR
+{
+    VkStructureType                     sType;
+    const void*                         pNext;
+    VkRenderingFlagsKHR                 flags;
+    VkRect2D                            renderArea;
+    uint32_t                            layerCount;
+    uint32_t                            viewMask;
+    uint32_t                            colorAttachmentCount;
+    const VkRenderingAttachmentInfoKHR* pColorAttachments;
+    const VkRenderingAttachmentInfoKHR* pDepthAttachment;
+    const VkRenderingAttachmentInfoKHR* pStencilAttachment;
+} VkRenderingInfoKHR;
+
+typedef struct VkPipelineRenderingCreateInfoKHR
+{
+    VkStructureType sType;
+    const void*     pNext;
+    uint32_t        viewMask;
+    uint32_t        colorAttachmentCount;
+    const VkFormat* pColorAttachmentFormats;
+    VkFormat        depthAttachmentFormat;
+    VkFormat        stencilAttachmentFormat;
+} VkPipelineRenderingCreateInfoKHR;
+
+typedef struct VkPhysicalDeviceDynamicRenderingFeaturesKHR
+{
+    VkStructureType sType;
+    void*           pNext;
+    VkBool32        dynamicRendering;
+} VkPhysicalDeviceDynamicRenderingFeaturesKHR;
+
+typedef void(VKAPI_PTR* PFN_vkCmdBeginRenderingKHR)(VkCommandBuffer commandBuffer, const VkRenderingInfoKHR* pRenderingInfo);
+typedef void(VKAPI_PTR* PFN_vkCmdEndRenderingKHR)(VkCommandBuffer commandBuffer);
+#endif
+
+#ifndef VK_KHR_fragment_shading_rate
+#define VK_KHR_fragment_shading_rate 1
+#define VK_KHR_FRAGMENT_SHADING_RATE_EXTENSION_NAME "VK_KHR_fragment_shading_rate"
+constexpr VkStructureType VK_STRUCTURE_TYPE_PIPELINE_FRAGMENT_SHADING_RATE_STATE_CREATE_INFO_KHR = VkStructureType(1000226001);
+constexpr VkStructureType VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_SHADING_RATE_PROPERTIES_KHR = VkStructureType(1000226002);
+constexpr VkStructureType VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_SHADING_RATE_FEATURES_KHR   = VkStructureType(1000226003);
+constexpr VkStructureType VK_STRUCTURE_TYPE_RENDERING_FRAGMENT_SHADING_RATE_ATTACHMENT_INFO_KHR  = VkStructureType(1000044006);
+
+constexpr VkImageLayout         VK_IMAGE_LAYOUT_FRAGMENT_SHADING_RATE_ATTACHMENT_OPTIMAL_KHR          = VkImageLayout(1000164003);
+constexpr VkImageUsageFlags     VK_IMAGE_USAGE_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR               = 0x00000100;
+constexpr VkFormatFeatureFlags  VK_FORMAT_FEATURE_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR            = 0x40000000;
+constexpr VkAccessFlags         VK_ACCESS_FRAGMENT_SHADING_RATE_ATTACHMENT_READ_BIT_KHR               = 0x00800000;
+constexpr VkPipelineStageFlags  VK_PIPELINE_STAGE_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR            = 0x00400000;
+constexpr VkPipelineCreateFlags VK_PIPELINE_CREATE_RENDERING_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR = 0x00200000;
+
+typedef enum VkFragmentShadingRateCombinerOpKHR
+{
+    VK_FRAGMENT_SHADING_RATE_COMBINER_OP_KEEP_KHR    = 0,
+    VK_FRAGMENT_SHADING_RATE_COMBINER_OP_REPLACE_KHR = 1,
+    VK_FRAGMENT_SHADING_RATE_COMBINER_OP_MIN_KHR     = 2,
+    VK_FRAGMENT_SHADING_RATE_COMBINER_OP_MAX_KHR     = 3,
+    VK_FRAGMENT_SHADING_RATE_COMBINER_OP_MUL_KHR     = 4,
+} VkFragmentShadingRateCombinerOpKHR;
+
+typedef struct VkPhysicalDeviceFragmentShadingRateFeaturesKHR
+{
+    VkStructureType sType;
+    void*           pNext;
+    VkBool32        pipelineFragmentShadingRate;
+    VkBool32        primitiveFragmentShadingRate;
+    VkBool32        attachmentFragmentShadingRate;
+} VkPhysicalDeviceFragmentShadingRateFeaturesKHR;
+
+typedef struct VkPhysicalDeviceFragmentShadingRatePropertiesKHR
+{
+    VkStructureType       sType;
+    void*                 pNext;
+    VkExtent2D            minFragmentShadingRateAttachmentTexelSize;
+    VkExtent2D            maxFragmentShadingRateAttachmentTexelSize;
+    uint32_t              maxFragmentShadingRateAttachmentTexelSizeAspectRatio;
+    VkBool32              primitiveFragmentShadingRateWithMultipleViewports;
+    VkBool32              layeredShadingRateAttachments;
+    VkBool32              fragmentShadingRateNonTrivialCombinerOps;
+    VkExtent2D            maxFragmentSize;
+    uint32_t              maxFragmentSizeAspectRatio;
+    uint32_t              maxFragmentShadingRateCoverageSamples;
+    VkSampleCountFlagBits maxFragmentShadingRateRasterizationSamples;
+    VkBool32              fragmentShadingRateWithShaderDepthStencilWrites;
+    VkBool32              fragmentShadingRateWithSampleMask;
+    VkBool32              fragmentShadingRateWithShaderSampleMask;
+    VkBool32              fragmentShadingRateWithConservativeRasterization;
+    VkBool32              fragmentShadingRateWithFragmentShaderInterlock;
+    VkBool32              fragmentShadingRateWithCustomSampleLocations;
+    VkBool32              fragmentShadingRateStrictMultiplyCombiner;
+} VkPhysicalDeviceFragmentShadingRatePropertiesKHR;
+
+typedef struct VkPipelineFragmentShadingRateStateCreateInfoKHR
+{
+    VkStructureType                    sType;
+    const void*                        pNext;
+    VkExtent2D                         fragmentSize;
+    VkFragmentShadingRateCombinerOpKHR combinerOps[2];
+} VkPipelineFragmentShadingRateStateCreateInfoKHR;
+
+typedef struct VkRenderingFragmentShadingRateAttachmentInfoKHR
+{
+    VkStructureType sType;
+    const void*     pNext;
+    VkImageView     imageView;
+    VkImageLayout   imageLayout;
+    VkExtent2D      shadingRateAttachmentTexelSize;
+} VkRenderingFragmentShadingRateAttachmentInfoKHR;
+#endif
+
 #include <string>
 
 #include "logger.hpp"